@@ -0,0 +1,213 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "ai_scheduler.h"
+#include "game.h"
+#include "game_constants.h"
+#include "trace_profiler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+Ai_View::Ai_View () {
+    active = false;
+}
+
+Ai_Scheduler::Ai_Scheduler () {
+    clear();
+}
+
+void Ai_Scheduler::clear () {
+    views.clear();
+    tiers.clear();
+    scheduled.clear();
+
+    for (uint32_t i = 0; i < AI_LOD_TIER_COUNT; i++) {
+        tier_counts[i] = 0;
+    }
+
+    scheduled_count = 0;
+    deferred_count = 0;
+}
+
+void Ai_Scheduler::set_view (uint32_t player, const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h) {
+    // Views are indexed by player, so an out of range player would grow views without bound
+    if (player >= Game::MAX_PLAYERS) {
+        return;
+    }
+
+    if (player >= views.size()) {
+        views.resize(player + 1);
+    }
+
+    views[player].active = true;
+    views[player].x = x;
+    views[player].y = y;
+    views[player].w = w;
+    views[player].h = h;
+}
+
+void Ai_Scheduler::remove_view (uint32_t player) {
+    if (player < views.size()) {
+        views[player] = Ai_View();
+    }
+}
+
+Ai_Lod_Tier Ai_Scheduler::get_tier (const Fixed& x, const Fixed& y) const {
+    Fixed full_distance = Fixed::from_double(Game_Constants::AI_LOD_FULL_DISTANCE);
+    Fixed reduced_distance = Fixed::from_double(Game_Constants::AI_LOD_REDUCED_DISTANCE);
+    bool any_view = false;
+    Ai_Lod_Tier tier = AI_LOD_TIER_COARSE;
+
+    for (size_t i = 0; i < views.size() && tier != AI_LOD_TIER_FULL; i++) {
+        const Ai_View& view = views[i];
+
+        if (!view.active) {
+            continue;
+        }
+
+        any_view = true;
+
+        // How far the point is outside of the view along whichever axis is further, which unlike the true distance
+        // cannot overflow in a large world
+        Fixed distance_x = Fixed::max(Fixed::max(view.x - x, x - view.x - view.w), Fixed());
+        Fixed distance_y = Fixed::max(Fixed::max(view.y - y, y - view.y - view.h), Fixed());
+        Fixed distance = Fixed::max(distance_x, distance_y);
+
+        if (distance <= full_distance) {
+            tier = AI_LOD_TIER_FULL;
+        } else if (distance <= reduced_distance) {
+            tier = AI_LOD_TIER_REDUCED;
+        }
+    }
+
+    return any_view ? tier : AI_LOD_TIER_FULL;
+}
+
+void Ai_Scheduler::update (uint64_t tick, const Entity_Store& entities) {
+    Trace_Scope trace("ai_scheduler", "game");
+
+    uint32_t count = entities.size();
+    uint64_t intervals[AI_LOD_TIER_COUNT] = {
+        1, max(Game_Constants::AI_LOD_REDUCED_INTERVAL, (uint32_t) 1),
+        max(Game_Constants::AI_LOD_COARSE_INTERVAL, (uint32_t) 1)
+    };
+
+    tiers.resize(count);
+    scheduled.assign(count, 0);
+
+    for (uint32_t i = 0; i < AI_LOD_TIER_COUNT; i++) {
+        tier_counts[i] = 0;
+    }
+
+    scheduled_count = 0;
+    deferred_count = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (entities.type[i] != ENTITY_TYPE_SHIP) {
+            continue;
+        }
+
+        tiers[i] = get_tier(entities.x[i], entities.y[i]);
+        tier_counts[tiers[i]]++;
+
+        if (tiers[i] == AI_LOD_TIER_FULL) {
+            scheduled[i] = 1;
+            scheduled_count++;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    // The budget is handed out starting from a different ship each tick, so that when it runs short the same ships
+    // are not always the ones left waiting
+    uint32_t start = (uint32_t) ((tick * 2654435761ULL) % count);
+
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t i = (start + n) % count;
+
+        if (entities.type[i] != ENTITY_TYPE_SHIP || tiers[i] == AI_LOD_TIER_FULL ||
+            (entities.get_handle(i).index + tick) % intervals[tiers[i]] != 0) {
+            continue;
+        }
+
+        if (scheduled_count < Game_Constants::AI_WORK_PER_TICK) {
+            scheduled[i] = 1;
+            scheduled_count++;
+        } else {
+            deferred_count++;
+        }
+    }
+}
+
+bool Ai_Scheduler::is_scheduled (uint32_t dense) const {
+    return dense < scheduled.size() && scheduled[dense] != 0;
+}
+
+uint32_t Ai_Scheduler::get_tier_count (Ai_Lod_Tier tier) const {
+    return tier < AI_LOD_TIER_COUNT ? tier_counts[tier] : 0;
+}
+
+uint32_t Ai_Scheduler::get_scheduled_count () const {
+    return scheduled_count;
+}
+
+uint32_t Ai_Scheduler::get_deferred_count () const {
+    return deferred_count;
+}
+
+void Ai_Scheduler::write (RakNet::BitStream& bitstream) const {
+    uint32_t view_count = 0;
+
+    for (size_t i = 0; i < views.size(); i++) {
+        if (views[i].active) {
+            view_count++;
+        }
+    }
+
+    bitstream.WriteCompressed(view_count);
+
+    for (uint32_t i = 0; i < views.size(); i++) {
+        const Ai_View& view = views[i];
+
+        if (view.active) {
+            bitstream.WriteCompressed(i);
+            bitstream.Write(view.x.raw);
+            bitstream.Write(view.y.raw);
+            bitstream.Write(view.w.raw);
+            bitstream.Write(view.h.raw);
+        }
+    }
+}
+
+bool Ai_Scheduler::read (RakNet::BitStream& bitstream) {
+    clear();
+
+    uint32_t view_count = 0;
+
+    if (!bitstream.ReadCompressed(view_count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < view_count; i++) {
+        uint32_t player = 0;
+        Fixed x;
+        Fixed y;
+        Fixed w;
+        Fixed h;
+
+        if (!bitstream.ReadCompressed(player) || !bitstream.Read(x.raw) || !bitstream.Read(y.raw) ||
+            !bitstream.Read(w.raw) || !bitstream.Read(h.raw) || player >= Game::MAX_PLAYERS ||
+            (player < views.size() && views[player].active)) {
+            return false;
+        }
+
+        set_view(player, x, y, w, h);
+    }
+
+    return true;
+}
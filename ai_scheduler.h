@@ -0,0 +1,87 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef ai_scheduler_h
+#define ai_scheduler_h
+
+#include "entity_store.h"
+#include "fixed.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+enum Ai_Lod_Tier : uint8_t {
+    // Thinks every tick
+    AI_LOD_TIER_FULL,
+    // Thinks every ai_lod_reduced_interval ticks
+    AI_LOD_TIER_REDUCED,
+    // Thinks every ai_lod_coarse_interval ticks
+    AI_LOD_TIER_COARSE,
+    AI_LOD_TIER_COUNT
+};
+
+// The region of the world one player can see, in world units
+class Ai_View {
+    public:
+        bool active;
+        Fixed x;
+        Fixed y;
+        Fixed w;
+        Fixed h;
+
+        Ai_View ();
+};
+
+// Decides which ships think on each tick, based on how far they are from the nearest player's view
+// Ships that skip a tick keep sailing with the velocity they last chose
+// Reduced and coarse ships are spread across ticks by handle index, and no more than ai_work_per_tick of them think
+// on any one tick, with the rest waiting for their next turn
+// Ships in full detail always think, since they are the ones the players can see
+// Everything here depends only on the simulation state and the views, so every peer makes the same choices
+class Ai_Scheduler {
+    private:
+        // Indexed by player
+        std::vector<Ai_View> views;
+
+        // Indexed by dense slot
+        std::vector<uint8_t> tiers;
+        std::vector<uint8_t> scheduled;
+
+        uint32_t tier_counts[AI_LOD_TIER_COUNT];
+        uint32_t scheduled_count;
+        uint32_t deferred_count;
+
+        Ai_Lod_Tier get_tier(const Fixed& x, const Fixed& y) const;
+
+    public:
+        Ai_Scheduler ();
+
+        void clear();
+
+        // The views are part of the simulation, so these are only called from Game::handle_player_command, for the view
+        // and leave commands
+        // Until a view has been set, every ship is in full detail
+        // set_view ignores players at or past Game::MAX_PLAYERS
+        void set_view(uint32_t player, const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h);
+        void remove_view(uint32_t player);
+
+        // Call this once per tick, before anything checks is_scheduled
+        void update(uint64_t tick, const Entity_Store& entities);
+
+        // Safe to call from several threads at once
+        bool is_scheduled(uint32_t dense) const;
+
+        uint32_t get_tier_count(Ai_Lod_Tier tier) const;
+        uint32_t get_scheduled_count() const;
+        // The number of ships whose turn came this tick, but that were pushed back by the budget
+        uint32_t get_deferred_count() const;
+
+        void write(RakNet::BitStream& bitstream) const;
+        // Returns false if the data is malformed
+        bool read(RakNet::BitStream& bitstream);
+};
+
+#endif
@@ -0,0 +1,67 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "area_of_interest.h"
+
+#include <algorithm>
+
+using namespace std;
+
+Area_Of_Interest::Area_Of_Interest () {
+    clear();
+}
+
+void Area_Of_Interest::clear () {
+    has_view = false;
+    view_x = Fixed();
+    view_y = Fixed();
+    view_w = Fixed();
+    view_h = Fixed();
+
+    indices.clear();
+}
+
+void Area_Of_Interest::set_view (const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h) {
+    has_view = true;
+    view_x = x;
+    view_y = y;
+    view_w = w;
+    view_h = h;
+}
+
+void Area_Of_Interest::update (const Spatial_Grid& grid, const Entity_Store& store, const Fixed& enter_margin,
+                               const Fixed& exit_margin) {
+    next_indices.clear();
+
+    if (has_view) {
+        Fixed enter_left = view_x - enter_margin;
+        Fixed enter_top = view_y - enter_margin;
+        Fixed enter_right = view_x + view_w + enter_margin;
+        Fixed enter_bottom = view_y + view_h + enter_margin;
+
+        candidates.clear();
+
+        grid.query_rect(view_x - exit_margin, view_y - exit_margin, view_w + exit_margin + exit_margin,
+                        view_h + exit_margin + exit_margin, candidates);
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            uint32_t dense = store.get_dense_from_index(candidates[i]);
+
+            if (dense != Entity_Store::INVALID_DENSE) {
+                const Fixed& x = store.x[dense];
+                const Fixed& y = store.y[dense];
+
+                // Between the two margins, an entity keeps whatever interest it already had
+                if ((x >= enter_left && x <= enter_right && y >= enter_top && y <= enter_bottom) ||
+                    binary_search(indices.begin(), indices.end(), candidates[i])) {
+                    next_indices.push_back(candidates[i]);
+                }
+            }
+        }
+
+        sort(next_indices.begin(), next_indices.end());
+    }
+
+    indices.swap(next_indices);
+}
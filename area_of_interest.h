@@ -0,0 +1,44 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef area_of_interest_h
+#define area_of_interest_h
+
+#include "entity_store.h"
+#include "spatial_grid.h"
+
+#include <vector>
+#include <cstdint>
+
+// Tracks which entities one client is interested in, based on the region of the world it can see
+// The cost of an update depends only on how crowded the view is, not on the size of the world
+class Area_Of_Interest {
+    private:
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> next_indices;
+
+    public:
+        bool has_view;
+        // The region the client can see, in world units
+        Fixed view_x;
+        Fixed view_y;
+        Fixed view_w;
+        Fixed view_h;
+
+        // Handle indices of the entities of interest, sorted
+        std::vector<uint32_t> indices;
+
+        Area_Of_Interest ();
+
+        void clear();
+        void set_view(const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h);
+
+        // An entity enters interest once it is within enter_margin of the view, and only leaves once it is
+        // beyond exit_margin, so entities near the edge of the view do not flicker in and out
+        // Until a view has been set, nothing is of interest
+        void update(const Spatial_Grid& grid, const Entity_Store& store, const Fixed& enter_margin,
+                    const Fixed& exit_margin);
+};
+
+#endif
@@ -0,0 +1,100 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "async_loader.h"
+#include "trace_profiler.h"
+
+#include <chrono>
+
+using namespace std;
+
+void Async_Loader::parse_tasks (uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        {
+            Trace_Scope trace("parse", "load");
+
+            tasks[i].parse();
+        }
+
+        {
+            lock_guard<mutex> lock(completed_mutex);
+
+            completed.push_back(i);
+        }
+
+        completed_condition.notify_one();
+    }
+}
+
+void Async_Loader::add (const string& message, const function<void()>& parse, const function<void()>& finish) {
+    tasks.push_back(Load_Task());
+
+    tasks.back().message = message;
+    tasks.back().parse = parse;
+    tasks.back().finish = finish;
+}
+
+uint32_t Async_Loader::get_task_count () const {
+    return (uint32_t) tasks.size();
+}
+
+void Async_Loader::run (Progress_Bar& bar) {
+    uint32_t task_count = (uint32_t) tasks.size();
+    uint32_t finished_count = 0;
+    Job_Batch batch;
+    function<void(uint32_t, uint32_t)> job_function = [this] (uint32_t begin, uint32_t end) {
+        parse_tasks(begin, end);
+    };
+    vector<uint32_t> ready;
+
+    completed.clear();
+
+    // One task per job, since tasks vary widely in cost
+    Job_System::submit(batch, task_count, 1, job_function);
+
+    while (finished_count < task_count) {
+        {
+            lock_guard<mutex> lock(completed_mutex);
+
+            ready.swap(completed);
+        }
+
+        if (ready.empty()) {
+            // With nothing to finish, the main thread parses too, rather than sitting idle
+            if (!Job_System::run_queued_job(batch)) {
+                unique_lock<mutex> lock(completed_mutex);
+
+                completed_condition.wait_for(lock, chrono::milliseconds(5), [this] () {
+                    return !completed.empty();
+                });
+            }
+
+            continue;
+        }
+
+        for (size_t i = 0; i < ready.size(); i++) {
+            Load_Task& task = tasks[ready[i]];
+
+            if (task.finish) {
+                Trace_Scope trace("finish", "load");
+
+                task.finish();
+            }
+
+            bar.progress(task.message);
+
+            finished_count++;
+        }
+
+        ready.clear();
+    }
+
+    // A job decrements the batch only after its last task has been reported, so wait for that before the batch goes
+    // out of scope
+    while (batch.remaining.load(memory_order_acquire) > 0) {
+        this_thread::yield();
+    }
+
+    tasks.clear();
+}
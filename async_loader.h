@@ -0,0 +1,53 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef async_loader_h
+#define async_loader_h
+
+#include "job_system.h"
+
+#include <progress_bar.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+class Load_Task {
+    public:
+        std::string message;
+        // Runs on a worker thread
+        std::function<void()> parse;
+        // Runs on the thread that called Async_Loader::run, after parse has finished
+        std::function<void()> finish;
+};
+
+// Runs independent loading steps, such as parsing one tag type each, in parallel on the Job_System
+// A step's parse function must only touch that step's own data, and anything that needs the renderer, such as
+// uploading a texture, belongs in its finish function instead
+// The progress bar advances once per step as each one finishes, so it moves with the work rather than in step order
+class Async_Loader {
+    private:
+        std::vector<Load_Task> tasks;
+
+        std::mutex completed_mutex;
+        std::condition_variable completed_condition;
+        // Indices of tasks whose parse has finished but whose finish has not yet run
+        std::vector<uint32_t> completed;
+
+        void parse_tasks(uint32_t begin, uint32_t end);
+
+    public:
+        void add(const std::string& message, const std::function<void()>& parse,
+                 const std::function<void()>& finish = std::function<void()>());
+        uint32_t get_task_count() const;
+
+        // Runs every added task and then forgets them, returning once all of them have finished
+        // Must be called from the main thread, and not from inside of a job
+        void run(Progress_Bar& bar);
+};
+
+#endif
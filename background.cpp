@@ -0,0 +1,232 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "background.h"
+#include "game.h"
+#include "game_data.h"
+#include "game_constants.h"
+
+#include <render.h>
+#include <rtt_manager.h>
+#include <game_window.h>
+#include <game_manager.h>
+#include <engine_strings.h>
+
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    // Scatters the features of each layer, so that a cell's feature is the same every time it is drawn
+    uint64_t hash_cell (uint32_t layer, int64_t cell_x, int64_t cell_y) {
+        uint64_t value = ((uint64_t) layer << 48) ^ ((uint64_t) cell_x * 0x9E3779B97F4A7C15ULL) ^
+                         ((uint64_t) cell_y * 0xC2B2AE3D27D4EB4FULL);
+
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+        return value ^ (value >> 31);
+    }
+
+    // Returns a value in [0, 1) from some of the bits of hash
+    double hash_fraction (uint64_t hash, uint32_t shift) {
+        return ((hash >> shift) & 0xFFFF) / 65536.0;
+    }
+
+    bool is_water (double x, double y) {
+        const World_Map& world_map = Game::world_map;
+        double chunk_size = world_map.get_chunk_size();
+
+        if (x < 0.0 || y < 0.0) {
+            return false;
+        }
+
+        const World_Chunk* chunk = world_map.find_chunk((uint32_t) (x / chunk_size), (uint32_t) (y / chunk_size));
+
+        if (chunk == 0) {
+            return false;
+        }
+
+        uint32_t chunk_tiles = world_map.get_chunk_tiles();
+        uint32_t tile_x = (uint32_t) (x / world_map.get_tile_size()) % chunk_tiles;
+        uint32_t tile_y = (uint32_t) (y / world_map.get_tile_size()) % chunk_tiles;
+        uint8_t tile = chunk->tiles[tile_y * chunk_tiles + tile_x];
+
+        return tile == WORLD_TILE_DEEP_WATER || tile == WORLD_TILE_WATER;
+    }
+}
+
+Background_Cache::Background_Cache () {
+    texture = Background::INVALID;
+    valid = false;
+    origin_x = 0.0;
+    origin_y = 0.0;
+    zoom = 0.0;
+    frames_since_refresh = 0;
+}
+
+const uint32_t Background::INVALID = 0xFFFFFFFF;
+
+vector<string> Background::texture_names;
+vector<Background_Cache> Background::caches;
+uint64_t Background::update_count = 0;
+
+void Background::add_textures () {
+    double margin = Game_Constants::BACKGROUND_CACHE_MARGIN;
+
+    texture_names.clear();
+
+    for (uint32_t i = 0; i < Game_Constants::BACKGROUND_LAYER_TEXTURE_COUNT; i++) {
+        texture_names.push_back("background_layer_" + Strings::num_to_string(i));
+
+        Rtt_Manager::add_texture(texture_names.back(), Game_Window::width() + margin * 2.0,
+                                 Game_Window::height() + margin * 2.0);
+    }
+
+    caches.clear();
+}
+
+void Background::setup_caches () {
+    uint32_t layer_count = Game_Data::get_background_layer_count();
+
+    if (caches.size() == layer_count) {
+        return;
+    }
+
+    caches.assign(layer_count, Background_Cache());
+
+    uint32_t next_texture = 0;
+
+    for (uint32_t i = 0; i < layer_count && next_texture < texture_names.size(); i++) {
+        if (Game_Data::get_background_layer(i).refresh_interval > 0) {
+            caches[i].texture = next_texture++;
+        }
+    }
+}
+
+void Background::get_scroll (const Background_Layer& layer, double& scroll_x, double& scroll_y) {
+    scroll_x = Game_Manager::camera.x * layer.parallax;
+    scroll_y = Game_Manager::camera.y * layer.parallax;
+}
+
+void Background::render_layer (uint32_t handle, double x, double y, double w, double h, double scroll_x,
+                               double scroll_y) {
+    const Background_Layer& layer = Game_Data::get_background_layer(handle);
+
+    if (layer.spacing <= 0.0) {
+        return;
+    }
+
+    double zoom = Game_Manager::camera_zoom;
+    double drift_x = layer.drift_x * update_count;
+    double drift_y = layer.drift_y * update_count;
+    double spacing = layer.spacing;
+    // A feature can reach out of its own cell by up to twice its size
+    double reach = layer.size * 2.0;
+
+    int64_t first_cell_x = (int64_t) floor((scroll_x / zoom - drift_x - reach) / spacing);
+    int64_t first_cell_y = (int64_t) floor((scroll_y / zoom - drift_y - reach) / spacing);
+    int64_t last_cell_x = (int64_t) floor(((scroll_x + w) / zoom - drift_x + reach) / spacing);
+    int64_t last_cell_y = (int64_t) floor(((scroll_y + h) / zoom - drift_y + reach) / spacing);
+
+    for (int64_t cell_y = first_cell_y; cell_y <= last_cell_y; cell_y++) {
+        for (int64_t cell_x = first_cell_x; cell_x <= last_cell_x; cell_x++) {
+            uint64_t hash = hash_cell(handle, cell_x, cell_y);
+            double feature_x = (cell_x + hash_fraction(hash, 0)) * spacing + drift_x;
+            double feature_y = (cell_y + hash_fraction(hash, 16)) * spacing + drift_y;
+            double screen_x = x + feature_x * zoom - scroll_x;
+            double screen_y = y + feature_y * zoom - scroll_y;
+
+            if (layer.style == BACKGROUND_LAYER_STYLE_GLINTS) {
+                double brightness = 1.0;
+
+                // Each glint fades in and out on its own part of the cycle
+                if (layer.period > 0) {
+                    double phase = ((update_count + (hash >> 32)) % layer.period) / (double) layer.period;
+
+                    brightness = 1.0 - fabs(phase * 2.0 - 1.0);
+                }
+
+                if (brightness > 0.05 && is_water(feature_x, feature_y)) {
+                    Render::render_rectangle(screen_x, screen_y, layer.size * zoom, layer.size * 0.25 * zoom,
+                                             layer.opacity * brightness, layer.color);
+                }
+            } else if (layer.style == BACKGROUND_LAYER_STYLE_CLOUDS) {
+                double size = layer.size * (0.5 + hash_fraction(hash, 32)) * zoom;
+
+                Render::render_rectangle(screen_x, screen_y, size, size * 0.5, layer.opacity, layer.color);
+                Render::render_rectangle(screen_x + size * 0.2, screen_y - size * 0.2, size * 0.5, size * 0.2,
+                                         layer.opacity, layer.color);
+            }
+        }
+    }
+}
+
+void Background::update () {
+    update_count++;
+}
+
+void Background::render_to_textures () {
+    setup_caches();
+
+    double margin = Game_Constants::BACKGROUND_CACHE_MARGIN;
+
+    for (uint32_t i = 0; i < caches.size(); i++) {
+        Background_Cache& cache = caches[i];
+
+        if (cache.texture == INVALID) {
+            continue;
+        }
+
+        const Background_Layer& layer = Game_Data::get_background_layer(i);
+        double scroll_x = 0.0;
+        double scroll_y = 0.0;
+
+        get_scroll(layer, scroll_x, scroll_y);
+
+        cache.frames_since_refresh++;
+
+        // The texture still covers the window as long as the camera has not scrolled more than the margin from
+        // where it was when the texture was drawn
+        if (cache.valid && cache.zoom == Game_Manager::camera_zoom &&
+            cache.frames_since_refresh < layer.refresh_interval &&
+            fabs(scroll_x - cache.origin_x - margin) <= margin && fabs(scroll_y - cache.origin_y - margin) <= margin) {
+            continue;
+        }
+
+        Rtt_Data* texture = Rtt_Manager::get_texture(texture_names[cache.texture]);
+
+        cache.valid = true;
+        cache.origin_x = scroll_x - margin;
+        cache.origin_y = scroll_y - margin;
+        cache.zoom = Game_Manager::camera_zoom;
+        cache.frames_since_refresh = 0;
+
+        Rtt_Manager::set_render_target(texture_names[cache.texture]);
+
+        render_layer(i, 0.0, 0.0, texture->w, texture->h, cache.origin_x, cache.origin_y);
+
+        Rtt_Manager::reset_render_target();
+    }
+}
+
+void Background::render () {
+    setup_caches();
+
+    for (uint32_t i = 0; i < caches.size(); i++) {
+        const Background_Cache& cache = caches[i];
+        const Background_Layer& layer = Game_Data::get_background_layer(i);
+        double scroll_x = 0.0;
+        double scroll_y = 0.0;
+
+        get_scroll(layer, scroll_x, scroll_y);
+
+        if (cache.texture != INVALID && cache.valid) {
+            Render::render_rtt(cache.origin_x - scroll_x, cache.origin_y - scroll_y,
+                               Rtt_Manager::get_texture(texture_names[cache.texture]));
+        } else {
+            render_layer(i, 0.0, 0.0, Game_Window::width(), Game_Window::height(), scroll_x, scroll_y);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef background_h
+#define background_h
+
+#include "background_layer.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Background_Cache {
+    public:
+        // Index into Background's textures, or Background::INVALID if the layer is drawn directly
+        uint32_t texture;
+        bool valid;
+        // The scroll position of the texture's top left corner when it was drawn, in screen pixels
+        double origin_x;
+        double origin_y;
+        double zoom;
+        uint32_t frames_since_refresh;
+
+        Background_Cache ();
+};
+
+// Draws the background layers from the data over the terrain
+// A layer with a refresh interval is drawn into a cached texture a margin larger than the window, and between
+// refreshes the texture is only moved with the camera, so it is redrawn when the interval passes, the camera zooms
+// or the camera scrolls past the margin, rather than every frame
+// Layers without a refresh interval, and any left over once every texture is in use, are drawn directly
+class Background {
+    private:
+        static std::vector<std::string> texture_names;
+        // One per layer, in layer order
+        static std::vector<Background_Cache> caches;
+        static uint64_t update_count;
+
+        // Hands out the textures when the layers are first seen, or after the data has been reloaded
+        static void setup_caches();
+        static void get_scroll(const Background_Layer& layer, double& scroll_x, double& scroll_y);
+        // Draws the part of the layer from scroll_x, scroll_y that covers w by h pixels, with that corner at x, y
+        static void render_layer(uint32_t handle, double x, double y, double w, double h, double scroll_x,
+                                 double scroll_y);
+
+    public:
+        static const uint32_t INVALID;
+
+        // Call this from Data_Manager::add_rtts
+        static void add_textures();
+
+        // Advances the animations
+        // Call this once per update
+        static void update();
+        static void render_to_textures();
+        static void render();
+};
+
+#endif
@@ -0,0 +1,31 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "background_layer.h"
+
+using namespace std;
+
+Background_Layer::Background_Layer () {
+    name = "";
+    style = BACKGROUND_LAYER_STYLE_GLINTS;
+    color = "";
+    opacity = 1.0;
+    parallax = 1.0;
+    spacing = 0.0;
+    size = 0.0;
+    drift_x = 0.0;
+    drift_y = 0.0;
+    period = 0;
+    refresh_interval = 0;
+}
+
+Background_Layer_Style Background_Layer::get_style (const string& style_name) {
+    if (style_name == "glints") {
+        return BACKGROUND_LAYER_STYLE_GLINTS;
+    } else if (style_name == "clouds") {
+        return BACKGROUND_LAYER_STYLE_CLOUDS;
+    } else {
+        return BACKGROUND_LAYER_STYLE_COUNT;
+    }
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef background_layer_h
+#define background_layer_h
+
+#include <string>
+#include <cstdint>
+
+enum Background_Layer_Style {
+    BACKGROUND_LAYER_STYLE_GLINTS,
+    BACKGROUND_LAYER_STYLE_CLOUDS,
+    BACKGROUND_LAYER_STYLE_COUNT
+};
+
+class Background_Layer {
+    public:
+        std::string name;
+        Background_Layer_Style style;
+        std::string color;
+        double opacity;
+        // How far the layer scrolls for each pixel the camera moves
+        // 1.0 moves with the world, and more than that looks closer to the camera
+        double parallax;
+        // In world units
+        double spacing;
+        double size;
+        // In world units per update
+        double drift_x;
+        double drift_y;
+        // Updates per cycle of the layer's animation
+        uint32_t period;
+        // Frames between redraws of the layer's cached texture
+        // 0 draws the layer directly every frame
+        uint32_t refresh_interval;
+
+        Background_Layer ();
+
+        // Returns BACKGROUND_LAYER_STYLE_COUNT for an unknown name
+        static Background_Layer_Style get_style(const std::string& style_name);
+};
+
+#endif
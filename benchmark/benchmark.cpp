@@ -0,0 +1,523 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "game.h"
+#include "game_constants.h"
+#include "job_system.h"
+#include "snapshot.h"
+#include "area_of_interest.h"
+#include "simulation_rng.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    const uint32_t SCALING_TICKS = 1000;
+    const uint32_t SNAPSHOT_TICKS = 300;
+    const uint32_t TICKS_PER_SECOND = 60;
+    // How many ticks old a client's newest acknowledged snapshot is when the next update is written
+    const uint32_t SNAPSHOT_ACK_DELAY = 6;
+
+    enum Phase {
+        PHASE_TICK,
+        PHASE_AI,
+        PHASE_MOVEMENT,
+        PHASE_EVENTS,
+        PHASE_ANIMATE,
+        PHASE_COUNT
+    };
+
+    const char* PHASE_NAMES[PHASE_COUNT] = {"tick", "ai", "movement", "events", "animate"};
+
+    class Benchmark_Options {
+        public:
+            uint32_t ships;
+            // Ships among the others that are given routes to plan
+            uint32_t navigating;
+            uint32_t projectiles;
+            // Player views placed around the world, which decide how often each ship thinks
+            uint32_t views;
+            uint32_t ticks;
+            uint32_t threads;
+            uint32_t world_size;
+            uint64_t seed;
+            // Also run the entity count scaling and network bandwidth sections, which take much longer
+            bool full;
+            string output_path;
+
+            Benchmark_Options () {
+                ships = 7500;
+                navigating = 500;
+                projectiles = 2500;
+                views = 2;
+                ticks = 1000;
+                threads = 0;
+                world_size = 8192;
+                seed = 1;
+                full = false;
+                output_path = "";
+            }
+    };
+
+    void print_usage () {
+        cerr << "Usage: Pirates-Benchmark [options]\n";
+        cerr << "  --ships <count>        Ships in the world (default: 7500)\n";
+        cerr << "  --navigating <count>   Ships sent along planned routes (default: 500)\n";
+        cerr << "  --projectiles <count>  Cannonballs in the world (default: 2500)\n";
+        cerr << "  --views <count>        Player views, 0 for every ship in full detail (default: 2)\n";
+        cerr << "  --ticks <count>        Ticks to simulate (default: 1000)\n";
+        cerr << "  --threads <count>      Worker threads, 0 for one per core (default: 0)\n";
+        cerr << "  --world-size <size>    Width and height of the world (default: 8192)\n";
+        cerr << "  --seed <seed>          Seed for placing entities (default: 1)\n";
+        cerr << "  --full                 Also benchmark entity count scaling and network bandwidth\n";
+        cerr << "  --output <file>        Write the JSON results to a file instead of standard output\n";
+    }
+
+    bool parse_arguments (int argc, char* args[], Benchmark_Options& options) {
+        for (int i = 1; i < argc; i++) {
+            string argument = args[i];
+
+            if (argument == "--full") {
+                options.full = true;
+
+                continue;
+            } else if (argument != "--ships" && argument != "--navigating" && argument != "--projectiles" &&
+                       argument != "--views" && argument != "--ticks" && argument != "--threads" &&
+                       argument != "--world-size" && argument != "--seed" && argument != "--output") {
+                cerr << "Unknown option: " << argument << "\n";
+
+                return false;
+            } else if (i + 1 >= argc) {
+                cerr << "Missing value for option: " << argument << "\n";
+
+                return false;
+            }
+
+            string value = args[++i];
+            unsigned long number = strtoul(value.c_str(), 0, 10);
+
+            if (argument == "--ships") {
+                options.ships = (uint32_t) number;
+            } else if (argument == "--navigating") {
+                options.navigating = (uint32_t) number;
+            } else if (argument == "--projectiles") {
+                options.projectiles = (uint32_t) number;
+            } else if (argument == "--views") {
+                options.views = (uint32_t) number;
+            } else if (argument == "--ticks") {
+                options.ticks = (uint32_t) number;
+            } else if (argument == "--threads") {
+                options.threads = (uint32_t) number;
+            } else if (argument == "--world-size") {
+                options.world_size = (uint32_t) number;
+            } else if (argument == "--seed") {
+                options.seed = number;
+            } else if (argument == "--output") {
+                options.output_path = value;
+            }
+        }
+
+        if (options.ticks == 0 || options.world_size == 0) {
+            cerr << "Ticks and world size must be greater than 0\n";
+
+            return false;
+        }
+
+        #ifdef GAME_CONSTANTS_BAKED
+            if (options.world_size > Game_Constants::WORLD_WIDTH || options.world_size > Game_Constants::WORLD_HEIGHT) {
+                cerr << "World size cannot be larger than the baked world\n";
+
+                return false;
+            }
+        #endif
+
+        return true;
+    }
+
+    double elapsed_ms (const chrono::steady_clock::time_point& start, const chrono::steady_clock::time_point& end) {
+        return chrono::duration<double, milli>(end - start).count();
+    }
+
+    // Returns the sample at the passed fraction of the way through the sorted samples
+    double percentile (const vector<double>& sorted_samples, double fraction) {
+        if (sorted_samples.empty()) {
+            return 0.0;
+        }
+
+        size_t position = (size_t) (fraction * (double) (sorted_samples.size() - 1) + 0.5);
+
+        return sorted_samples[min(position, sorted_samples.size() - 1)];
+    }
+
+    // Ships sail in random directions, and cannonballs fly in random directions at up to 4 units per tick
+    // Returns the world size used
+    uint32_t populate (uint32_t ships, uint32_t projectiles, uint32_t world_size, uint64_t seed) {
+        #ifdef GAME_CONSTANTS_BAKED
+            // The world's size is baked in, so the entities are spread over as much of the passed size as fits
+            world_size = min(world_size, (uint32_t) min(Game_Constants::WORLD_WIDTH, Game_Constants::WORLD_HEIGHT));
+        #else
+            Game_Constants::WORLD_WIDTH = world_size;
+            Game_Constants::WORLD_HEIGHT = world_size;
+        #endif
+
+        Game::generate_world();
+        Game::entities.reserve(ships + projectiles);
+
+        Simulation_Rng rng(seed, 1);
+        Fixed world = Fixed::from_int(world_size);
+
+        for (uint32_t i = 0; i < ships + projectiles; i++) {
+            Entity_Type type = i < ships ? ENTITY_TYPE_SHIP : ENTITY_TYPE_CANNONBALL;
+            Fixed x = rng.range_fixed(Fixed(), world);
+            Fixed y = rng.range_fixed(Fixed(), world);
+            Entity_Handle handle = Game::create_entity(type, x, y);
+            uint32_t dense = Game::entities.get_dense(handle);
+
+            Game::entities.hull[dense] = 100;
+
+            if (type == ENTITY_TYPE_SHIP) {
+                Game::entities.heading[dense] = rng.range_fixed(Fixed(), Fixed::from_int(360));
+                Game::entities.ai_state[dense] = ENTITY_AI_STATE_SAILING;
+            } else {
+                Game::entities.velocity_x[dense] = rng.range_fixed(Fixed::from_int(-4), Fixed::from_int(4));
+                Game::entities.velocity_y[dense] = rng.range_fixed(Fixed::from_int(-4), Fixed::from_int(4));
+            }
+        }
+
+        return world_size;
+    }
+
+    // Sends the first ships toward a handful of shared destinations, so that most routes share their flow fields
+    void send_ships (uint32_t navigating, uint32_t world_size, uint64_t seed) {
+        const uint32_t DESTINATION_COUNT = 8;
+
+        Simulation_Rng rng(seed, 2);
+        Fixed world = Fixed::from_int(world_size);
+        Fixed destinations_x[DESTINATION_COUNT];
+        Fixed destinations_y[DESTINATION_COUNT];
+
+        for (uint32_t i = 0; i < DESTINATION_COUNT; i++) {
+            destinations_x[i] = rng.range_fixed(Fixed(), world);
+            destinations_y[i] = rng.range_fixed(Fixed(), world);
+        }
+
+        for (uint32_t i = 0; i < navigating && i < Game::entities.size(); i++) {
+            if (Game::entities.type[i] == ENTITY_TYPE_SHIP) {
+                uint32_t destination = i % DESTINATION_COUNT;
+
+                Game::navigation.set_goal(Game::entities.get_handle(i), destinations_x[destination],
+                                          destinations_y[destination]);
+            }
+        }
+    }
+
+    // Places views the size of a 1080p window at random points in the world
+    void place_views (uint32_t views, uint32_t world_size, uint64_t seed) {
+        Simulation_Rng rng(seed, 3);
+        Fixed world = Fixed::from_int(world_size);
+
+        for (uint32_t i = 0; i < views; i++) {
+            Fixed x = rng.range_fixed(Fixed(), world);
+            Fixed y = rng.range_fixed(Fixed(), world);
+
+            Game::ai_scheduler.set_view(i, x, y, Fixed::from_int(1920), Fixed::from_int(1080));
+        }
+    }
+
+    void run_simulation (const Benchmark_Options& options, ostream& json) {
+        uint32_t world_size = populate(options.ships, options.projectiles, options.world_size, options.seed);
+
+        send_ships(options.navigating, world_size, options.seed);
+        place_views(options.views, world_size, options.seed);
+
+        vector<double> samples[PHASE_COUNT];
+        vector<double> tick_totals;
+
+        for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+            samples[phase].reserve(options.ticks);
+        }
+
+        tick_totals.reserve(options.ticks);
+
+        double total_ms = 0.0;
+
+        for (uint32_t i = 0; i < options.ticks; i++) {
+            chrono::steady_clock::time_point times[PHASE_COUNT + 1];
+
+            times[PHASE_TICK] = chrono::steady_clock::now();
+            Game::tick();
+            times[PHASE_AI] = chrono::steady_clock::now();
+            Game::ai();
+            times[PHASE_MOVEMENT] = chrono::steady_clock::now();
+            Game::movement();
+            times[PHASE_EVENTS] = chrono::steady_clock::now();
+            Game::events();
+            times[PHASE_ANIMATE] = chrono::steady_clock::now();
+            Game::animate();
+            times[PHASE_COUNT] = chrono::steady_clock::now();
+
+            for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+                samples[phase].push_back(elapsed_ms(times[phase], times[phase + 1]));
+            }
+
+            tick_totals.push_back(elapsed_ms(times[0], times[PHASE_COUNT]));
+            total_ms += tick_totals.back();
+        }
+
+        json << "  \"simulation\": {\n";
+        json << "    \"final_entities\": " << Game::entities.size() << ",\n";
+        json << "    \"final_state_hash\": \"" << hex << Game::state_hash << dec << "\",\n";
+        json << "    \"ai_tiers\": {\"full\": " << Game::ai_scheduler.get_tier_count(AI_LOD_TIER_FULL) <<
+                ", \"reduced\": " << Game::ai_scheduler.get_tier_count(AI_LOD_TIER_REDUCED) << ", \"coarse\": " <<
+                Game::ai_scheduler.get_tier_count(AI_LOD_TIER_COARSE) << "},\n";
+        json << "    \"navigation_queue\": " << Game::navigation.get_queue_length() << ",\n";
+        json << "    \"ticks_per_second\": " << (total_ms > 0.0 ? (double) options.ticks / (total_ms / 1000.0) : 0.0) <<
+            ",\n";
+        json << "    \"phases\": {\n";
+
+        for (uint32_t phase = 0; phase <= PHASE_COUNT; phase++) {
+            vector<double>& sorted_samples = phase < PHASE_COUNT ? samples[phase] : tick_totals;
+
+            sort(sorted_samples.begin(), sorted_samples.end());
+
+            json << "      \"" << (phase < PHASE_COUNT ? PHASE_NAMES[phase] : "total") << "\": {\"p50_ms\": " <<
+                percentile(sorted_samples, 0.5) << ", \"p99_ms\": " << percentile(sorted_samples, 0.99) <<
+                ", \"max_ms\": " << sorted_samples.back() << "}" << (phase < PHASE_COUNT ? "," : "") << "\n";
+        }
+
+        json << "    }\n";
+        json << "  }";
+    }
+
+    // Movement time should grow linearly with entity count, so ns_per_entity should stay roughly flat
+    void run_movement_scaling (ostream& json) {
+        const uint32_t counts[] = {1000, 10000, 100000};
+
+        json << "  \"movement_scaling\": [\n";
+
+        for (size_t i = 0; i < 3; i++) {
+            populate(counts[i] * 3 / 4, counts[i] / 4, 8192, 1);
+
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+            for (uint32_t tick = 0; tick < SCALING_TICKS; tick++) {
+                Game::movement();
+            }
+
+            double total_ms = elapsed_ms(start, chrono::steady_clock::now());
+
+            json << "    {\"entities\": " << counts[i] << ", \"ms_per_tick\": " << total_ms / SCALING_TICKS <<
+                ", \"ns_per_entity\": " << total_ms * 1000000.0 / SCALING_TICKS / counts[i] << "}" <<
+                (i < 2 ? "," : "") << "\n";
+        }
+
+        json << "  ]";
+    }
+
+    // Measures the bandwidth of one client receiving an update of the whole world every tick
+    void run_snapshots (ostream& json) {
+        const uint32_t counts[] = {100, 1000, 10000};
+
+        json << "  \"snapshots\": [\n";
+
+        for (size_t n = 0; n < 3; n++) {
+            populate(counts[n] * 3 / 4, counts[n] / 4, 8192, 1);
+
+            Snapshot_History history;
+            Snapshot decoded;
+            uint64_t delta_bits = 0;
+            uint64_t full_bits = 0;
+            bool mismatch = false;
+
+            for (uint64_t tick = 1; tick <= SNAPSHOT_TICKS; tick++) {
+                Game::ai();
+                Game::movement();
+
+                Snapshot& current = history.add(tick);
+
+                current.capture(tick, Game::entities);
+
+                const Snapshot* baseline = tick > SNAPSHOT_ACK_DELAY ? history.find(tick - SNAPSHOT_ACK_DELAY) : 0;
+                RakNet::BitStream delta;
+                RakNet::BitStream full;
+
+                Snapshot_Codec::write(delta, baseline, current);
+                Snapshot_Codec::write(full, 0, current);
+
+                delta_bits += delta.GetNumberOfBitsUsed();
+                full_bits += full.GetNumberOfBitsUsed();
+
+                uint64_t decoded_tick = 0;
+                uint64_t baseline_tick = 0;
+
+                if (!Snapshot_Codec::read_header(delta, decoded_tick, baseline_tick) ||
+                    !Snapshot_Codec::read(delta, baseline, decoded) ||
+                    decoded.entities.size() != current.entities.size()) {
+                    mismatch = true;
+                } else {
+                    for (size_t i = 0; i < decoded.entities.size() && !mismatch; i++) {
+                        for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+                            if (decoded.entities[i].fields[field] != current.entities[i].fields[field]) {
+                                mismatch = true;
+                            }
+                        }
+                    }
+                }
+            }
+
+            json << "    {\"entities\": " << counts[n] << ", \"delta_bytes_per_client_per_second\": " <<
+                (double) delta_bits / 8.0 / SNAPSHOT_TICKS * TICKS_PER_SECOND <<
+                ", \"full_bytes_per_client_per_second\": " <<
+                (double) full_bits / 8.0 / SNAPSHOT_TICKS * TICKS_PER_SECOND << ", \"decoded_correctly\": " <<
+                (mismatch ? "false" : "true") << "}" << (n < 2 ? "," : "") << "\n";
+        }
+
+        json << "  ]";
+    }
+
+    // Grows the world along with the entity count, keeping the density of the 10k entity world,
+    // so per-client bandwidth and encoding time should stay flat
+    void run_interest (ostream& json) {
+        const uint32_t counts[] = {1000, 10000, 100000};
+
+        json << "  \"interest\": [\n";
+
+        for (size_t n = 0; n < 3; n++) {
+            uint32_t world_size = populate(counts[n] * 3 / 4, counts[n] / 4,
+                                           (uint32_t) (std::sqrt((double) counts[n]) * 81.92), 1);
+
+            Area_Of_Interest interest;
+            Snapshot_History history;
+            uint64_t bits = 0;
+            uint64_t interest_entities = 0;
+            double encode_ms = 0.0;
+
+            interest.set_view(Fixed::from_int(world_size / 2 - 960), Fixed::from_int(world_size / 2 - 540),
+                              Fixed::from_int(1920), Fixed::from_int(1080));
+
+            for (uint64_t tick = 1; tick <= SNAPSHOT_TICKS; tick++) {
+                Game::ai();
+                Game::movement();
+
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+                interest.update(Game::spatial_grid, Game::entities, Fixed::from_int(256), Fixed::from_int(512));
+
+                Snapshot& current = history.add(tick);
+
+                current.capture(tick, Game::entities, interest.indices);
+
+                const Snapshot* baseline = tick > SNAPSHOT_ACK_DELAY ? history.find(tick - SNAPSHOT_ACK_DELAY) : 0;
+                RakNet::BitStream bitstream;
+
+                Snapshot_Codec::write(bitstream, baseline, current);
+
+                encode_ms += elapsed_ms(start, chrono::steady_clock::now());
+                bits += bitstream.GetNumberOfBitsUsed();
+                interest_entities += current.entities.size();
+            }
+
+            json << "    {\"entities\": " << counts[n] << ", \"world_size\": " << world_size <<
+                ", \"entities_of_interest\": " << interest_entities / SNAPSHOT_TICKS <<
+                ", \"bytes_per_client_per_second\": " << (double) bits / 8.0 / SNAPSHOT_TICKS * TICKS_PER_SECOND <<
+                ", \"us_per_client_update\": " << encode_ms * 1000.0 / SNAPSHOT_TICKS << "}" << (n < 2 ? "," : "") <<
+                "\n";
+        }
+
+        json << "  ]";
+    }
+}
+
+int main (int argc, char* args[]) {
+    Benchmark_Options options;
+
+    if (!parse_arguments(argc, args, options)) {
+        print_usage();
+
+        return 1;
+    }
+
+    // The benchmark does not load data, so use the shipped values of the constants it depends on
+    // Baked constants already have them
+    #ifndef GAME_CONSTANTS_BAKED
+        Game_Constants::SPATIAL_GRID_CELL_SIZE = 64.0;
+        Game_Constants::SHIP_RADIUS = 16.0;
+        Game_Constants::SHIP_SPEED = 1.0;
+        Game_Constants::CANNONBALL_RADIUS = 2.0;
+        Game_Constants::CANNONBALL_DAMAGE = 10;
+        Game_Constants::WORLD_SEED = 1;
+        Game_Constants::WORLD_TILE_SIZE = 16.0;
+        Game_Constants::WORLD_CHUNK_TILES = 32;
+        Game_Constants::WORLD_CHUNK_MARGIN = 512.0;
+        Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL = 8;
+        Game_Constants::WORLD_CHUNK_IDLE_UPDATES = 300;
+        Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT = 1024;
+        Game_Constants::WORLD_CHUNKS_PER_BATCH = 32;
+        Game_Constants::NAVIGATION_CELL_TILES = 2;
+        Game_Constants::NAVIGATION_WORK_PER_TICK = 4096;
+        Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT = 32;
+        Game_Constants::NAVIGATION_WAYPOINT_RADIUS = 16.0;
+        Game_Constants::AI_LOD_FULL_DISTANCE = 512.0;
+        Game_Constants::AI_LOD_REDUCED_DISTANCE = 2048.0;
+        Game_Constants::AI_LOD_REDUCED_INTERVAL = 4;
+        Game_Constants::AI_LOD_COARSE_INTERVAL = 16;
+        Game_Constants::AI_WORK_PER_TICK = 2048;
+        Game_Constants::EFFECT_CAPACITY = 512;
+        Game_Constants::PARTICLE_CAPACITY = 8192;
+        Game_Constants::PARTICLE_WAKE_INTERVAL = 6;
+    #endif
+
+    Game::world_seed = Game_Constants::WORLD_SEED;
+
+    Job_System::start(options.threads);
+
+    ostringstream json;
+
+    json << "{\n";
+    json << "  \"config\": {\"ships\": " << options.ships << ", \"navigating\": " << options.navigating <<
+        ", \"projectiles\": " << options.projectiles << ", \"views\": " << options.views <<
+        ", \"ticks\": " << options.ticks << ", \"threads\": " << Job_System::get_thread_count() <<
+        ", \"world_size\": " << options.world_size << ", \"seed\": " << options.seed << "},\n";
+
+    run_simulation(options, json);
+
+    if (options.full) {
+        json << ",\n";
+        run_movement_scaling(json);
+        json << ",\n";
+        run_snapshots(json);
+        json << ",\n";
+        run_interest(json);
+    }
+
+    json << "\n}\n";
+
+    Game::clear_world();
+
+    if (options.output_path.length() > 0) {
+        ofstream file(options.output_path.c_str());
+
+        if (!file.is_open()) {
+            cerr << "Error opening output file " << options.output_path << "\n";
+
+            return 1;
+        }
+
+        file << json.str();
+    } else {
+        cout << json.str();
+    }
+
+    return 0;
+}
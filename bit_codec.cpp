@@ -0,0 +1,82 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "bit_codec.h"
+
+using namespace std;
+
+namespace {
+    // Variable-length integers are a 2-bit size class followed by this many bits
+    const uint32_t VARINT_CLASS_BITS[4] = {3, 8, 18, 64};
+}
+
+void Bit_Codec::write_bits (RakNet::BitStream& bitstream, uint64_t value, uint32_t bit_count) {
+    // Most significant bits first, one byte at a time
+    while (bit_count > 0) {
+        uint32_t chunk = bit_count % 8 == 0 ? 8 : bit_count % 8;
+
+        bit_count -= chunk;
+
+        unsigned char byte = (unsigned char) ((value >> bit_count) & ((1U << chunk) - 1));
+
+        bitstream.WriteBits(&byte, chunk, true);
+    }
+}
+
+bool Bit_Codec::read_bits (RakNet::BitStream& bitstream, uint64_t& value, uint32_t bit_count) {
+    value = 0;
+
+    while (bit_count > 0) {
+        uint32_t chunk = bit_count % 8 == 0 ? 8 : bit_count % 8;
+        unsigned char byte = 0;
+
+        bit_count -= chunk;
+
+        if (!bitstream.ReadBits(&byte, chunk, true)) {
+            return false;
+        }
+
+        value |= (uint64_t) byte << bit_count;
+    }
+
+    return true;
+}
+
+void Bit_Codec::write_varint (RakNet::BitStream& bitstream, uint64_t value) {
+    uint32_t size_class = 0;
+
+    while (size_class < 3 && value >= ((uint64_t) 1 << VARINT_CLASS_BITS[size_class])) {
+        size_class++;
+    }
+
+    write_bits(bitstream, size_class, 2);
+    write_bits(bitstream, value, VARINT_CLASS_BITS[size_class]);
+}
+
+bool Bit_Codec::read_varint (RakNet::BitStream& bitstream, uint64_t& value) {
+    uint64_t size_class = 0;
+
+    if (!read_bits(bitstream, size_class, 2)) {
+        return false;
+    }
+
+    return read_bits(bitstream, value, VARINT_CLASS_BITS[size_class]);
+}
+
+void Bit_Codec::write_signed (RakNet::BitStream& bitstream, int64_t value) {
+    // Zigzag encoding keeps small negative numbers small
+    write_varint(bitstream, ((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+}
+
+bool Bit_Codec::read_signed (RakNet::BitStream& bitstream, int64_t& value) {
+    uint64_t encoded = 0;
+
+    if (!read_varint(bitstream, encoded)) {
+        return false;
+    }
+
+    value = (int64_t) (encoded >> 1) ^ -(int64_t) (encoded & 1);
+
+    return true;
+}
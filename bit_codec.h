@@ -0,0 +1,24 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef bit_codec_h
+#define bit_codec_h
+
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+// Bit-level integer encodings shared by the game's packets
+class Bit_Codec {
+    public:
+        static void write_bits(RakNet::BitStream& bitstream, uint64_t value, uint32_t bit_count);
+        static bool read_bits(RakNet::BitStream& bitstream, uint64_t& value, uint32_t bit_count);
+        // Small values take as few as 5 bits
+        static void write_varint(RakNet::BitStream& bitstream, uint64_t value);
+        static bool read_varint(RakNet::BitStream& bitstream, uint64_t& value);
+        static void write_signed(RakNet::BitStream& bitstream, int64_t value);
+        static bool read_signed(RakNet::BitStream& bitstream, int64_t& value);
+};
+
+#endif
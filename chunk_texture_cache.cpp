@@ -0,0 +1,153 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "chunk_texture_cache.h"
+#include "game_constants.h"
+
+#include <render.h>
+#include <rtt_manager.h>
+#include <engine_strings.h>
+
+using namespace std;
+
+Chunk_Texture_Slot::Chunk_Texture_Slot () {
+    key = Chunk_Texture_Cache::INVALID;
+    revision = 0;
+    last_used_frame = 0;
+}
+
+const uint32_t Chunk_Texture_Cache::INVALID = 0xFFFFFFFF;
+
+// Indexed by World_Tile
+const char* Chunk_Texture_Cache::TILE_COLORS[WORLD_TILE_COUNT] = {
+    "world_deep_water", "world_water", "world_shoal", "world_sand", "world_grass", "world_forest", "world_port"
+};
+
+vector<string> Chunk_Texture_Cache::texture_names;
+vector<Chunk_Texture_Slot> Chunk_Texture_Cache::slots;
+unordered_map<uint32_t, uint32_t> Chunk_Texture_Cache::slot_lookup;
+uint64_t Chunk_Texture_Cache::frame = 0;
+uint32_t Chunk_Texture_Cache::renders_this_frame = 0;
+
+void Chunk_Texture_Cache::add_textures () {
+    double texture_size = Game_Constants::WORLD_CHUNK_TILES * Game_Constants::WORLD_TILE_SIZE;
+
+    texture_names.clear();
+
+    for (uint32_t i = 0; i < Game_Constants::WORLD_CHUNK_TEXTURE_COUNT; i++) {
+        texture_names.push_back("world_chunk_" + Strings::num_to_string(i));
+
+        Rtt_Manager::add_texture(texture_names.back(), texture_size, texture_size);
+    }
+
+    slots.assign(texture_names.size(), Chunk_Texture_Slot());
+    slot_lookup.clear();
+}
+
+uint32_t Chunk_Texture_Cache::find_free_slot () {
+    uint32_t oldest = INVALID;
+
+    for (uint32_t i = 0; i < slots.size(); i++) {
+        if (slots[i].key == INVALID) {
+            return i;
+        }
+
+        if (slots[i].last_used_frame < frame && (oldest == INVALID ||
+                                                 slots[i].last_used_frame < slots[oldest].last_used_frame)) {
+            oldest = i;
+        }
+    }
+
+    return oldest;
+}
+
+void Chunk_Texture_Cache::start_frame () {
+    frame++;
+    renders_this_frame = 0;
+}
+
+void Chunk_Texture_Cache::update (const World_Map& world_map, const World_Chunk& chunk) {
+    uint32_t key = chunk.chunk_y * world_map.get_chunks_x() + chunk.chunk_x;
+    unordered_map<uint32_t, uint32_t>::iterator it = slot_lookup.find(key);
+    uint32_t slot = INVALID;
+
+    if (it != slot_lookup.end()) {
+        slot = it->second;
+        slots[slot].last_used_frame = frame;
+
+        if (slots[slot].revision == chunk.revision) {
+            return;
+        }
+    }
+
+    if (renders_this_frame >= Game_Constants::WORLD_CHUNK_RENDERS_PER_FRAME) {
+        return;
+    }
+
+    if (slot == INVALID) {
+        slot = find_free_slot();
+
+        // Every texture is showing a visible chunk, so this one is drawn directly instead
+        if (slot == INVALID) {
+            return;
+        }
+
+        if (slots[slot].key != INVALID) {
+            slot_lookup.erase(slots[slot].key);
+        }
+
+        slots[slot].key = key;
+        slots[slot].last_used_frame = frame;
+        slot_lookup[key] = slot;
+    }
+
+    double texture_size = world_map.get_chunk_size();
+
+    Rtt_Manager::set_render_target(texture_names[slot]);
+
+    Render::render_rectangle(0.0, 0.0, texture_size, texture_size, 1.0, TILE_COLORS[WORLD_TILE_DEEP_WATER]);
+    render_tiles(world_map, chunk, 0.0, 0.0, 1.0);
+
+    Rtt_Manager::reset_render_target();
+
+    slots[slot].revision = chunk.revision;
+    renders_this_frame++;
+}
+
+Rtt_Data* Chunk_Texture_Cache::get_texture (const World_Map& world_map, const World_Chunk& chunk) {
+    unordered_map<uint32_t, uint32_t>::iterator it = slot_lookup.find(chunk.chunk_y * world_map.get_chunks_x() +
+                                                                      chunk.chunk_x);
+
+    if (it == slot_lookup.end() || slots[it->second].revision != chunk.revision) {
+        return 0;
+    }
+
+    return Rtt_Manager::get_texture(texture_names[it->second]);
+}
+
+void Chunk_Texture_Cache::render_tiles (const World_Map& world_map, const World_Chunk& chunk, double x, double y,
+                                        double scale) {
+    uint32_t chunk_tiles = world_map.get_chunk_tiles();
+    double tile_size = world_map.get_tile_size() * scale;
+
+    for (uint32_t tile_y = 0; tile_y < chunk_tiles; tile_y++) {
+        const uint8_t* row = &chunk.tiles[tile_y * chunk_tiles];
+
+        // Each run of identical tiles in a row is a single rectangle
+        for (uint32_t tile_x = 0; tile_x < chunk_tiles;) {
+            uint32_t run = 1;
+
+            while (tile_x + run < chunk_tiles && row[tile_x + run] == row[tile_x]) {
+                run++;
+            }
+
+            if (row[tile_x] != WORLD_TILE_DEEP_WATER) {
+                Render::render_rectangle(x + tile_x * tile_size, y + tile_y * tile_size, run * tile_size, tile_size,
+                                         1.0, TILE_COLORS[row[tile_x]]);
+            }
+
+            tile_x += run;
+        }
+    }
+}
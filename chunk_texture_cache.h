@@ -0,0 +1,65 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef chunk_texture_cache_h
+#define chunk_texture_cache_h
+
+#include "world_map.h"
+
+#include <rtt_data.h>
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+class Chunk_Texture_Slot {
+    public:
+        // The World_Map key of the chunk held by this slot, or INVALID if it holds nothing
+        uint32_t key;
+        // The chunk revision the texture was rendered from
+        uint64_t revision;
+        uint64_t last_used_frame;
+
+        Chunk_Texture_Slot ();
+};
+
+// A fixed pool of render targets, each holding the terrain of one chunk
+// A chunk is rendered into a texture only when it first becomes visible or when its revision changes,
+// so that unchanged terrain costs a single textured quad per chunk each frame
+// Textures are handed out least recently used first, and never to a chunk at the expense of one visible this frame
+class Chunk_Texture_Cache {
+    private:
+        static std::vector<std::string> texture_names;
+        static std::vector<Chunk_Texture_Slot> slots;
+        // Keyed by World_Map key
+        static std::unordered_map<uint32_t, uint32_t> slot_lookup;
+        static uint64_t frame;
+        static uint32_t renders_this_frame;
+
+        // Returns INVALID if every slot was used this frame
+        static uint32_t find_free_slot();
+
+    public:
+        static const uint32_t INVALID;
+        static const char* TILE_COLORS[WORLD_TILE_COUNT];
+
+        // Call this from Data_Manager::add_rtts
+        // Any textures already handed out are forgotten, so each chunk is rendered again when next seen
+        static void add_textures();
+
+        // Call this once per frame before any calls to update
+        static void start_frame();
+        // Renders the chunk into a texture if it has none or its texture is out of date,
+        // unless the per-frame render limit has been reached
+        static void update(const World_Map& world_map, const World_Chunk& chunk);
+        // Returns 0 if the chunk has no up to date texture
+        static Rtt_Data* get_texture(const World_Map& world_map, const World_Chunk& chunk);
+
+        // Draws the chunk's tiles other than deep water directly, with the chunk's top left corner at x, y
+        static void render_tiles(const World_Map& world_map, const World_Chunk& chunk, double x, double y,
+                                 double scale);
+};
+
+#endif
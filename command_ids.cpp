@@ -0,0 +1,280 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "command_ids.h"
+#include "bit_codec.h"
+
+#include <object_manager.h>
+#include <log.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    // Guards against reading a corrupt length as a huge allocation
+    const uint32_t MAX_NAME_LENGTH = 1024;
+}
+
+vector<string> Command_Ids::names;
+unordered_map<string, uint32_t> Command_Ids::ids;
+const uint32_t Command_Ids::MAX_COMMANDS;
+const uint32_t Command_Ids::MAX_ARGUMENTS;
+const uint32_t Command_Ids::INVALID = 0xFFFFFFFF;
+uint32_t Command_Ids::PAUSE = Command_Ids::INVALID;
+uint32_t Command_Ids::CHAT = Command_Ids::INVALID;
+uint32_t Command_Ids::SCOREBOARD = Command_Ids::INVALID;
+uint32_t Command_Ids::VIEW = Command_Ids::INVALID;
+uint32_t Command_Ids::LEAVE = Command_Ids::INVALID;
+
+void Command_Ids::clear () {
+    names.clear();
+    ids.clear();
+
+    PAUSE = INVALID;
+    CHAT = INVALID;
+    SCOREBOARD = INVALID;
+    VIEW = INVALID;
+    LEAVE = INVALID;
+}
+
+uint32_t Command_Ids::intern (const string& name) {
+    unordered_map<string, uint32_t>::iterator existing = ids.find(name);
+
+    if (existing != ids.end()) {
+        return existing->second;
+    }
+
+    if (names.size() >= MAX_COMMANDS) {
+        Log::add_error("Too many game commands, so this one is dropped: " + name);
+
+        return INVALID;
+    }
+
+    uint32_t id = (uint32_t) names.size();
+
+    names.push_back(name);
+    ids[name] = id;
+
+    if (name == "pause") {
+        PAUSE = id;
+    } else if (name == "chat") {
+        CHAT = id;
+    } else if (name == "scoreboard") {
+        SCOREBOARD = id;
+    } else if (name == "view") {
+        VIEW = id;
+    } else if (name == "leave") {
+        LEAVE = id;
+    }
+
+    return id;
+}
+
+void Command_Ids::intern_game_commands () {
+    intern("view");
+    intern("leave");
+}
+
+void Command_Ids::setup (vector<string> data_names) {
+    clear();
+
+    // The engine and the dedicated server's data pack find the commands in different orders
+    sort(data_names.begin(), data_names.end());
+
+    for (size_t i = 0; i < data_names.size(); i++) {
+        intern(data_names[i]);
+    }
+
+    intern_game_commands();
+}
+
+void Command_Ids::setup () {
+    const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
+    vector<string> data_names;
+
+    for (size_t i = 0; i < game_commands.size(); i++) {
+        data_names.push_back(game_commands[i].name);
+    }
+
+    setup(data_names);
+}
+
+uint32_t Command_Ids::get_id (const string& name) {
+    unordered_map<string, uint32_t>::const_iterator existing = ids.find(name);
+
+    return existing != ids.end() ? existing->second : INVALID;
+}
+
+const string& Command_Ids::get_name (uint32_t id) {
+    static const string unknown = "";
+
+    return id < names.size() ? names[id] : unknown;
+}
+
+uint32_t Command_Ids::get_count () {
+    return (uint32_t) names.size();
+}
+
+Player_Command::Player_Command () {
+    id = Command_Ids::INVALID;
+}
+
+Player_Command::Player_Command (uint32_t new_id) {
+    id = new_id;
+}
+
+Player_Command::Player_Command (uint32_t new_id, const vector<Fixed>& new_arguments) {
+    id = new_id;
+    arguments = new_arguments;
+}
+
+void Player_Command::write (RakNet::BitStream& bitstream) const {
+    Bit_Codec::write_varint(bitstream, id);
+    Bit_Codec::write_varint(bitstream, arguments.size());
+
+    for (size_t i = 0; i < arguments.size(); i++) {
+        bitstream.Write(arguments[i].raw);
+    }
+}
+
+bool Player_Command::read (RakNet::BitStream& bitstream) {
+    uint64_t new_id = 0;
+    uint64_t argument_count = 0;
+
+    arguments.clear();
+
+    if (!Bit_Codec::read_varint(bitstream, new_id) || new_id >= Command_Ids::MAX_COMMANDS ||
+        !Bit_Codec::read_varint(bitstream, argument_count) || argument_count > Command_Ids::MAX_ARGUMENTS) {
+        return false;
+    }
+
+    id = (uint32_t) new_id;
+    arguments.resize(argument_count);
+
+    for (size_t i = 0; i < arguments.size(); i++) {
+        if (!bitstream.Read(arguments[i].raw)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Command_State_Set::Command_State_Set () {
+    clear();
+}
+
+bool Command_State_Set::operator== (const Command_State_Set& other) const {
+    for (uint32_t i = 0; i < WORD_COUNT; i++) {
+        if (words[i] != other.words[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Command_State_Set::operator!= (const Command_State_Set& other) const {
+    return !(*this == other);
+}
+
+void Command_State_Set::clear () {
+    for (uint32_t i = 0; i < WORD_COUNT; i++) {
+        words[i] = 0;
+    }
+}
+
+void Command_State_Set::set (uint32_t id) {
+    if (id < Command_Ids::MAX_COMMANDS) {
+        words[id / 64] |= (uint64_t) 1 << (id % 64);
+    }
+}
+
+bool Command_State_Set::get (uint32_t id) const {
+    return id < Command_Ids::MAX_COMMANDS && (words[id / 64] & ((uint64_t) 1 << (id % 64))) != 0;
+}
+
+void Command_State_Set::write (RakNet::BitStream& bitstream) const {
+    uint32_t used_words = WORD_COUNT;
+
+    while (used_words > 0 && words[used_words - 1] == 0) {
+        used_words--;
+    }
+
+    Bit_Codec::write_varint(bitstream, used_words);
+
+    for (uint32_t i = 0; i < used_words; i++) {
+        Bit_Codec::write_varint(bitstream, words[i]);
+    }
+}
+
+bool Command_State_Set::read (RakNet::BitStream& bitstream) {
+    uint64_t used_words = 0;
+
+    clear();
+
+    if (!Bit_Codec::read_varint(bitstream, used_words) || used_words > WORD_COUNT) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < used_words; i++) {
+        if (!Bit_Codec::read_varint(bitstream, words[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Command_State_Set::write_names (RakNet::BitStream& bitstream) const {
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < Command_Ids::MAX_COMMANDS; i++) {
+        if (get(i)) {
+            count++;
+        }
+    }
+
+    bitstream.WriteCompressed(count);
+
+    for (uint32_t i = 0; i < Command_Ids::MAX_COMMANDS; i++) {
+        if (get(i)) {
+            const string& name = Command_Ids::get_name(i);
+            uint32_t length = (uint32_t) name.length();
+
+            bitstream.WriteCompressed(length);
+            bitstream.Write(name.c_str(), length);
+        }
+    }
+}
+
+bool Command_State_Set::read_names (RakNet::BitStream& bitstream) {
+    uint32_t count = 0;
+
+    clear();
+
+    if (!bitstream.ReadCompressed(count) || count > Command_Ids::MAX_COMMANDS) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length = 0;
+
+        if (!bitstream.ReadCompressed(length) || length > MAX_NAME_LENGTH) {
+            return false;
+        }
+
+        vector<char> name(length + 1, 0);
+
+        if (length > 0 && !bitstream.Read(&name[0], length)) {
+            return false;
+        }
+
+        // A command that no longer exists in the data is INVALID, which is never set
+        set(Command_Ids::get_id(string(&name[0], length)));
+    }
+
+    return true;
+}
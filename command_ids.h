@@ -0,0 +1,105 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef command_ids_h
+#define command_ids_h
+
+#include "fixed.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+// Dense integer IDs for the commands in data/game_commands, assigned in order of their names
+// Every peer loads the same data, so a command has the same ID on every peer, no matter what order the data was
+// loaded in
+class Command_Ids {
+    private:
+        static std::vector<std::string> names;
+        static std::unordered_map<std::string, uint32_t> ids;
+
+    public:
+        static const uint32_t MAX_COMMANDS = 256;
+        static const uint32_t MAX_ARGUMENTS = 8;
+        static const uint32_t INVALID;
+
+        // The commands the game handles, or INVALID if the data does not define them
+        static uint32_t PAUSE;
+        static uint32_t CHAT;
+        static uint32_t SCOREBOARD;
+
+        // Commands the game sends on its own, which have no input bound to them, so they are not in the data
+        // The region of the world a player can see, as the arguments x, y, w and h, in world units
+        static uint32_t VIEW;
+        // Sent by the server for a player whose client has gone
+        static uint32_t LEAVE;
+
+        static void clear();
+        // Returns the command's ID, adding it if it is new
+        // Returns INVALID and logs an error if MAX_COMMANDS commands already exist
+        static uint32_t intern(const std::string& name);
+        // Interns the commands the game sends on its own
+        // Call this after interning the data's commands, so that every command has the same ID on every peer
+        static void intern_game_commands();
+        // Starts over with the passed names, interned in sorted order, followed by the game's own commands
+        static void setup(std::vector<std::string> data_names);
+        // Does the same with every game command loaded by the engine
+        static void setup();
+
+        // Returns INVALID if the command does not exist
+        static uint32_t get_id(const std::string& name);
+        static const std::string& get_name(uint32_t id);
+        static uint32_t get_count();
+};
+
+// A command along with its arguments, which only a few commands have
+class Player_Command {
+    public:
+        uint32_t id;
+        std::vector<Fixed> arguments;
+
+        Player_Command ();
+        Player_Command (uint32_t new_id);
+        Player_Command (uint32_t new_id, const std::vector<Fixed>& new_arguments);
+
+        // Written as the command ID, followed by the arguments
+        void write(RakNet::BitStream& bitstream) const;
+        // Returns false if the data is malformed
+        bool read(RakNet::BitStream& bitstream);
+};
+
+// One bit per command ID
+class Command_State_Set {
+    private:
+        static const uint32_t WORD_COUNT = Command_Ids::MAX_COMMANDS / 64;
+
+        uint64_t words[WORD_COUNT];
+
+    public:
+        Command_State_Set ();
+
+        bool operator== (const Command_State_Set& other) const;
+        bool operator!= (const Command_State_Set& other) const;
+
+        void clear();
+        void set(uint32_t id);
+        bool get(uint32_t id) const;
+
+        // Only the words up to the last one with a bit set are written
+        void write(RakNet::BitStream& bitstream) const;
+        // Returns false if the data is malformed
+        bool read(RakNet::BitStream& bitstream);
+
+        // Written as the names of the commands that are set, for data that must survive commands being added to or
+        // removed from the data, such as replays
+        void write_names(RakNet::BitStream& bitstream) const;
+        // Names that no longer exist in the data are dropped
+        // Returns false if the data is malformed
+        bool read_names(RakNet::BitStream& bitstream);
+};
+
+#endif
@@ -2,12 +2,19 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "replay.h"
+#include "trace_profiler.h"
+
 #include <console.h>
+#include <log.h>
+#include <engine_strings.h>
 
 using namespace std;
 
 void Console::setup_game_commands () {
     ///commands.push_back("example_command");
+    commands.push_back("replay");
+    commands.push_back("profile");
 }
 
 bool Console::handle_game_command (const string& command, const vector<string>& command_input) {
@@ -17,5 +24,59 @@ bool Console::handle_game_command (const string& command, const vector<string>&
         return true;
        }*/
 
+    // replay record <file>
+    // replay stop
+    if (command == "replay") {
+        if (command_input.size() >= 2 && command_input[0] == "record") {
+            if (Replay_Recorder::start(command_input[1])) {
+                Log::add_log("Recording replay to " + command_input[1]);
+            }
+        } else if (command_input.size() >= 1 && command_input[0] == "stop") {
+            if (Replay_Recorder::is_recording()) {
+                Replay_Recorder::stop();
+
+                Log::add_log("Stopped recording replay");
+            }
+        } else {
+            Log::add_log("Usage: replay record <file>, replay stop");
+        }
+
+        return true;
+    }
+
+    // profile start
+    // profile stop
+    // profile dump <file>
+    if (command == "profile") {
+        if (command_input.size() >= 1 && command_input[0] == "start") {
+            // Commands are handled on the main thread
+            Trace_Profiler::set_thread_name("main");
+            Trace_Profiler::start();
+
+            Log::add_log("Started profiling");
+        } else if (command_input.size() >= 1 && command_input[0] == "stop") {
+            Trace_Profiler::stop();
+
+            Log::add_log("Stopped profiling with " + Strings::num_to_string(Trace_Profiler::get_event_count()) +
+                         " events");
+        } else if (command_input.size() >= 2 && command_input[0] == "dump") {
+            if (Trace_Profiler::dump(command_input[1])) {
+                Log::add_log("Wrote " + Strings::num_to_string(Trace_Profiler::get_event_count()) + " events to " +
+                             command_input[1]);
+
+                if (Trace_Profiler::get_dropped_event_count() > 0) {
+                    Log::add_log("Dropped " + Strings::num_to_string(Trace_Profiler::get_dropped_event_count()) +
+                                 " events after reaching the limit");
+                }
+            } else {
+                Log::add_error("Error writing profile to " + command_input[1]);
+            }
+        } else {
+            Log::add_log("Usage: profile start, profile stop, profile dump <file>");
+        }
+
+        return true;
+    }
+
     return false;
 }
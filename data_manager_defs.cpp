@@ -2,6 +2,10 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "chunk_texture_cache.h"
+#include "background.h"
+#include "text_cache.h"
+
 #include <data_manager.h>
 #include <rtt_manager.h>
 
@@ -9,4 +13,8 @@ using namespace std;
 
 void Data_Manager::add_rtts () {
     ///Rtt_Manager::add_texture("example",1024.0,1024.0);
+
+    Chunk_Texture_Cache::add_textures();
+    Background::add_textures();
+    Text_Cache::add_textures();
 }
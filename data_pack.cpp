@@ -0,0 +1,731 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "data_pack.h"
+
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <cstring>
+#include <cstdio>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef GAME_OS_WINDOWS
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace {
+    // Every table entry is made of little endian uint32_t fields
+    const size_t HEADER_FIELDS = 6;
+    const size_t SOURCE_FIELDS = 8;
+    const size_t TAG_FIELDS = 4;
+    const size_t LINE_FIELDS = 2;
+
+    class Source_File {
+        public:
+            // Relative to the data directory
+            string name;
+            uint64_t size;
+            // Seconds since the epoch
+            uint64_t modified;
+            uint64_t hash;
+    };
+
+    // Like 64-bit FNV-1a, but taking 8 bytes at a time rather than 1, so that checking a file stays cheap
+    uint64_t hash_text (const string& text) {
+        const unsigned char* bytes = (const unsigned char*) text.data();
+        uint64_t hash = 14695981039346656037ULL ^ text.length();
+        size_t i = 0;
+
+        for (; i + 8 <= text.length(); i += 8) {
+            uint64_t word = 0;
+
+            // Read as little endian, like the rest of the pack, so a pack is current on any machine
+            for (uint32_t n = 0; n < 8; n++) {
+                word |= (uint64_t) bytes[i + n] << (n * 8);
+            }
+
+            hash = (hash ^ word) * 1099511628211ULL;
+            hash ^= hash >> 32;
+        }
+
+        for (; i < text.length(); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    bool read_file (const string& path, string& text) {
+        ifstream file(path.c_str(), ios::binary);
+
+        if (!file.is_open()) {
+            return false;
+        }
+
+        file.seekg(0, ios::end);
+        text.resize((size_t) max((streamoff) file.tellg(), (streamoff) 0));
+        file.seekg(0, ios::beg);
+
+        return text.empty() || file.read(&text[0], text.length());
+    }
+
+    bool get_file_info (const string& path, uint64_t& size, uint64_t& modified) {
+        struct stat info;
+
+        if (stat(path.c_str(), &info) != 0) {
+            return false;
+        }
+
+        size = (uint64_t) info.st_size;
+        modified = (uint64_t) info.st_mtime;
+
+        return true;
+    }
+
+    uint64_t read_u64 (const char* data, size_t offset) {
+        const unsigned char* bytes = (const unsigned char*) data + offset;
+        uint64_t value = 0;
+
+        for (uint32_t i = 0; i < 8; i++) {
+            value |= (uint64_t) bytes[i] << (i * 8);
+        }
+
+        return value;
+    }
+
+    // Returns the regular files directly in the directory, sorted by name, leaving out hidden files
+    bool list_files (const string& directory, vector<string>& names) {
+        #ifdef GAME_OS_WINDOWS
+            WIN32_FIND_DATAA entry;
+            HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &entry);
+
+            if (find == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            do {
+                if (entry.cFileName[0] != '.' && (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+                    names.push_back(entry.cFileName);
+                }
+            } while (FindNextFileA(find, &entry));
+
+            FindClose(find);
+        #else
+            DIR* dir = opendir(directory.c_str());
+
+            if (dir == 0) {
+                return false;
+            }
+
+            while (dirent* entry = readdir(dir)) {
+                struct stat info;
+
+                if (entry->d_name[0] != '.' && stat((directory + "/" + entry->d_name).c_str(), &info) == 0 &&
+                    S_ISREG(info.st_mode)) {
+                    names.push_back(entry->d_name);
+                }
+            }
+
+            closedir(dir);
+        #endif
+
+        sort(names.begin(), names.end());
+
+        return true;
+    }
+
+    void trim (const char*& start, const char*& end) {
+        while (start < end && (*start == ' ' || *start == '\t' || *start == '\r')) {
+            start++;
+        }
+
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+            end--;
+        }
+    }
+
+    void append_u32 (vector<char>& output, uint32_t value) {
+        output.push_back((char) (value & 0xFF));
+        output.push_back((char) ((value >> 8) & 0xFF));
+        output.push_back((char) ((value >> 16) & 0xFF));
+        output.push_back((char) ((value >> 24) & 0xFF));
+    }
+
+    void append_u64 (vector<char>& output, uint64_t value) {
+        append_u32(output, (uint32_t) (value & 0xFFFFFFFF));
+        append_u32(output, (uint32_t) (value >> 32));
+    }
+
+    // Builds the string blob, sharing storage between identical strings such as tag types and common lines
+    class String_Table {
+        private:
+            map<string, uint32_t> offsets;
+
+        public:
+            vector<char> strings;
+
+            uint32_t add (const char* text, uint32_t length) {
+                string key(text, length);
+                map<string, uint32_t>::iterator i = offsets.find(key);
+
+                if (i != offsets.end()) {
+                    return i->second;
+                }
+
+                uint32_t offset = (uint32_t) strings.size();
+
+                strings.insert(strings.end(), text, text + length);
+                offsets[key] = offset;
+
+                return offset;
+            }
+    };
+}
+
+const uint32_t Data_Pack::MAGIC = 0x4B505344;
+const uint32_t Data_Pack::VERSION = 3;
+
+String_View::String_View () {
+    data = "";
+    length = 0;
+}
+
+String_View::String_View (const char* new_data, uint32_t new_length) {
+    data = new_data;
+    length = new_length;
+}
+
+String_View::String_View (const string& text) {
+    data = text.c_str();
+    length = (uint32_t) text.length();
+}
+
+bool String_View::operator== (const char* text) const {
+    return strlen(text) == length && memcmp(data, text, length) == 0;
+}
+
+bool String_View::operator!= (const char* text) const {
+    return !(*this == text);
+}
+
+bool String_View::starts_with (const char* prefix) const {
+    size_t prefix_length = strlen(prefix);
+
+    return prefix_length <= length && memcmp(data, prefix, prefix_length) == 0;
+}
+
+string String_View::to_string () const {
+    return string(data, length);
+}
+
+Data_Tag::Data_Tag () {
+    first_line = 0;
+    line_count = 0;
+}
+
+Data_Pack::Data_Pack () {
+    data = 0;
+    size = 0;
+    mapped = false;
+    #ifdef GAME_OS_WINDOWS
+        file_handle = 0;
+        mapping_handle = 0;
+    #endif
+
+    source_count = 0;
+    tag_count = 0;
+    line_count = 0;
+    strings_size = 0;
+}
+
+Data_Pack::~Data_Pack () {
+    close();
+}
+
+uint32_t Data_Pack::read_u32 (size_t offset) const {
+    const unsigned char* bytes = (const unsigned char*) data + offset;
+
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) |
+           ((uint32_t) bytes[3] << 24);
+}
+
+size_t Data_Pack::get_sources_offset () const {
+    return HEADER_FIELDS * 4;
+}
+
+size_t Data_Pack::get_tags_offset () const {
+    return get_sources_offset() + (size_t) source_count * SOURCE_FIELDS * 4;
+}
+
+size_t Data_Pack::get_lines_offset () const {
+    return get_tags_offset() + (size_t) tag_count * TAG_FIELDS * 4;
+}
+
+size_t Data_Pack::get_strings_offset () const {
+    return get_lines_offset() + (size_t) line_count * LINE_FIELDS * 4;
+}
+
+String_View Data_Pack::get_string (uint32_t offset, uint32_t length) const {
+    return String_View(data + get_strings_offset() + offset, length);
+}
+
+bool Data_Pack::map_file (const string& path) {
+    #ifdef GAME_OS_WINDOWS
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, 0);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+
+        if (mapping == 0) {
+            CloseHandle(file);
+
+            return false;
+        }
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        if (view == 0) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+
+            return false;
+        }
+
+        file_handle = file;
+        mapping_handle = mapping;
+        data = (const char*) view;
+        size = (size_t) file_size.QuadPart;
+    #else
+        int file = ::open(path.c_str(), O_RDONLY);
+
+        if (file < 0) {
+            return false;
+        }
+
+        struct stat info;
+
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            ::close(file);
+
+            return false;
+        }
+
+        void* view = mmap(0, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        // The mapping keeps its own reference to the file
+        ::close(file);
+
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        data = (const char*) view;
+        size = (size_t) info.st_size;
+    #endif
+
+    mapped = true;
+
+    return true;
+}
+
+void Data_Pack::unmap_file () {
+    if (!mapped) {
+        return;
+    }
+
+    #ifdef GAME_OS_WINDOWS
+        UnmapViewOfFile(data);
+        CloseHandle((HANDLE) mapping_handle);
+        CloseHandle((HANDLE) file_handle);
+
+        file_handle = 0;
+        mapping_handle = 0;
+    #else
+        munmap((void*) data, size);
+    #endif
+
+    mapped = false;
+}
+
+bool Data_Pack::validate () {
+    if (size < HEADER_FIELDS * 4 || read_u32(0) != MAGIC || read_u32(4) != VERSION) {
+        return false;
+    }
+
+    source_count = read_u32(8);
+    tag_count = read_u32(12);
+    line_count = read_u32(16);
+    strings_size = read_u32(20);
+
+    // Computed in 64 bits, so a corrupt count cannot wrap around
+    uint64_t expected_size = (uint64_t) HEADER_FIELDS * 4 + (uint64_t) source_count * SOURCE_FIELDS * 4 +
+                             (uint64_t) tag_count * TAG_FIELDS * 4 + (uint64_t) line_count * LINE_FIELDS * 4 +
+                             strings_size;
+
+    if (expected_size != size) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < source_count; i++) {
+        size_t entry = get_sources_offset() + (size_t) i * SOURCE_FIELDS * 4;
+
+        if ((uint64_t) read_u32(entry) + read_u32(entry + 4) > strings_size) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < tag_count; i++) {
+        size_t entry = get_tags_offset() + (size_t) i * TAG_FIELDS * 4;
+
+        if ((uint64_t) read_u32(entry) + read_u32(entry + 4) > strings_size ||
+            (uint64_t) read_u32(entry + 8) + read_u32(entry + 12) > line_count) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < line_count; i++) {
+        size_t entry = get_lines_offset() + (size_t) i * LINE_FIELDS * 4;
+
+        if ((uint64_t) read_u32(entry) + read_u32(entry + 4) > strings_size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Data_Pack::is_current (const string& data_directory) const {
+    vector<string> names;
+
+    // Adding or removing a file changes the pack as much as editing one does
+    if (!list_files(data_directory, names) || names.size() != source_count) {
+        return false;
+    }
+
+    string text;
+
+    for (uint32_t i = 0; i < source_count; i++) {
+        size_t entry = get_sources_offset() + (size_t) i * SOURCE_FIELDS * 4;
+        string path = data_directory + "/" + names[i];
+        uint64_t file_size = 0;
+        uint64_t file_modified = 0;
+
+        // Sources are stored sorted by name, like the listing
+        if (get_string(read_u32(entry), read_u32(entry + 4)) != names[i].c_str() ||
+            !get_file_info(path, file_size, file_modified) || file_size != read_u64(data, entry + 8)) {
+            return false;
+        }
+
+        // An unchanged modification time means an unchanged file, so the usual start reads none of the text
+        // Copying or installing the data changes the times but not the contents, so only then is the file hashed
+        if (file_modified != read_u64(data, entry + 16) &&
+            (!read_file(path, text) || hash_text(text) != read_u64(data, entry + 24))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Data_Pack::compile (const string& data_directory) {
+    close();
+
+    vector<string> names;
+
+    if (!list_files(data_directory, names)) {
+        return false;
+    }
+
+    vector<Source_File> sources;
+    String_Table strings;
+    // Each tag is type offset, type length, first line, line count
+    vector<uint32_t> tags;
+    // Each line is offset, length
+    vector<uint32_t> lines;
+
+    string text;
+
+    for (size_t i = 0; i < names.size(); i++) {
+        Source_File source;
+
+        source.name = names[i];
+
+        uint64_t file_size = 0;
+
+        if (!get_file_info(data_directory + "/" + names[i], file_size, source.modified) ||
+            !read_file(data_directory + "/" + names[i], text)) {
+            return false;
+        }
+
+        source.size = text.length();
+        source.hash = hash_text(text);
+
+        sources.push_back(source);
+
+        const char* position = text.c_str();
+        const char* text_end = position + text.length();
+        string closing_tag;
+        // Nested tags with the same name as the open top-level tag must close before it does
+        uint32_t nested_depth = 0;
+        bool in_tag = false;
+        bool in_comment = false;
+
+        while (position < text_end) {
+            const char* line_end = (const char*) memchr(position, '\n', text_end - position);
+
+            if (line_end == 0) {
+                line_end = text_end;
+            }
+
+            const char* start = position;
+            const char* end = line_end;
+
+            position = line_end + 1;
+
+            trim(start, end);
+
+            uint32_t length = (uint32_t) (end - start);
+
+            if (in_comment) {
+                in_comment = string(start, length).find("*/") == string::npos;
+
+                continue;
+            }
+
+            if (length >= 2 && start[0] == '/' && start[1] == '*') {
+                in_comment = string(start, length).find("*/") == string::npos;
+
+                continue;
+            }
+
+            if (length == 0 || (length >= 2 && start[0] == '/' && start[1] == '/')) {
+                continue;
+            }
+
+            if (!in_tag) {
+                if (length > 2 && start[0] == '<' && start[1] != '/' && end[-1] == '>') {
+                    in_tag = true;
+                    nested_depth = 0;
+                    closing_tag = "</" + string(start + 1, length - 1);
+
+                    tags.push_back(strings.add(start + 1, length - 2));
+                    tags.push_back(length - 2);
+                    tags.push_back((uint32_t) (lines.size() / LINE_FIELDS));
+                    tags.push_back(0);
+                }
+
+                continue;
+            }
+
+            if (closing_tag.compare(0, string::npos, start, length) == 0) {
+                if (nested_depth == 0) {
+                    in_tag = false;
+
+                    continue;
+                }
+
+                nested_depth--;
+            } else if (length == closing_tag.length() - 1 && start[0] == '<' &&
+                       closing_tag.compare(2, string::npos, start + 1, length - 1) == 0) {
+                nested_depth++;
+            }
+
+            lines.push_back(strings.add(start, length));
+            lines.push_back(length);
+            tags.back()++;
+        }
+    }
+
+    // Names of the sources are stored last, so they do not interleave with the data
+    vector<uint32_t> source_names;
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        source_names.push_back(strings.add(sources[i].name.c_str(), (uint32_t) sources[i].name.length()));
+    }
+
+    buffer.clear();
+
+    append_u32(buffer, MAGIC);
+    append_u32(buffer, VERSION);
+    append_u32(buffer, (uint32_t) sources.size());
+    append_u32(buffer, (uint32_t) (tags.size() / TAG_FIELDS));
+    append_u32(buffer, (uint32_t) (lines.size() / LINE_FIELDS));
+    append_u32(buffer, (uint32_t) strings.strings.size());
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        append_u32(buffer, source_names[i]);
+        append_u32(buffer, (uint32_t) sources[i].name.length());
+        append_u64(buffer, sources[i].size);
+        append_u64(buffer, sources[i].modified);
+        append_u64(buffer, sources[i].hash);
+    }
+
+    for (size_t i = 0; i < tags.size(); i++) {
+        append_u32(buffer, tags[i]);
+    }
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        append_u32(buffer, lines[i]);
+    }
+
+    buffer.insert(buffer.end(), strings.strings.begin(), strings.strings.end());
+
+    data = &buffer[0];
+    size = buffer.size();
+
+    return validate();
+}
+
+bool Data_Pack::write (const string& path) const {
+    if (!is_loaded()) {
+        return false;
+    }
+
+    // Written beside the pack and then moved over it, so a running game never maps a partial pack
+    string temporary_path = path + ".tmp";
+    ofstream file(temporary_path.c_str(), ios::binary | ios::trunc);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file.write(data, size);
+    file.close();
+
+    if (!file.good()) {
+        remove(temporary_path.c_str());
+
+        return false;
+    }
+
+    #ifdef GAME_OS_WINDOWS
+        return MoveFileExA(temporary_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+        return rename(temporary_path.c_str(), path.c_str()) == 0;
+    #endif
+}
+
+bool Data_Pack::open (const string& path, const string& data_directory) {
+    close();
+
+    if (!map_file(path)) {
+        ifstream file(path.c_str(), ios::binary);
+
+        if (!file.is_open()) {
+            return false;
+        }
+
+        buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+        if (buffer.empty()) {
+            return false;
+        }
+
+        data = &buffer[0];
+        size = buffer.size();
+    }
+
+    if (!validate() || !is_current(data_directory)) {
+        close();
+
+        return false;
+    }
+
+    return true;
+}
+
+void Data_Pack::close () {
+    unmap_file();
+
+    buffer.clear();
+
+    data = 0;
+    size = 0;
+    source_count = 0;
+    tag_count = 0;
+    line_count = 0;
+    strings_size = 0;
+}
+
+bool Data_Pack::is_mapped () const {
+    return mapped;
+}
+
+bool Data_Pack::is_loaded () const {
+    return data != 0;
+}
+
+uint32_t Data_Pack::get_tag_count () const {
+    return tag_count;
+}
+
+Data_Tag Data_Pack::get_tag (uint32_t index) const {
+    size_t entry = get_tags_offset() + (size_t) index * TAG_FIELDS * 4;
+    Data_Tag tag;
+
+    tag.type = get_string(read_u32(entry), read_u32(entry + 4));
+    tag.first_line = read_u32(entry + 8);
+    tag.line_count = read_u32(entry + 12);
+
+    return tag;
+}
+
+String_View Data_Pack::get_line (const Data_Tag& tag, uint32_t line) const {
+    size_t entry = get_lines_offset() + (size_t) (tag.first_line + line) * LINE_FIELDS * 4;
+
+    return get_string(read_u32(entry), read_u32(entry + 4));
+}
+
+void Data_Pack::find_tags (const char* type, vector<uint32_t>& indices) const {
+    for (uint32_t i = 0; i < tag_count; i++) {
+        size_t entry = get_tags_offset() + (size_t) i * TAG_FIELDS * 4;
+
+        if (get_string(read_u32(entry), read_u32(entry + 4)) == type) {
+            indices.push_back(i);
+        }
+    }
+}
+
+void Data_Pack::get_lines (const Data_Tag& tag, vector<String_View>& lines) const {
+    lines.clear();
+
+    for (uint32_t i = 0; i < tag.line_count; i++) {
+        lines.push_back(get_line(tag, i));
+    }
+}
+
+bool Data_Pack::check_prefix (String_View& line, const char* prefix) {
+    if (!line.starts_with(prefix)) {
+        return false;
+    }
+
+    uint32_t prefix_length = (uint32_t) strlen(prefix);
+
+    line.data += prefix_length;
+    line.length -= prefix_length;
+
+    return true;
+}
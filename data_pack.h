@@ -0,0 +1,113 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef data_pack_h
+#define data_pack_h
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Characters owned by someone else, usually a Data_Pack
+class String_View {
+    public:
+        const char* data;
+        uint32_t length;
+
+        String_View ();
+        String_View (const char* new_data, uint32_t new_length);
+        String_View (const std::string& text);
+
+        bool operator== (const char* text) const;
+        bool operator!= (const char* text) const;
+
+        bool starts_with(const char* prefix) const;
+        std::string to_string() const;
+};
+
+// One top-level tag from the data files, such as a single <game_constant> block
+class Data_Tag {
+    public:
+        String_View type;
+        uint32_t first_line;
+        // The lines between the opening and closing tags, trimmed, without blank lines or comments
+        // Nested tags are left in as lines
+        uint32_t line_count;
+
+        Data_Tag ();
+};
+
+// Every top-level tag of the text files in the data directory, compiled into a single versioned binary file
+// An opened pack is memory mapped and read in place, so tags and lines are views into the file rather than copies
+// A pack remembers the name, size, modification time and content hash of every file it was compiled from, and is
+// refused if any of them has changed, so an out of date pack can never be used
+// Only a file whose modification time has changed is read and hashed, so opening a current pack reads no text
+class Data_Pack {
+    private:
+        static const uint32_t MAGIC;
+        static const uint32_t VERSION;
+
+        // Holds the pack when it was compiled in memory, or when the file could not be mapped
+        std::vector<char> buffer;
+        const char* data;
+        size_t size;
+        bool mapped;
+        #ifdef GAME_OS_WINDOWS
+            void* file_handle;
+            void* mapping_handle;
+        #endif
+
+        uint32_t source_count;
+        uint32_t tag_count;
+        uint32_t line_count;
+        uint32_t strings_size;
+
+        Data_Pack (const Data_Pack&);
+        Data_Pack& operator= (const Data_Pack&);
+
+        uint32_t read_u32(size_t offset) const;
+        size_t get_sources_offset() const;
+        size_t get_tags_offset() const;
+        size_t get_lines_offset() const;
+        size_t get_strings_offset() const;
+        String_View get_string(uint32_t offset, uint32_t length) const;
+
+        bool map_file(const std::string& path);
+        void unmap_file();
+        // Checks that every table and string lies within the pack
+        bool validate();
+        bool is_current(const std::string& data_directory) const;
+
+    public:
+        Data_Pack ();
+        ~Data_Pack ();
+
+        // Compiles the text files in data_directory into a pack held in memory
+        // Returns false if the directory could not be read
+        bool compile(const std::string& data_directory);
+        bool write(const std::string& path) const;
+        // Returns false if the pack is missing, malformed, from another version of the format,
+        // or out of date with the files in data_directory
+        bool open(const std::string& path, const std::string& data_directory);
+        void close();
+
+        // Returns true if the tags are being read from a pack file rather than from the text data
+        bool is_mapped() const;
+        bool is_loaded() const;
+
+        uint32_t get_tag_count() const;
+        Data_Tag get_tag(uint32_t index) const;
+        String_View get_line(const Data_Tag& tag, uint32_t line) const;
+        // Appends the index of every tag of the passed type, in the order they appear in the data
+        void find_tags(const char* type, std::vector<uint32_t>& indices) const;
+        // Fills lines with the lines of the tag, reusing its storage
+        void get_lines(const Data_Tag& tag, std::vector<String_View>& lines) const;
+
+        // Works like Data_Reader::check_prefix
+        // If line starts with prefix, removes the prefix from line and returns true
+        static bool check_prefix(String_View& line, const char* prefix);
+};
+
+#endif
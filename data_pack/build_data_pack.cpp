@@ -0,0 +1,35 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+// Compiles the text files of a data directory into a binary data pack
+// Usage: build_data_pack [data directory] [pack file]
+
+#include "data_pack.h"
+
+#include <iostream>
+
+using namespace std;
+
+int main (int argc, char* args[]) {
+    string data_directory = argc > 1 ? args[1] : "data";
+    string pack_path = argc > 2 ? args[2] : data_directory + ".pack";
+
+    Data_Pack pack;
+
+    if (!pack.compile(data_directory)) {
+        cerr << "Error reading data directory " << data_directory << "\n";
+
+        return 1;
+    }
+
+    if (!pack.write(pack_path)) {
+        cerr << "Error writing data pack " << pack_path << "\n";
+
+        return 1;
+    }
+
+    cout << "Compiled " << pack.get_tag_count() << " tags from " << data_directory << " into " << pack_path << "\n";
+
+    return 0;
+}
@@ -0,0 +1,380 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "dedicated_server.h"
+#include "game.h"
+#include "game_constants.h"
+#include "job_system.h"
+#include "replay.h"
+#include "command_ids.h"
+
+#include <game_manager.h>
+#include <game_constants_loader.h>
+#include <network_engine.h>
+#include <network_server.h>
+#include <options.h>
+#include <engine_strings.h>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    string trim (const string& text) {
+        size_t start = text.find_first_not_of(" \t\r");
+
+        if (start == string::npos) {
+            return "";
+        }
+
+        return text.substr(start, text.find_last_not_of(" \t\r") - start + 1);
+    }
+
+    // Returns true if line is "key:value", and if so sets value
+    bool read_key (const string& line, const string& key, string& value) {
+        if (line.compare(0, key.length() + 1, key + ":") == 0) {
+            value = line.substr(key.length() + 1);
+
+            return true;
+        }
+
+        return false;
+    }
+}
+
+string Dedicated_Server::data_directory = "data";
+Data_Pack Dedicated_Server::data_pack;
+double Dedicated_Server::tick_rate = 60.0;
+uint16_t Dedicated_Server::port = 1234;
+uint32_t Dedicated_Server::max_clients = 8;
+uint32_t Dedicated_Server::worker_threads = 0;
+uint64_t Dedicated_Server::tick_limit = 0;
+string Dedicated_Server::replay_path = "";
+uint64_t Dedicated_Server::seek_tick = 0;
+uint64_t Dedicated_Server::world_seed = 0;
+bool Dedicated_Server::world_seed_set = false;
+string Dedicated_Server::record_path = "";
+atomic<bool> Dedicated_Server::stop_requested(false);
+
+void Dedicated_Server::handle_signal (int) {
+    stop_requested = true;
+}
+
+void Dedicated_Server::print_usage () {
+    cout << "Usage: Pirates --dedicated [options]\n";
+    cout << "  --data <directory>     Directory containing the game's data files (default: data)\n";
+    cout << "  --port <port>          Port to listen on (default: 1234)\n";
+    cout << "  --max-clients <count>  Maximum number of connected clients (default: 8)\n";
+    cout << "  --tick-rate <rate>     Ticks per second (default: logic_update_rate from the engine data file)\n";
+    cout << "  --ticks <count>        Stop after this many ticks, 0 to run until stopped (default: 0)\n";
+    cout << "  --threads <count>      Simulation worker threads, 0 for one per core (default: 0)\n";
+    cout << "  --record <file>        Record the hosted game to a replay\n";
+    cout << "  --replay <file>        Play a replay back as fast as possible instead of hosting a game\n";
+    cout << "  --seek <tick>          Start the replay from this tick (default: the start of the replay)\n";
+    cout << "  --seed <seed>          Seed of the generated world (default: world_seed from the game constants)\n";
+    cout << "  --help                 Show this message\n";
+}
+
+bool Dedicated_Server::parse_arguments (int argc, char* args[]) {
+    bool tick_rate_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = args[i];
+
+        if (argument == "--dedicated") {
+            continue;
+        } else if (argument == "--help") {
+            return false;
+        } else if (argument != "--data" && argument != "--port" && argument != "--max-clients" &&
+                   argument != "--tick-rate" && argument != "--ticks" && argument != "--threads" &&
+                   argument != "--record" && argument != "--replay" && argument != "--seek" &&
+                   argument != "--seed") {
+            cout << "Unknown option: " << argument << "\n";
+
+            return false;
+        } else if (i + 1 >= argc) {
+            cout << "Missing value for option: " << argument << "\n";
+
+            return false;
+        }
+
+        string value = args[++i];
+
+        if (argument == "--data") {
+            data_directory = value;
+        } else if (argument == "--port") {
+            port = (uint16_t) Strings::string_to_unsigned_long(value);
+        } else if (argument == "--max-clients") {
+            max_clients = (uint32_t) Strings::string_to_unsigned_long(value);
+        } else if (argument == "--tick-rate") {
+            tick_rate = Strings::string_to_double(value);
+            tick_rate_set = true;
+        } else if (argument == "--ticks") {
+            tick_limit = Strings::string_to_unsigned_long(value);
+        } else if (argument == "--threads") {
+            worker_threads = (uint32_t) Strings::string_to_unsigned_long(value);
+        } else if (argument == "--record") {
+            record_path = value;
+        } else if (argument == "--replay") {
+            replay_path = value;
+        } else if (argument == "--seek") {
+            seek_tick = Strings::string_to_unsigned_long(value);
+        } else if (argument == "--seed") {
+            world_seed = Strings::string_to_unsigned_long(value);
+            world_seed_set = true;
+        }
+    }
+
+    if (!tick_rate_set) {
+        load_tick_rate();
+    }
+
+    if (tick_rate <= 0.0) {
+        cout << "Tick rate must be greater than 0\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+void Dedicated_Server::load_tick_rate () {
+    ifstream file((data_directory + "/engine").c_str());
+    string line;
+
+    while (getline(file, line)) {
+        string value;
+
+        if (read_key(trim(line), "logic_update_rate", value)) {
+            tick_rate = Strings::string_to_double(value);
+
+            return;
+        }
+    }
+}
+
+bool Dedicated_Server::load_data_pack () {
+    string pack_path = data_directory + ".pack";
+
+    if (data_pack.open(pack_path, data_directory)) {
+        return true;
+    }
+
+    cout << "Data pack " << pack_path << " is missing or out of date, reading the text data instead\n";
+
+    if (!data_pack.compile(data_directory)) {
+        cout << "Error loading data from " << data_directory << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+void Dedicated_Server::load_game_constants () {
+    vector<uint32_t> tags;
+    vector<String_View> lines;
+
+    data_pack.find_tags("game_constant", tags);
+
+    for (size_t i = 0; i < tags.size(); i++) {
+        string name;
+        string value;
+
+        data_pack.get_lines(data_pack.get_tag(tags[i]), lines);
+
+        for (size_t n = 0; n < lines.size(); n++) {
+            String_View& line = lines[n];
+
+            if (Data_Pack::check_prefix(line, "name:")) {
+                name = line.to_string();
+            } else if (Data_Pack::check_prefix(line, "value:")) {
+                value = line.to_string();
+            }
+        }
+
+        if (name.length() > 0) {
+            Game_Constants_Loader::set_game_constant(name, value);
+        }
+    }
+}
+
+void Dedicated_Server::load_game_commands () {
+    vector<uint32_t> tags;
+    vector<String_View> lines;
+    vector<string> names;
+
+    data_pack.find_tags("game_command", tags);
+
+    for (size_t i = 0; i < tags.size(); i++) {
+        data_pack.get_lines(data_pack.get_tag(tags[i]), lines);
+
+        for (size_t n = 0; n < lines.size(); n++) {
+            String_View& line = lines[n];
+
+            if (Data_Pack::check_prefix(line, "name:")) {
+                names.push_back(line.to_string());
+            }
+        }
+    }
+
+    Command_Ids::setup(names);
+}
+
+void Dedicated_Server::tick () {
+    Game_Manager::handle_command_states_multiplayer();
+    Game_Manager::handle_game_commands_multiplayer();
+
+    // Animation and everything after it only affect what is drawn, so they are skipped
+    Game::tick();
+    Game::ai();
+    Game::movement();
+    Game::events();
+}
+
+int Dedicated_Server::run_replay () {
+    if (!Replay_Player::load(replay_path)) {
+        cout << "Error loading replay " << replay_path << "\n";
+
+        return 1;
+    }
+
+    const Replay& replay = Replay_Player::get_replay();
+    uint64_t start_tick = max(seek_tick, replay.keyframes[0].tick);
+    uint64_t end_tick = tick_limit > 0 ? min(start_tick + tick_limit, replay.end_tick) : replay.end_tick;
+
+    chrono::steady_clock::time_point seek_start = chrono::steady_clock::now();
+
+    if (!Replay_Player::seek(start_tick)) {
+        cout << "Error seeking to tick " << start_tick << "\n";
+
+        return 1;
+    }
+
+    chrono::steady_clock::time_point play_start = chrono::steady_clock::now();
+
+    uint64_t ticks = Replay_Player::advance(end_tick);
+
+    chrono::steady_clock::time_point play_end = chrono::steady_clock::now();
+    double seek_seconds = chrono::duration<double>(play_start - seek_start).count();
+    double play_seconds = chrono::duration<double>(play_end - play_start).count();
+
+    cout << "Replay " << replay_path << " ticks " << start_tick << " to " << Game::current_tick << "\n";
+    cout << "Seek took " << seek_seconds << " seconds\n";
+    cout << "Simulated " << ticks << " ticks in " << play_seconds << " seconds (" <<
+        (play_seconds > 0.0 ? (double) ticks / play_seconds : 0.0) << " ticks per second)\n";
+
+    int exit_code = 0;
+
+    if (Replay_Player::get_first_divergent_tick() != 0) {
+        cout << "Diverged from the recording by tick " << Replay_Player::get_first_divergent_tick() << "\n";
+
+        exit_code = 2;
+    } else {
+        cout << "Matched the recording\n";
+    }
+
+    Game::clear_world();
+
+    return exit_code;
+}
+
+bool Dedicated_Server::is_requested (int argc, char* args[]) {
+    for (int i = 1; i < argc; i++) {
+        if (string(args[i]) == "--dedicated") {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int Dedicated_Server::run (int argc, char* args[]) {
+    if (!parse_arguments(argc, args)) {
+        print_usage();
+
+        return 1;
+    }
+
+    if (!load_data_pack()) {
+        return 1;
+    }
+
+    load_game_constants();
+    load_game_commands();
+
+    Game::world_seed = world_seed_set ? world_seed : Game_Constants::WORLD_SEED;
+
+    // Everything needed from the data has been copied out
+    data_pack.close();
+
+    Job_System::start(worker_threads);
+
+    if (replay_path.length() > 0) {
+        return run_replay();
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    Game::generate_world();
+
+    Game_Manager::in_progress = true;
+
+    if (record_path.length() > 0 && !Replay_Recorder::start(record_path)) {
+        cout << "Error opening replay file " << record_path << "\n";
+
+        return 1;
+    }
+
+    Options::server_port = port;
+    Options::server_max_connections = max_clients;
+
+    Network_Server::start_as_server();
+
+    cout << "Dedicated server listening on port " << port << " at " << tick_rate << " ticks per second\n";
+
+    chrono::steady_clock::duration tick_duration = chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(1.0 / tick_rate));
+    chrono::steady_clock::time_point next_tick = chrono::steady_clock::now();
+    uint64_t ticks = 0;
+
+    while (!stop_requested && (tick_limit == 0 || ticks < tick_limit)) {
+        Network_Engine::receive_packets();
+
+        tick();
+
+        Network_Server::send_updates();
+
+        ticks++;
+        next_tick += tick_duration;
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+        if (next_tick > now) {
+            this_thread::sleep_until(next_tick);
+        } else if (now - next_tick > chrono::seconds(1)) {
+            // After a long stall, give up on catching up rather than running a burst of ticks
+            next_tick = now;
+        }
+    }
+
+    Network_Engine::stop();
+
+    Replay_Recorder::stop();
+
+    Game_Manager::in_progress = false;
+
+    Game::clear_world();
+
+    cout << "Dedicated server stopped after " << ticks << " ticks\n";
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef dedicated_server_h
+#define dedicated_server_h
+
+#include "data_pack.h"
+
+#include <string>
+#include <cstdint>
+#include <atomic>
+
+// Hosts a game without a window, renderer or audio
+// Only the simulation and the network run, so many instances can share one machine
+class Dedicated_Server {
+    private:
+        static std::string data_directory;
+        static Data_Pack data_pack;
+        static double tick_rate;
+        static uint16_t port;
+        static uint32_t max_clients;
+        static uint32_t worker_threads;
+        // 0 means run until stopped
+        static uint64_t tick_limit;
+        // If set, plays this replay back as fast as possible instead of hosting a game
+        static std::string replay_path;
+        static uint64_t seek_tick;
+        static uint64_t world_seed;
+        static bool world_seed_set;
+        // If set, records the hosted game to this replay
+        static std::string record_path;
+
+        static std::atomic<bool> stop_requested;
+
+        static void handle_signal(int signal_number);
+        static void print_usage();
+        // Returns false if the arguments are invalid
+        static bool parse_arguments(int argc, char* args[]);
+        // Reads the engine's logic update rate, so the server ticks at the same rate as the clients
+        static void load_tick_rate();
+        // Opens the compiled data pack beside the data directory, or reads the text data if the pack is unusable
+        // Returns false if neither could be read
+        static bool load_data_pack();
+        static void load_game_constants();
+        // Command IDs are assigned in load order, so the server must intern the same commands as its clients
+        static void load_game_commands();
+        static void tick();
+        static int run_replay();
+
+    public:
+        // Returns true if the command line asks for a dedicated server instead of the normal game
+        static bool is_requested(int argc, char* args[]);
+        // Returns the process exit code
+        static int run(int argc, char* args[]);
+};
+
+#endif
@@ -2,6 +2,12 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "game.h"
+#include "frame_profiler.h"
+#include "trace_profiler.h"
+#include "text_cache.h"
+#include "game_constants.h"
+
 #include <engine.h>
 #include <game_manager.h>
 #include <font.h>
@@ -11,20 +17,114 @@
 #include <render.h>
 #include <engine_strings.h>
 
+#include <cmath>
+
 using namespace std;
 
+namespace {
+    // Each bar of the frame time graph is this many pixels wide
+    const double GRAPH_BAR_WIDTH = 2.0;
+    // The graph is tall enough to show frames up to twice the budget
+    const double GRAPH_HEIGHT = 48.0;
+
+    // The text as of the last rebuild, along with its size in characters
+    string dev_info_text = "";
+    uint32_t dev_info_columns = 0;
+    uint32_t dev_info_lines = 0;
+    bool dev_info_in_progress = false;
+    uint32_t frames_since_dev_info = 0;
+
+    string microseconds_to_ms_string (uint32_t microseconds) {
+        return Strings::num_to_string(round((double) microseconds / 10.0) / 100.0);
+    }
+
+    void render_frame_graph (double x, double y) {
+        uint32_t samples[Profile_Ring::CAPACITY];
+        uint32_t count = Frame_Profiler::get_frames().get_recent(samples);
+        double budget = 1000000.0 / Engine::UPDATE_RATE;
+        double scale = GRAPH_HEIGHT / (budget * 2.0);
+
+        Render::render_rectangle(x, y, Profile_Ring::CAPACITY * GRAPH_BAR_WIDTH, GRAPH_HEIGHT, 0.75, "ui_black");
+
+        for (uint32_t i = 0; i < count; i++) {
+            double height = samples[i] * scale;
+
+            if (height > GRAPH_HEIGHT) {
+                height = GRAPH_HEIGHT;
+            }
+
+            Render::render_rectangle(x + i * GRAPH_BAR_WIDTH, y + GRAPH_HEIGHT - height, GRAPH_BAR_WIDTH, height, 1.0,
+                                     samples[i] > budget ? "red" : "text_input_green");
+        }
+
+        // The budget line
+        Render::render_rectangle(x, y + GRAPH_HEIGHT / 2.0, Profile_Ring::CAPACITY * GRAPH_BAR_WIDTH, 1.0, 1.0,
+                                 "text_input_yellow");
+    }
+
+    string build_dev_info () {
+        string msg = "";
+
+        if (Game_Manager::in_progress) {
+            msg += "Camera Position: " + Strings::num_to_string(Game_Manager::camera.x) + "," +
+                   Strings::num_to_string(Game_Manager::camera.y) + "\n";
+            msg += "Camera Size: " + Strings::num_to_string(Game_Manager::camera.w / Game_Manager::camera_zoom) +
+                   "," + Strings::num_to_string(Game_Manager::camera.h / Game_Manager::camera_zoom) + "\n";
+            msg += "Camera Zoom: " + Strings::num_to_string(Game_Manager::camera_zoom) + "\n";
+            msg += "Chunks: " + Strings::num_to_string(Game::world_map.get_resident_count()) + " resident, " +
+                   Strings::num_to_string(Game::world_map.get_compressed_count()) + " compressed, " +
+                   Strings::num_to_string(Game::world_map.get_pending_count()) + " pending\n";
+            msg += "Sprites: " + Strings::num_to_string(Game::sprite_batch.get_sprite_count()) + " added, " +
+                   Strings::num_to_string(Game::sprite_batch.get_culled_count()) + " culled, " +
+                   Strings::num_to_string(Game::sprite_batch.get_batch_count()) + " draw calls\n";
+            msg += "Navigation: " + Strings::num_to_string(Game::navigation.get_queue_length()) + " queued, " +
+                   Strings::num_to_string(Game::navigation.get_flow_field_count()) + " flow fields\n";
+            msg += "AI: " + Strings::num_to_string(Game::ai_scheduler.get_tier_count(AI_LOD_TIER_FULL)) + " full, " +
+                   Strings::num_to_string(Game::ai_scheduler.get_tier_count(AI_LOD_TIER_REDUCED)) + " reduced, " +
+                   Strings::num_to_string(Game::ai_scheduler.get_tier_count(AI_LOD_TIER_COARSE)) + " coarse, " +
+                   Strings::num_to_string(Game::ai_scheduler.get_scheduled_count()) + " thinking, " +
+                   Strings::num_to_string(Game::ai_scheduler.get_deferred_count()) + " deferred\n";
+            msg += "Effects: " + Strings::num_to_string(Game::particles.get_effect_count()) + " effects, " +
+                   Strings::num_to_string(Game::particles.get_particle_count()) + " particles\n";
+
+            // Rolling average and worst time in milliseconds over the last samples of each hook
+            msg += "Budget: " + Strings::num_to_string(round(100000.0 / Engine::UPDATE_RATE) / 100.0) + " ms\n";
+
+            for (uint32_t i = 0; i < PROFILER_PHASE_COUNT; i++) {
+                const Profile_Ring& phase = Frame_Profiler::get_phase(i);
+
+                msg += string(Frame_Profiler::get_phase_name(i)) + ": " +
+                       microseconds_to_ms_string(phase.get_average()) + " avg, " +
+                       microseconds_to_ms_string(phase.get_worst()) + " worst\n";
+            }
+
+            const Profile_Ring& frames = Frame_Profiler::get_frames();
+
+            msg += "frame: " + microseconds_to_ms_string(frames.get_average()) + " avg, " +
+                   microseconds_to_ms_string(frames.get_worst()) + " worst\n";
+        }
+
+        return msg;
+    }
+}
+
 void Engine::render_dev_info () {
-    string msg = "";
-
-    if (Game_Manager::in_progress) {
-        msg += "Camera Position: " + Strings::num_to_string(Game_Manager::camera.x) + "," + Strings::num_to_string(
-            Game_Manager::camera.y) + "\n";
-        msg += "Camera Size: " + Strings::num_to_string(Game_Manager::camera.w / Game_Manager::camera_zoom) + "," +
-               Strings::num_to_string(Game_Manager::camera.h / Game_Manager::camera_zoom) + "\n";
-        msg += "Camera Zoom: " + Strings::num_to_string(Game_Manager::camera_zoom) + "\n";
+    Trace_Scope trace("render_dev_info", "render");
+
+    // The text is rebuilt every few frames, or right away when a game starts or ends,
+    // and is drawn from the text cache in between
+    if (frames_since_dev_info >= Game_Constants::DEV_INFO_REFRESH_INTERVAL ||
+        dev_info_in_progress != Game_Manager::in_progress) {
+        dev_info_text = build_dev_info();
+        dev_info_columns = Strings::longest_line(dev_info_text);
+        dev_info_lines = Strings::newline_count(dev_info_text);
+        dev_info_in_progress = Game_Manager::in_progress;
+        frames_since_dev_info = 0;
     }
 
-    if (msg.length() > 0) {
+    frames_since_dev_info++;
+
+    if (dev_info_text.length() > 0) {
         Bitmap_Font* font = Object_Manager::get_font("small");
         double y = 2.0;
 
@@ -36,8 +136,12 @@ void Engine::render_dev_info () {
             }
         }
 
-        Render::render_rectangle(2.0, y, Strings::longest_line(msg) * font->spacing_x, Strings::newline_count(
-                                     msg) * font->spacing_y, 0.75, "ui_black");
-        font->show(2.0, y, msg, "red");
+        Render::render_rectangle(2.0, y, dev_info_columns * font->spacing_x, dev_info_lines * font->spacing_y, 0.75,
+                                 "ui_black");
+        Text_Cache::show(font, 2.0, y, dev_info_text, "red");
+
+        if (Game_Manager::in_progress) {
+            render_frame_graph(2.0, y + dev_info_lines * font->spacing_y + 2.0);
+        }
     }
 }
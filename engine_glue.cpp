@@ -6,6 +6,8 @@
 #include "game_options.h"
 #include "network_game.h"
 #include "game.h"
+#include "frame_profiler.h"
+#include "trace_profiler.h"
 
 #include <game_manager.h>
 #include <game_option.h>
@@ -15,14 +17,20 @@
 using namespace std;
 
 void Game_Manager::load_data_game (Progress_Bar& bar) {
+    Trace_Scope trace("load_data_game", "load");
+
     Game_Data::load_data_game(bar);
 }
 
 void Game_Manager::load_data_tag_game (string tag, File_IO_Load* load) {
+    Trace_Scope trace("load_data_tag_game", "load");
+
     Game_Data::load_data_tag_game(tag, load);
 }
 
 void Game_Manager::unload_data_game () {
+    Trace_Scope trace("unload_data_game", "load");
+
     Game_Data::unload_data_game();
 }
 
@@ -79,41 +87,66 @@ void Game_World::clear_world () {
 }
 
 void Game_World::generate_world () {
+    Trace_Scope trace("generate_world", "game");
+
     Game::generate_world();
 }
 
 void Game_World::tick () {
+    Phase_Timer timer(PROFILER_PHASE_TICK);
+
     Game::tick();
 }
 
 void Game_World::ai () {
+    Phase_Timer timer(PROFILER_PHASE_AI);
+
     Game::ai();
 }
 
 void Game_World::movement () {
+    Phase_Timer timer(PROFILER_PHASE_MOVEMENT);
+
     Game::movement();
 }
 
 void Game_World::events () {
+    Phase_Timer timer(PROFILER_PHASE_EVENTS);
+
     Game::events();
 }
 
 void Game_World::animate () {
+    Phase_Timer timer(PROFILER_PHASE_ANIMATE);
+
     Game::animate();
 }
 
 void Game_World::render () {
-    Game::render();
+    {
+        Phase_Timer timer(PROFILER_PHASE_RENDER);
+
+        Game::render();
+    }
+
+    // The game is rendered once per frame, so this is where one frame's hooks end and the next frame's begin
+    Frame_Profiler::end_frame();
 }
 
 void Game_World::render_to_textures () {
+    Phase_Timer timer(PROFILER_PHASE_RENDER_TO_TEXTURES);
+
     Game::render_to_textures();
 }
 
 void Game_World::update_background () {
+    Phase_Timer timer(PROFILER_PHASE_UPDATE_BACKGROUND);
+
     Game::update_background();
 }
 
 void Game_World::render_background () {
+    Phase_Timer timer(PROFILER_PHASE_RENDER_BACKGROUND);
+
     Game::render_background();
 }
@@ -0,0 +1,286 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "entity_store.h"
+
+using namespace std;
+
+Entity_Handle::Entity_Handle () {
+    index = 0;
+    generation = 0;
+}
+
+Entity_Handle::Entity_Handle (uint32_t new_index, uint32_t new_generation) {
+    index = new_index;
+    generation = new_generation;
+}
+
+bool Entity_Handle::operator== (const Entity_Handle& other) const {
+    return index == other.index && generation == other.generation;
+}
+
+bool Entity_Handle::operator!= (const Entity_Handle& other) const {
+    return !(*this == other);
+}
+
+const uint32_t Entity_Store::INVALID_DENSE = 0xFFFFFFFF;
+
+void Entity_Store::clear () {
+    index_to_dense.clear();
+    generations.clear();
+    free_indices.clear();
+    dense_to_index.clear();
+    destroy_queue.clear();
+
+    type.clear();
+    x.clear();
+    y.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+    heading.clear();
+    hull.clear();
+    ai_state.clear();
+}
+
+void Entity_Store::reserve (uint32_t count) {
+    index_to_dense.reserve(count);
+    generations.reserve(count);
+    dense_to_index.reserve(count);
+
+    type.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    velocity_x.reserve(count);
+    velocity_y.reserve(count);
+    heading.reserve(count);
+    hull.reserve(count);
+    ai_state.reserve(count);
+}
+
+uint32_t Entity_Store::size () const {
+    return (uint32_t) dense_to_index.size();
+}
+
+uint32_t Entity_Store::get_index_count () const {
+    return (uint32_t) index_to_dense.size();
+}
+
+Entity_Handle Entity_Store::create (Entity_Type entity_type, const Fixed& new_x, const Fixed& new_y) {
+    uint32_t index = 0;
+
+    if (!free_indices.empty()) {
+        index = free_indices.back();
+        free_indices.pop_back();
+    } else {
+        index = (uint32_t) generations.size();
+
+        generations.push_back(0);
+        index_to_dense.push_back(INVALID_DENSE);
+    }
+
+    uint32_t dense = size();
+
+    index_to_dense[index] = dense;
+    dense_to_index.push_back(index);
+
+    type.push_back(entity_type);
+    x.push_back(new_x);
+    y.push_back(new_y);
+    velocity_x.push_back(Fixed());
+    velocity_y.push_back(Fixed());
+    heading.push_back(Fixed());
+    hull.push_back(0);
+    ai_state.push_back(ENTITY_AI_STATE_IDLE);
+
+    return Entity_Handle(index, generations[index]);
+}
+
+void Entity_Store::write (RakNet::BitStream& bitstream) const {
+    uint32_t index_count = get_index_count();
+    uint32_t free_count = (uint32_t) free_indices.size();
+    uint32_t count = size();
+
+    bitstream.WriteCompressed(index_count);
+
+    for (uint32_t i = 0; i < index_count; i++) {
+        bitstream.WriteCompressed(generations[i]);
+    }
+
+    bitstream.WriteCompressed(free_count);
+
+    for (uint32_t i = 0; i < free_count; i++) {
+        bitstream.WriteCompressed(free_indices[i]);
+    }
+
+    // The dense order matters too, since every phase iterates in it
+    bitstream.WriteCompressed(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        bitstream.WriteCompressed(dense_to_index[i]);
+        bitstream.Write(type[i]);
+        bitstream.Write(x[i].raw);
+        bitstream.Write(y[i].raw);
+        bitstream.Write(velocity_x[i].raw);
+        bitstream.Write(velocity_y[i].raw);
+        bitstream.Write(heading[i].raw);
+        bitstream.Write(hull[i]);
+        bitstream.Write(ai_state[i]);
+    }
+}
+
+bool Entity_Store::read (RakNet::BitStream& bitstream) {
+    clear();
+
+    uint32_t index_count = 0;
+
+    if (!bitstream.ReadCompressed(index_count)) {
+        return false;
+    }
+
+    generations.resize(index_count, 0);
+    index_to_dense.resize(index_count, INVALID_DENSE);
+
+    for (uint32_t i = 0; i < index_count; i++) {
+        if (!bitstream.ReadCompressed(generations[i])) {
+            return false;
+        }
+    }
+
+    uint32_t free_count = 0;
+
+    if (!bitstream.ReadCompressed(free_count) || free_count > index_count) {
+        return false;
+    }
+
+    free_indices.resize(free_count, 0);
+
+    for (uint32_t i = 0; i < free_count; i++) {
+        if (!bitstream.ReadCompressed(free_indices[i])) {
+            return false;
+        }
+    }
+
+    uint32_t count = 0;
+
+    if (!bitstream.ReadCompressed(count) || count > index_count) {
+        return false;
+    }
+
+    reserve(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index = 0;
+
+        if (!bitstream.ReadCompressed(index) || index >= index_count) {
+            return false;
+        }
+
+        dense_to_index.push_back(index);
+        index_to_dense[index] = i;
+
+        type.push_back(0);
+        x.push_back(Fixed());
+        y.push_back(Fixed());
+        velocity_x.push_back(Fixed());
+        velocity_y.push_back(Fixed());
+        heading.push_back(Fixed());
+        hull.push_back(0);
+        ai_state.push_back(0);
+
+        if (!bitstream.Read(type[i]) || !bitstream.Read(x[i].raw) || !bitstream.Read(y[i].raw) ||
+            !bitstream.Read(velocity_x[i].raw) || !bitstream.Read(velocity_y[i].raw) ||
+            !bitstream.Read(heading[i].raw) || !bitstream.Read(hull[i]) || !bitstream.Read(ai_state[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Entity_Store::destroy_dense (uint32_t dense) {
+    uint32_t last = size() - 1;
+    uint32_t index = dense_to_index[dense];
+
+    if (dense != last) {
+        uint32_t moved_index = dense_to_index[last];
+
+        dense_to_index[dense] = moved_index;
+        index_to_dense[moved_index] = dense;
+
+        type[dense] = type[last];
+        x[dense] = x[last];
+        y[dense] = y[last];
+        velocity_x[dense] = velocity_x[last];
+        velocity_y[dense] = velocity_y[last];
+        heading[dense] = heading[last];
+        hull[dense] = hull[last];
+        ai_state[dense] = ai_state[last];
+    }
+
+    dense_to_index.pop_back();
+
+    type.pop_back();
+    x.pop_back();
+    y.pop_back();
+    velocity_x.pop_back();
+    velocity_y.pop_back();
+    heading.pop_back();
+    hull.pop_back();
+    ai_state.pop_back();
+
+    index_to_dense[index] = INVALID_DENSE;
+    generations[index]++;
+    free_indices.push_back(index);
+}
+
+void Entity_Store::destroy (const Entity_Handle& handle) {
+    uint32_t dense = get_dense(handle);
+
+    if (dense != INVALID_DENSE) {
+        destroy_dense(dense);
+    }
+}
+
+void Entity_Store::queue_destroy (const Entity_Handle& handle) {
+    destroy_queue.push_back(handle);
+}
+
+const vector<Entity_Handle>& Entity_Store::get_destroy_queue () const {
+    return destroy_queue;
+}
+
+void Entity_Store::flush_destroy_queue () {
+    for (size_t i = 0; i < destroy_queue.size(); i++) {
+        // The same entity may have been queued more than once, so stale handles are expected here
+        destroy(destroy_queue[i]);
+    }
+
+    destroy_queue.clear();
+}
+
+bool Entity_Store::is_alive (const Entity_Handle& handle) const {
+    return get_dense(handle) != INVALID_DENSE;
+}
+
+uint32_t Entity_Store::get_dense (const Entity_Handle& handle) const {
+    if (handle.index < generations.size() && generations[handle.index] == handle.generation) {
+        return index_to_dense[handle.index];
+    }
+
+    return INVALID_DENSE;
+}
+
+uint32_t Entity_Store::get_dense_from_index (uint32_t index) const {
+    if (index < index_to_dense.size()) {
+        return index_to_dense[index];
+    }
+
+    return INVALID_DENSE;
+}
+
+Entity_Handle Entity_Store::get_handle (uint32_t dense) const {
+    uint32_t index = dense_to_index[dense];
+
+    return Entity_Handle(index, generations[index]);
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef entity_store_h
+#define entity_store_h
+
+#include "fixed.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+enum Entity_Type : uint8_t {
+    ENTITY_TYPE_SHIP,
+    ENTITY_TYPE_CANNONBALL
+};
+
+enum Entity_Ai_State : uint8_t {
+    ENTITY_AI_STATE_IDLE,
+    ENTITY_AI_STATE_SAILING,
+    ENTITY_AI_STATE_ATTACKING,
+    ENTITY_AI_STATE_FLEEING
+};
+
+// A handle stays valid until its entity is destroyed
+// Once the entity's slot is reused, the generation no longer matches and the old handle is rejected
+class Entity_Handle {
+    public:
+        uint32_t index;
+        uint32_t generation;
+
+        Entity_Handle ();
+        Entity_Handle (uint32_t new_index, uint32_t new_generation);
+
+        bool operator== (const Entity_Handle& other) const;
+        bool operator!= (const Entity_Handle& other) const;
+};
+
+// Struct-of-arrays storage for every entity in the world
+// Each component lives in its own contiguous array, so a phase that only touches a few components
+// only pulls those components through the cache
+// Live entities are always packed into [0, size()), and each game phase should iterate that range linearly
+class Entity_Store {
+    private:
+        // Indexed by handle index
+        std::vector<uint32_t> index_to_dense;
+        std::vector<uint32_t> generations;
+        std::vector<uint32_t> free_indices;
+
+        // Indexed by dense slot
+        std::vector<uint32_t> dense_to_index;
+
+        std::vector<Entity_Handle> destroy_queue;
+
+        void destroy_dense(uint32_t dense);
+
+    public:
+        static const uint32_t INVALID_DENSE;
+
+        // Components, indexed by dense slot
+        std::vector<uint8_t> type;
+        // Position, in world units
+        std::vector<Fixed> x;
+        std::vector<Fixed> y;
+        // Velocity, in world units per tick
+        std::vector<Fixed> velocity_x;
+        std::vector<Fixed> velocity_y;
+        // Heading, in degrees
+        std::vector<Fixed> heading;
+        std::vector<int32_t> hull;
+        std::vector<uint8_t> ai_state;
+
+        void clear();
+        void reserve(uint32_t count);
+        uint32_t size() const;
+        // One past the highest handle index that has ever been handed out
+        uint32_t get_index_count() const;
+
+        Entity_Handle create(Entity_Type entity_type, const Fixed& new_x, const Fixed& new_y);
+        // Destroys the entity immediately, moving the last entity into its slot
+        // Do not call this while iterating over the store, use queue_destroy instead
+        void destroy(const Entity_Handle& handle);
+        // Queues the entity for destruction once the current phase has finished iterating
+        void queue_destroy(const Entity_Handle& handle);
+        const std::vector<Entity_Handle>& get_destroy_queue() const;
+        void flush_destroy_queue();
+
+        bool is_alive(const Entity_Handle& handle) const;
+        // Returns INVALID_DENSE if the handle is stale
+        uint32_t get_dense(const Entity_Handle& handle) const;
+        // Returns INVALID_DENSE if no living entity uses the passed handle index
+        uint32_t get_dense_from_index(uint32_t index) const;
+        Entity_Handle get_handle(uint32_t dense) const;
+
+        // Saves and restores the entire store, including the free index order, so that a restored store
+        // hands out exactly the same handles as the original would have
+        void write(RakNet::BitStream& bitstream) const;
+        // Returns false if the data is malformed
+        bool read(RakNet::BitStream& bitstream);
+};
+
+#endif
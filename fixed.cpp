@@ -0,0 +1,241 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "fixed.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    // The trigonometric series are evaluated at this higher precision before being rounded back down
+    const int32_t SERIES_BITS = 30;
+    // Pi in 2.30 fixed-point
+    const int64_t PI_SERIES = 3373259426;
+
+    // atan(2^-i) in degrees, with 24 fractional bits, for each CORDIC iteration
+    const int32_t CORDIC_BITS = 24;
+    const int32_t CORDIC_ITERATIONS = 24;
+    const int64_t CORDIC_ANGLES[CORDIC_ITERATIONS] = {
+        754974720, 445687602, 235489088, 119537938, 60000934, 30029717, 15018523, 7509720, 3754917, 1877466, 938734,
+        469367, 234684, 117342, 58671, 29335, 14668, 7334, 3667, 1833, 917, 458, 229, 115
+    };
+
+    // Exact floor of the square root for any value below 2^63
+    uint64_t integer_sqrt (uint64_t value) {
+        // The floating point estimate is only a starting point, and the corrections below make the result exact,
+        // so it does not matter if a platform rounds the estimate differently
+        uint64_t result = (uint64_t) std::sqrt((double) value);
+
+        while (result > 0 && result * result > value) {
+            result--;
+        }
+
+        while ((result + 1) * (result + 1) <= value) {
+            result++;
+        }
+
+        return result;
+    }
+}
+
+int64_t Fixed::multiply_raw (int64_t a, int64_t b) {
+    // The full 128-bit product of the two values as unsigned, built from 32-bit halves
+    const uint64_t MASK = 0xFFFFFFFF;
+    uint64_t unsigned_a = (uint64_t) a;
+    uint64_t unsigned_b = (uint64_t) b;
+    uint64_t low_low = (unsigned_a & MASK) * (unsigned_b & MASK);
+    uint64_t high_low = (unsigned_a >> 32) * (unsigned_b & MASK);
+    uint64_t low_high = (unsigned_a & MASK) * (unsigned_b >> 32);
+    uint64_t high_high = (unsigned_a >> 32) * (unsigned_b >> 32);
+    uint64_t middle = (low_low >> 32) + (high_low & MASK) + (low_high & MASK);
+    uint64_t high = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+    uint64_t low = (middle << 32) | (low_low & MASK);
+
+    // Correcting the high half for the signs turns it into the signed product
+    if (a < 0) {
+        high -= unsigned_b;
+    }
+
+    if (b < 0) {
+        high -= unsigned_a;
+    }
+
+    // An arithmetic shift of the 128-bit product, keeping the low 64 bits
+    return (int64_t) ((high << (64 - FRACTION_BITS)) | (low >> FRACTION_BITS));
+}
+
+int64_t Fixed::divide_raw (int64_t a, int64_t b) {
+    bool negative = (a < 0) != (b < 0);
+    uint64_t dividend = a < 0 ? 0 - (uint64_t) a : (uint64_t) a;
+    uint64_t divisor = b < 0 ? 0 - (uint64_t) b : (uint64_t) b;
+    uint64_t quotient = dividend / divisor;
+    uint64_t remainder = dividend % divisor;
+
+    // Long division for the fractional bits, where the remainder is always below the divisor and so never overflows
+    for (int32_t i = 0; i < FRACTION_BITS; i++) {
+        bool carry = (remainder >> 63) != 0;
+
+        remainder <<= 1;
+        quotient <<= 1;
+
+        if (carry || remainder >= divisor) {
+            remainder -= divisor;
+            quotient |= 1;
+        }
+    }
+
+    return (int64_t) (negative ? 0 - quotient : quotient);
+}
+
+Fixed Fixed::from_double (double value) {
+    double scaled = value * (double) ONE;
+
+    return from_raw((int64_t) (scaled < 0.0 ? scaled - 0.5 : scaled + 0.5));
+}
+
+Fixed Fixed::from_string (const string& value) {
+    size_t i = 0;
+    bool negative = false;
+
+    while (i < value.length() && (value[i] == ' ' || value[i] == '\t')) {
+        i++;
+    }
+
+    if (i < value.length() && (value[i] == '-' || value[i] == '+')) {
+        negative = value[i] == '-';
+        i++;
+    }
+
+    int64_t whole = 0;
+
+    for (; i < value.length() && value[i] >= '0' && value[i] <= '9'; i++) {
+        whole = whole * 10 + (value[i] - '0');
+    }
+
+    int64_t numerator = 0;
+    int64_t denominator = 1;
+
+    if (i < value.length() && value[i] == '.') {
+        i++;
+
+        // Digits beyond the ninth are far below the precision of a Fixed
+        for (; i < value.length() && value[i] >= '0' && value[i] <= '9'; i++) {
+            if (denominator < 1000000000) {
+                numerator = numerator * 10 + (value[i] - '0');
+                denominator *= 10;
+            }
+        }
+    }
+
+    int64_t result = whole * ONE + (numerator * ONE + denominator / 2) / denominator;
+
+    return from_raw(negative ? -result : result);
+}
+
+Fixed Fixed::sqrt (const Fixed& value) {
+    if (value.raw <= 0) {
+        return Fixed();
+    }
+
+    uint64_t raw = (uint64_t) value.raw;
+
+    // Shifting up before the square root keeps all of the fractional bits, as long as there is room to do so
+    if (raw < ((uint64_t) 1 << (63 - FRACTION_BITS))) {
+        return from_raw((int64_t) integer_sqrt(raw << FRACTION_BITS));
+    } else {
+        return from_raw((int64_t) (integer_sqrt(raw) << (FRACTION_BITS / 2)));
+    }
+}
+
+Fixed Fixed::sin (const Fixed& degrees) {
+    const int64_t full_turn = 360 * ONE;
+    const int64_t half_turn = 180 * ONE;
+    const int64_t quarter_turn = 90 * ONE;
+
+    // Reduce to [-180, 180)
+    int64_t angle = ((degrees.raw + half_turn) % full_turn + full_turn) % full_turn - half_turn;
+
+    // Reflect into [-90, 90], where the series converges quickly
+    if (angle > quarter_turn) {
+        angle = half_turn - angle;
+    } else if (angle < -quarter_turn) {
+        angle = -half_turn - angle;
+    }
+
+    // Convert to radians in 2.30
+    // Multiplied rather than shifted, since the angle can be negative
+    int64_t x = angle * ((int64_t) 1 << (SERIES_BITS - FRACTION_BITS)) / 180;
+
+    x = (x * PI_SERIES) >> SERIES_BITS;
+
+    int64_t x_squared = (x * x) >> SERIES_BITS;
+    int64_t term = x;
+    int64_t sum = x;
+
+    for (int64_t k = 2; k <= 10; k += 2) {
+        term = -((term * x_squared) >> SERIES_BITS) / (k * (k + 1));
+        sum += term;
+    }
+
+    return from_raw(sum >> (SERIES_BITS - FRACTION_BITS));
+}
+
+Fixed Fixed::cos (const Fixed& degrees) {
+    return sin(degrees + from_int(90));
+}
+
+Fixed Fixed::atan2 (const Fixed& y, const Fixed& x) {
+    if (x.raw == 0 && y.raw == 0) {
+        return Fixed();
+    }
+
+    int64_t vector_x = x.raw;
+    int64_t vector_y = y.raw;
+    int64_t angle = 0;
+
+    // Rotate into the right half plane, where the iterations converge
+    if (vector_x < 0) {
+        angle = vector_y >= 0 ? (int64_t) 180 << CORDIC_BITS : -((int64_t) 180 << CORDIC_BITS);
+        vector_x = -vector_x;
+        vector_y = -vector_y;
+    }
+
+    // Scale the vector so that its larger component is just below 2^30, which keeps the full precision of the
+    // iterations without any risk of overflow
+    while (std::max(vector_x, vector_y < 0 ? -vector_y : vector_y) >= ((int64_t) 1 << 30)) {
+        vector_x /= 2;
+        vector_y /= 2;
+    }
+
+    while (std::max(vector_x, vector_y < 0 ? -vector_y : vector_y) < ((int64_t) 1 << 29)) {
+        vector_x *= 2;
+        vector_y *= 2;
+    }
+
+    // Each step rotates the vector toward the x axis by a known angle, which accumulates in angle
+    for (int32_t i = 0; i < CORDIC_ITERATIONS; i++) {
+        int64_t next_x = 0;
+
+        if (vector_y > 0) {
+            next_x = vector_x + (vector_y >> i);
+            vector_y -= vector_x >> i;
+            angle += CORDIC_ANGLES[i];
+        } else {
+            next_x = vector_x - (vector_y >> i);
+            vector_y += vector_x >> i;
+            angle -= CORDIC_ANGLES[i];
+        }
+
+        vector_x = next_x;
+    }
+
+    // A vector just below the negative x axis ends up slightly past -180
+    if (angle <= -((int64_t) 180 << CORDIC_BITS)) {
+        angle += (int64_t) 360 << CORDIC_BITS;
+    }
+
+    return from_raw(angle >> (CORDIC_BITS - FRACTION_BITS));
+}
@@ -0,0 +1,194 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef fixed_h
+#define fixed_h
+
+#include <string>
+#include <cstdint>
+
+// Signed 48.16 fixed-point number
+// All simulation state uses this instead of floating point, because integer arithmetic gives bit-identical results
+// on every compiler, CPU and platform, which lockstep networking depends on
+// Doubles should only ever be produced from a Fixed for rendering, and never fed back into the simulation
+// Multiplication and division go through a 128-bit intermediate, so they never overflow partway through
+// A result outside of the range of a Fixed wraps around, the same way on every platform
+class Fixed {
+    private:
+        // Portable versions of the 128-bit operations, for compilers without a 128-bit integer type
+        static int64_t multiply_raw(int64_t a, int64_t b);
+        static int64_t divide_raw(int64_t a, int64_t b);
+
+    public:
+        static const int32_t FRACTION_BITS = 16;
+        static const int64_t ONE = (int64_t) 1 << FRACTION_BITS;
+
+        int64_t raw;
+
+        Fixed ();
+
+        static Fixed from_raw(int64_t new_raw);
+        static Fixed from_int(int64_t value);
+        // Only for loading data, never for converting simulation results
+        static Fixed from_double(double value);
+        // Parses a decimal string without going through floating point
+        static Fixed from_string(const std::string& value);
+
+        double to_double() const;
+        // Rounds toward negative infinity
+        int64_t to_int() const;
+
+        Fixed operator+ (const Fixed& other) const;
+        Fixed operator- (const Fixed& other) const;
+        Fixed operator- () const;
+        Fixed operator* (const Fixed& other) const;
+        // Rounds toward zero
+        // Dividing by zero gives the largest value with the sign of the dividend, or zero for zero
+        Fixed operator/ (const Fixed& other) const;
+        Fixed& operator+= (const Fixed& other);
+        Fixed& operator-= (const Fixed& other);
+        Fixed& operator*= (const Fixed& other);
+        Fixed& operator/= (const Fixed& other);
+
+        bool operator== (const Fixed& other) const;
+        bool operator!= (const Fixed& other) const;
+        bool operator< (const Fixed& other) const;
+        bool operator<= (const Fixed& other) const;
+        bool operator> (const Fixed& other) const;
+        bool operator>= (const Fixed& other) const;
+
+        static Fixed min(const Fixed& a, const Fixed& b);
+        static Fixed max(const Fixed& a, const Fixed& b);
+        static Fixed clamp(const Fixed& value, const Fixed& low, const Fixed& high);
+        static Fixed abs(const Fixed& value);
+        static Fixed sqrt(const Fixed& value);
+        // Angles are in degrees
+        static Fixed sin(const Fixed& degrees);
+        static Fixed cos(const Fixed& degrees);
+        // Returns the angle of the vector from the origin to x, y, in (-180, 180]
+        // Returns 0 for the zero vector
+        static Fixed atan2(const Fixed& y, const Fixed& x);
+};
+
+inline Fixed::Fixed () {
+    raw = 0;
+}
+
+inline Fixed Fixed::from_raw (int64_t new_raw) {
+    Fixed result;
+
+    result.raw = new_raw;
+
+    return result;
+}
+
+inline Fixed Fixed::from_int (int64_t value) {
+    return from_raw(value * ONE);
+}
+
+inline double Fixed::to_double () const {
+    return (double) raw / (double) ONE;
+}
+
+inline int64_t Fixed::to_int () const {
+    return raw >> FRACTION_BITS;
+}
+
+inline Fixed Fixed::operator+ (const Fixed& other) const {
+    return from_raw(raw + other.raw);
+}
+
+inline Fixed Fixed::operator- (const Fixed& other) const {
+    return from_raw(raw - other.raw);
+}
+
+inline Fixed Fixed::operator- () const {
+    return from_raw(-raw);
+}
+
+inline Fixed Fixed::operator* (const Fixed& other) const {
+    #ifdef __SIZEOF_INT128__
+        return from_raw((int64_t) (((__int128) raw * other.raw) >> FRACTION_BITS));
+    #else
+        return from_raw(multiply_raw(raw, other.raw));
+    #endif
+}
+
+inline Fixed Fixed::operator/ (const Fixed& other) const {
+    if (other.raw == 0) {
+        return from_raw(raw > 0 ? INT64_MAX : (raw < 0 ? -INT64_MAX : 0));
+    }
+
+    #ifdef __SIZEOF_INT128__
+        return from_raw((int64_t) (((__int128) raw * ONE) / other.raw));
+    #else
+        return from_raw(divide_raw(raw, other.raw));
+    #endif
+}
+
+inline Fixed& Fixed::operator+= (const Fixed& other) {
+    raw += other.raw;
+
+    return *this;
+}
+
+inline Fixed& Fixed::operator-= (const Fixed& other) {
+    raw -= other.raw;
+
+    return *this;
+}
+
+inline Fixed& Fixed::operator*= (const Fixed& other) {
+    *this = *this * other;
+
+    return *this;
+}
+
+inline Fixed& Fixed::operator/= (const Fixed& other) {
+    *this = *this / other;
+
+    return *this;
+}
+
+inline bool Fixed::operator== (const Fixed& other) const {
+    return raw == other.raw;
+}
+
+inline bool Fixed::operator!= (const Fixed& other) const {
+    return raw != other.raw;
+}
+
+inline bool Fixed::operator< (const Fixed& other) const {
+    return raw < other.raw;
+}
+
+inline bool Fixed::operator<= (const Fixed& other) const {
+    return raw <= other.raw;
+}
+
+inline bool Fixed::operator> (const Fixed& other) const {
+    return raw > other.raw;
+}
+
+inline bool Fixed::operator>= (const Fixed& other) const {
+    return raw >= other.raw;
+}
+
+inline Fixed Fixed::min (const Fixed& a, const Fixed& b) {
+    return a.raw < b.raw ? a : b;
+}
+
+inline Fixed Fixed::max (const Fixed& a, const Fixed& b) {
+    return a.raw > b.raw ? a : b;
+}
+
+inline Fixed Fixed::clamp (const Fixed& value, const Fixed& low, const Fixed& high) {
+    return min(max(value, low), high);
+}
+
+inline Fixed Fixed::abs (const Fixed& value) {
+    return value.raw < 0 ? -value : value;
+}
+
+#endif
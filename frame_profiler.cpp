@@ -0,0 +1,126 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "frame_profiler.h"
+
+using namespace std;
+
+namespace {
+    const char* PHASE_NAMES[PROFILER_PHASE_COUNT] = {
+        "tick", "ai", "movement", "events", "animate", "render", "render_to_textures", "update_background",
+        "render_background"
+    };
+}
+
+const uint32_t Profile_Ring::CAPACITY;
+
+Profile_Ring::Profile_Ring () {
+    clear();
+}
+
+void Profile_Ring::clear () {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+        samples[i].store(0, memory_order_relaxed);
+    }
+
+    write_count.store(0, memory_order_release);
+}
+
+void Profile_Ring::push (uint32_t microseconds) {
+    uint64_t count = write_count.load(memory_order_relaxed);
+
+    samples[count % CAPACITY].store(microseconds, memory_order_relaxed);
+    write_count.store(count + 1, memory_order_release);
+}
+
+uint32_t Profile_Ring::get_recent (uint32_t* destination) const {
+    uint64_t count = write_count.load(memory_order_acquire);
+    uint32_t copied = count < CAPACITY ? (uint32_t) count : CAPACITY;
+    uint64_t first = count - copied;
+
+    for (uint32_t i = 0; i < copied; i++) {
+        destination[i] = samples[(first + i) % CAPACITY].load(memory_order_relaxed);
+    }
+
+    return copied;
+}
+
+uint32_t Profile_Ring::get_average () const {
+    uint32_t recent[CAPACITY];
+    uint32_t count = get_recent(recent);
+    uint64_t total = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        total += recent[i];
+    }
+
+    return (uint32_t) (total / count);
+}
+
+uint32_t Profile_Ring::get_worst () const {
+    uint32_t recent[CAPACITY];
+    uint32_t count = get_recent(recent);
+    uint32_t worst = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (recent[i] > worst) {
+            worst = recent[i];
+        }
+    }
+
+    return worst;
+}
+
+Profile_Ring Frame_Profiler::phases[PROFILER_PHASE_COUNT];
+Profile_Ring Frame_Profiler::frames;
+atomic<uint64_t> Frame_Profiler::frame_accumulator(0);
+
+const char* Frame_Profiler::get_phase_name (uint32_t phase) {
+    return phase < PROFILER_PHASE_COUNT ? PHASE_NAMES[phase] : "";
+}
+
+const Profile_Ring& Frame_Profiler::get_phase (uint32_t phase) {
+    return phases[phase];
+}
+
+const Profile_Ring& Frame_Profiler::get_frames () {
+    return frames;
+}
+
+void Frame_Profiler::add_sample (Profiler_Phase phase, uint32_t microseconds) {
+    phases[phase].push(microseconds);
+    frame_accumulator.fetch_add(microseconds, memory_order_relaxed);
+}
+
+void Frame_Profiler::end_frame () {
+    uint64_t total = frame_accumulator.exchange(0, memory_order_relaxed);
+
+    frames.push(total < 0xFFFFFFFF ? (uint32_t) total : 0xFFFFFFFF);
+}
+
+void Frame_Profiler::clear () {
+    for (uint32_t i = 0; i < PROFILER_PHASE_COUNT; i++) {
+        phases[i].clear();
+    }
+
+    frames.clear();
+    frame_accumulator.store(0, memory_order_relaxed);
+}
+
+Phase_Timer::Phase_Timer (Profiler_Phase new_phase) : trace(Frame_Profiler::get_phase_name(new_phase),
+                                                             new_phase >= PROFILER_PHASE_RENDER ? "render" : "game") {
+    phase = new_phase;
+    start = chrono::steady_clock::now();
+}
+
+Phase_Timer::~Phase_Timer () {
+    uint64_t microseconds = (uint64_t) chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now() - start).count();
+
+    Frame_Profiler::add_sample(phase, microseconds < 0xFFFFFFFF ? (uint32_t) microseconds : 0xFFFFFFFF);
+}
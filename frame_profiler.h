@@ -0,0 +1,81 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef frame_profiler_h
+#define frame_profiler_h
+
+#include "trace_profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+enum Profiler_Phase {
+    PROFILER_PHASE_TICK,
+    PROFILER_PHASE_AI,
+    PROFILER_PHASE_MOVEMENT,
+    PROFILER_PHASE_EVENTS,
+    PROFILER_PHASE_ANIMATE,
+    PROFILER_PHASE_RENDER,
+    PROFILER_PHASE_RENDER_TO_TEXTURES,
+    PROFILER_PHASE_UPDATE_BACKGROUND,
+    PROFILER_PHASE_RENDER_BACKGROUND,
+    PROFILER_PHASE_COUNT
+};
+
+// Fixed-size ring of the most recent timing samples, in microseconds
+// Only one thread may push to a given ring, but any thread may read from it at any time without locking
+// A reader racing the writer may see one sample from the next lap, which is harmless for display
+class Profile_Ring {
+    public:
+        static const uint32_t CAPACITY = 128;
+
+    private:
+        std::atomic<uint32_t> samples[CAPACITY];
+        std::atomic<uint64_t> write_count;
+
+    public:
+        Profile_Ring ();
+
+        void clear();
+        void push(uint32_t microseconds);
+        // Copies up to CAPACITY of the most recent samples into destination, oldest first
+        // Returns the number of samples copied
+        uint32_t get_recent(uint32_t* destination) const;
+        uint32_t get_average() const;
+        uint32_t get_worst() const;
+};
+
+// Keeps the recent duration of each Game_World hook, and of each frame as a whole
+class Frame_Profiler {
+    private:
+        static Profile_Ring phases[PROFILER_PHASE_COUNT];
+        static Profile_Ring frames;
+        // Time spent in hooks since the last end_frame
+        static std::atomic<uint64_t> frame_accumulator;
+
+    public:
+        static const char* get_phase_name(uint32_t phase);
+        static const Profile_Ring& get_phase(uint32_t phase);
+        static const Profile_Ring& get_frames();
+
+        static void add_sample(Profiler_Phase phase, uint32_t microseconds);
+        // Closes the current frame, recording the total time its hooks took
+        static void end_frame();
+        static void clear();
+};
+
+// Times the enclosing scope and records it as a sample for the passed phase, and as a trace event
+class Phase_Timer {
+    private:
+        Profiler_Phase phase;
+        std::chrono::steady_clock::time_point start;
+        Trace_Scope trace;
+
+    public:
+        Phase_Timer (Profiler_Phase new_phase);
+        ~Phase_Timer ();
+};
+
+#endif
@@ -3,45 +3,593 @@
 /* See the file docs/LICENSE.txt for the full license text. */
 
 #include "game.h"
+#include "game_constants.h"
+#include "job_system.h"
+#include "network_game.h"
+#include "replay.h"
+#include "command_ids.h"
+#include "trace_profiler.h"
+#include "chunk_texture_cache.h"
+#include "background.h"
 
 #include <render.h>
 #include <game_window.h>
 #include <sound_manager.h>
+#include <game_manager.h>
+
+#include <algorithm>
 
 using namespace std;
 
+// The number of entities handed to a job at once
+// Phases are split by this alone, never by the thread count, so that the simulation is identical on any machine
+const uint32_t ENTITY_JOB_GRAIN_SIZE = 2048;
+
+const uint32_t Game::MAX_PLAYERS = 1024;
+
 ///vector<Example_Object> Game::example_objects;
+vector<uint32_t> Game::query_results;
+Entity_Store Game::entities;
+Spatial_Grid Game::spatial_grid;
+uint64_t Game::current_tick = 0;
+uint64_t Game::state_hash = 0;
+State_Hash_History Game::state_hashes;
+Simulation_Rng Game::rng;
+uint64_t Game::world_seed = 0;
+World_Map Game::world_map;
+Navigation Game::navigation;
+Ai_Scheduler Game::ai_scheduler;
+Sprite_Batch Game::sprite_batch;
+Particle_System Game::particles;
+vector<Command_State_Set> Game::player_command_states;
+
+Entity_Handle Game::create_entity (Entity_Type type, const Fixed& x, const Fixed& y) {
+    Entity_Handle handle = entities.create(type, x, y);
+
+    spatial_grid.insert(handle.index, x, y);
+
+    return handle;
+}
+
+void Game::destroy_queued_entities () {
+    const vector<Entity_Handle>& destroy_queue = entities.get_destroy_queue();
+
+    for (size_t i = 0; i < destroy_queue.size(); i++) {
+        if (entities.is_alive(destroy_queue[i])) {
+            spatial_grid.remove(destroy_queue[i].index);
+            navigation.remove(destroy_queue[i]);
+        }
+    }
+
+    entities.flush_destroy_queue();
+}
+
+void Game::handle_player_command (uint32_t player, const Player_Command& command) {
+    // Replays keep the command's name, so they survive commands being added to or removed from the data
+    Replay_Recorder::record_command(player, Command_Ids::get_name(command.id), command.arguments);
+
+    // Commands missing from the data have this ID too
+    if (command.id == Command_Ids::INVALID) {
+        return;
+    }
+
+    if (command.id == Command_Ids::VIEW) {
+        const vector<Fixed>& arguments = command.arguments;
+
+        if (player < MAX_PLAYERS && arguments.size() == 4 && arguments[2] >= Fixed() && arguments[3] >= Fixed()) {
+            ai_scheduler.set_view(player, arguments[0], arguments[1], arguments[2], arguments[3]);
+        }
+    } else if (command.id == Command_Ids::LEAVE) {
+        ai_scheduler.remove_view(player);
+    }
+
+    // Example player command
+    /**if(command.id==Command_Ids::SOME_COMMAND){
+        ///Change the simulation here
+       }*/
+}
+
+void Game::handle_player_command_states (uint32_t player, const Command_State_Set& states) {
+    if (player >= MAX_PLAYERS) {
+        return;
+    }
+
+    if (player >= player_command_states.size()) {
+        player_command_states.resize(player + 1);
+    }
+
+    if (states != player_command_states[player]) {
+        Replay_Recorder::record_command_states(player, states);
+
+        player_command_states[player] = states;
+    }
+}
+
+bool Game::get_player_command_state (uint32_t player, uint32_t command) {
+    return player < player_command_states.size() && player_command_states[player].get(command);
+}
+
+void Game::write_keyframe (RakNet::BitStream& bitstream) {
+    Trace_Scope trace("write_keyframe", "game");
+
+    bitstream.WriteCompressed(current_tick);
+    bitstream.Write(state_hash);
+    bitstream.Write(rng.get_state());
+    bitstream.Write(rng.get_increment());
+    bitstream.Write(world_seed);
+
+    entities.write(bitstream);
+    world_map.write(bitstream);
+    navigation.write(bitstream);
+    ai_scheduler.write(bitstream);
+
+    uint32_t player_count = (uint32_t) player_command_states.size();
+
+    bitstream.WriteCompressed(player_count);
+
+    for (uint32_t i = 0; i < player_count; i++) {
+        player_command_states[i].write_names(bitstream);
+    }
+}
+
+bool Game::read_keyframe (RakNet::BitStream& bitstream) {
+    generate_world();
+
+    uint64_t rng_state = 0;
+    uint64_t rng_increment = 0;
+    uint64_t keyframe_world_seed = 0;
+
+    if (!bitstream.ReadCompressed(current_tick) || !bitstream.Read(state_hash) || !bitstream.Read(rng_state) ||
+        !bitstream.Read(rng_increment) || !bitstream.Read(keyframe_world_seed) || !entities.read(bitstream)) {
+        clear_world();
+
+        return false;
+    }
+
+    rng.set_state(rng_state, rng_increment);
+
+    if (keyframe_world_seed != world_seed) {
+        set_world_seed(keyframe_world_seed);
+    }
+
+    uint32_t player_count = 0;
+
+    // The changed tiles and the navigation cells depend on the world, so they are only read once the world is set up
+    if (!world_map.read(bitstream) || !navigation.read(world_map, bitstream) || !ai_scheduler.read(bitstream) ||
+        !bitstream.ReadCompressed(player_count) || player_count > MAX_PLAYERS) {
+        clear_world();
+
+        return false;
+    }
+
+    player_command_states.resize(player_count);
+
+    for (uint32_t i = 0; i < player_count; i++) {
+        if (!player_command_states[i].read_names(bitstream)) {
+            clear_world();
+
+            return false;
+        }
+    }
+
+    // The grid is derived entirely from the entities, so it is rebuilt rather than saved
+    for (uint32_t i = 0; i < entities.size(); i++) {
+        spatial_grid.insert(entities.get_handle(i).index, entities.x[i], entities.y[i]);
+    }
+
+    state_hashes.add(current_tick, state_hash);
+
+    return true;
+}
+
+void Game::handle_collisions () {
+    Trace_Scope trace("handle_collisions", "game");
+
+    uint32_t count = entities.size();
+    Fixed ship_radius = Fixed::from_double(Game_Constants::SHIP_RADIUS);
+    Fixed ship_diameter = ship_radius + ship_radius;
+    Fixed hit_distance = ship_radius + Fixed::from_double(Game_Constants::CANNONBALL_RADIUS);
+
+    for (uint32_t i = 0; i < count; i++) {
+        query_results.clear();
+
+        if (entities.type[i] == ENTITY_TYPE_CANNONBALL) {
+            spatial_grid.query_radius(entities.x[i], entities.y[i], hit_distance, query_results);
+            // Sorting makes the outcome independent of the order entries were linked into their cells,
+            // which a world restored from a keyframe does not reproduce
+            sort(query_results.begin(), query_results.end());
+
+            for (size_t n = 0; n < query_results.size(); n++) {
+                uint32_t other = entities.get_dense_from_index(query_results[n]);
+
+                if (other != Entity_Store::INVALID_DENSE && entities.type[other] == ENTITY_TYPE_SHIP) {
+                    entities.hull[other] -= Game_Constants::CANNONBALL_DAMAGE;
+
+                    particles.spawn(EFFECT_TYPE_EXPLOSION, entities.x[i].to_double(), entities.y[i].to_double());
+
+                    if (entities.hull[other] <= 0) {
+                        entities.queue_destroy(entities.get_handle(other));
+
+                        particles.spawn(EFFECT_TYPE_SPLASH, entities.x[other].to_double(),
+                                        entities.y[other].to_double());
+                        particles.spawn(EFFECT_TYPE_SMOKE, entities.x[other].to_double(),
+                                        entities.y[other].to_double());
+                    }
+
+                    entities.queue_destroy(entities.get_handle(i));
+
+                    break;
+                }
+            }
+        } else if (entities.type[i] == ENTITY_TYPE_SHIP) {
+            uint32_t index = entities.get_handle(i).index;
+
+            spatial_grid.query_radius(entities.x[i], entities.y[i], ship_diameter, query_results);
+            sort(query_results.begin(), query_results.end());
+
+            for (size_t n = 0; n < query_results.size(); n++) {
+                // Each overlapping pair is only resolved once, by its lower index
+                if (query_results[n] > index) {
+                    uint32_t other = entities.get_dense_from_index(query_results[n]);
+
+                    if (other != Entity_Store::INVALID_DENSE && entities.type[other] == ENTITY_TYPE_SHIP) {
+                        Fixed distance_x = entities.x[other] - entities.x[i];
+                        Fixed distance_y = entities.y[other] - entities.y[i];
+                        Fixed distance = Fixed::sqrt(distance_x * distance_x + distance_y * distance_y);
+
+                        if (distance > Fixed()) {
+                            // Push both ships apart by half of their overlap
+                            Fixed push = (ship_diameter - distance) / (distance + distance);
+
+                            entities.x[i] -= distance_x * push;
+                            entities.y[i] -= distance_y * push;
+                            entities.x[other] += distance_x * push;
+                            entities.y[other] += distance_y * push;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Game::update_state_hash () {
+    Trace_Scope trace("update_state_hash", "game");
+
+    uint32_t count = entities.size();
+    uint64_t hash = State_Hash_History::mix(state_hash, current_tick);
+
+    hash = State_Hash_History::mix(hash, count);
+    hash = State_Hash_History::mix(hash, rng.get_state());
+
+    for (uint32_t i = 0; i < count; i++) {
+        hash = State_Hash_History::mix(hash, (uint64_t) entities.x[i].raw);
+        hash = State_Hash_History::mix(hash, (uint64_t) entities.y[i].raw);
+        hash = State_Hash_History::mix(hash, (uint64_t) entities.heading[i].raw);
+        hash = State_Hash_History::mix(hash, ((uint64_t) (uint32_t) entities.hull[i] << 16) |
+                                       ((uint64_t) entities.ai_state[i] << 8) | entities.type[i]);
+    }
+
+    state_hash = hash;
+    state_hashes.add(current_tick, state_hash);
+}
+
+void Game::set_world_seed (uint64_t seed) {
+    world_seed = seed;
+
+    world_map.setup(world_seed, Game_Constants::WORLD_WIDTH, Game_Constants::WORLD_HEIGHT);
+    navigation.setup(world_map);
+}
 
 void Game::clear_world () {
     ///example_objects.clear();
+    entities.clear();
+    spatial_grid.clear();
+    world_map.clear();
+    navigation.clear();
+    particles.clear();
+    ai_scheduler.clear();
+    player_command_states.clear();
+
+    current_tick = 0;
+    state_hash = 0;
+    state_hashes.clear();
+    Network_Game::reset_desync_detection();
+    Network_Game::reset_replication();
+    Network_Game::reset_commands();
 }
 
 void Game::generate_world () {
     clear_world();
+
+    rng.seed(0);
+
+    spatial_grid.setup(Fixed::from_double(Game_Constants::WORLD_WIDTH), Fixed::from_double(
+                           Game_Constants::WORLD_HEIGHT), Fixed::from_double(Game_Constants::SPATIAL_GRID_CELL_SIZE));
+
+    // Only the chunks near the ships and the camera are generated, as they are needed
+    set_world_seed(world_seed);
+}
+
+void Game::tick () {
+    current_tick++;
+
+    // Which chunks are generated never affects the simulation, so this is free to skip ticks
+    if (Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL == 0 ||
+        current_tick % Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL == 0) {
+        uint32_t count = entities.size();
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (entities.type[i] == ENTITY_TYPE_SHIP) {
+                world_map.mark_point(entities.x[i].to_double(), entities.y[i].to_double());
+            }
+        }
+
+        world_map.request_marked(Game_Constants::WORLD_CHUNK_MARGIN);
+    }
+
+    world_map.update();
+}
+
+void Game::ai () {
+    Fixed ship_speed = Fixed::from_double(Game_Constants::SHIP_SPEED);
+
+    // Route planning shares its caches, so it runs here rather than in the jobs
+    navigation.update(world_map, entities);
+    ai_scheduler.update(current_tick, entities);
+
+    Job_System::parallel_for(entities.size(), ENTITY_JOB_GRAIN_SIZE, [ship_speed] (uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            if (entities.type[i] == ENTITY_TYPE_SHIP && ai_scheduler.is_scheduled(i)) {
+                Fixed target_x;
+                Fixed target_y;
+                Navigation_State navigation_state = navigation.get_target(entities.get_handle(i), target_x, target_y);
+
+                if (navigation_state == NAVIGATION_STATE_FOLLOWING) {
+                    entities.heading[i] = Fixed::atan2(target_y - entities.y[i], target_x - entities.x[i]);
+                    entities.velocity_x[i] = Fixed::cos(entities.heading[i]) * ship_speed;
+                    entities.velocity_y[i] = Fixed::sin(entities.heading[i]) * ship_speed;
+                } else if (navigation_state != NAVIGATION_STATE_NONE ||
+                           entities.ai_state[i] == ENTITY_AI_STATE_IDLE) {
+                    // Ships waiting on a route, or with nowhere left to go, hold still
+                    entities.velocity_x[i] = Fixed();
+                    entities.velocity_y[i] = Fixed();
+                } else {
+                    entities.velocity_x[i] = Fixed::cos(entities.heading[i]) * ship_speed;
+                    entities.velocity_y[i] = Fixed::sin(entities.heading[i]) * ship_speed;
+                }
+            }
+        }
+    });
 }
 
-void Game::tick () {}
+void Game::movement () {
+    uint32_t count = entities.size();
 
-void Game::ai () {}
+    Job_System::parallel_for(count, ENTITY_JOB_GRAIN_SIZE, [] (uint32_t begin, uint32_t end) {
+        Fixed* x = &entities.x[0];
+        Fixed* y = &entities.y[0];
+        const Fixed* velocity_x = &entities.velocity_x[0];
+        const Fixed* velocity_y = &entities.velocity_y[0];
 
-void Game::movement () {}
+        for (uint32_t i = begin; i < end; i++) {
+            x[i] += velocity_x[i];
+            y[i] += velocity_y[i];
+        }
+    });
+
+    // Everything below touches shared state, and stays on this thread
+    Fixed world_width = spatial_grid.get_world_width();
+    Fixed world_height = spatial_grid.get_world_height();
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (entities.x[i] < Fixed() || entities.y[i] < Fixed() || entities.x[i] > world_width ||
+            entities.y[i] > world_height) {
+            if (entities.type[i] == ENTITY_TYPE_SHIP) {
+                // Ships stay within the world
+                entities.x[i] = Fixed::clamp(entities.x[i], Fixed(), world_width);
+                entities.y[i] = Fixed::clamp(entities.y[i], Fixed(), world_height);
+            } else {
+                entities.queue_destroy(entities.get_handle(i));
+            }
+        }
+
+        spatial_grid.update(entities.get_handle(i).index, entities.x[i], entities.y[i]);
+    }
+
+    handle_collisions();
+
+    destroy_queued_entities();
+}
 
 void Game::events () {
     ///Sound_Manager::set_listener(example_player.circle.x,example_player.circle.y,Game_Manager::camera_zoom);
+
+    // Keyframes rebuild the flow fields from the tiles, so no tile change may be left for the next tick to see
+    navigation.invalidate_changed_regions(world_map);
+
+    // This must stay the last change to simulation state in a tick
+    update_state_hash();
+
+    Replay_Recorder::end_tick();
 }
 
-void Game::animate () {}
+void Game::query_visible_entities (double margin) {
+    double zoom = Game_Manager::camera_zoom;
 
-void Game::render () {}
+    query_results.clear();
+
+    // The camera never feeds back into the simulation, so it is free to use floating point
+    spatial_grid.query_rect(Fixed::from_double(Game_Manager::camera.x / zoom - margin),
+                            Fixed::from_double(Game_Manager::camera.y / zoom - margin),
+                            Fixed::from_double(Game_Manager::camera.w / zoom + margin * 2.0),
+                            Fixed::from_double(Game_Manager::camera.h / zoom + margin * 2.0), query_results);
+}
+
+void Game::animate () {
+    uint32_t wake_interval = max(Game_Constants::PARTICLE_WAKE_INTERVAL, (uint32_t) 1);
+    double ship_radius = Game_Constants::SHIP_RADIUS;
+
+    // Only ships near enough to the camera for their wakes to be seen leave them
+    query_visible_entities(ship_radius * 4.0);
+
+    for (size_t n = 0; n < query_results.size(); n++) {
+        uint32_t i = entities.get_dense_from_index(query_results[n]);
+
+        // Wakes are staggered by handle index, so that the ships do not all leave one on the same tick
+        if (i != Entity_Store::INVALID_DENSE && entities.type[i] == ENTITY_TYPE_SHIP &&
+            (entities.velocity_x[i] != Fixed() || entities.velocity_y[i] != Fixed()) &&
+            (query_results[n] + current_tick) % wake_interval == 0) {
+            // The wake starts at the stern, and trails away behind the ship
+            double stern_x = entities.x[i].to_double() - Fixed::cos(entities.heading[i]).to_double() * ship_radius;
+            double stern_y = entities.y[i].to_double() - Fixed::sin(entities.heading[i]).to_double() * ship_radius;
+
+            particles.spawn(EFFECT_TYPE_WAKE, stern_x, stern_y, entities.heading[i].to_double() + 180.0);
+        }
+    }
+
+    particles.update();
+}
+
+void Game::render () {
+    double ship_radius = Game_Constants::SHIP_RADIUS;
+
+    // Only entities within the camera, plus a margin for their size, are considered for rendering
+    query_visible_entities(ship_radius);
+
+    sprite_batch.begin();
+
+    for (size_t n = 0; n < query_results.size(); n++) {
+        uint32_t i = entities.get_dense_from_index(query_results[n]);
+
+        if (i != Entity_Store::INVALID_DENSE) {
+            double x = entities.x[i].to_double();
+            double y = entities.y[i].to_double();
+
+            if (entities.type[i] == ENTITY_TYPE_SHIP) {
+                sprite_batch.add_rectangle(SPRITE_LAYER_SHIPS, x - ship_radius, y - ship_radius, ship_radius * 2.0,
+                                           ship_radius * 2.0, "white");
+            } else {
+                double radius = Game_Constants::CANNONBALL_RADIUS;
+
+                sprite_batch.add_rectangle(SPRITE_LAYER_PROJECTILES, x - radius, y - radius, radius * 2.0,
+                                           radius * 2.0, "red");
+            }
+        }
+    }
+
+    particles.render(sprite_batch);
+
+    sprite_batch.render();
+}
+
+bool Game::get_visible_chunks (uint32_t& first_chunk_x, uint32_t& first_chunk_y, uint32_t& last_chunk_x,
+                               uint32_t& last_chunk_y) {
+    if (world_map.get_chunks_x() == 0 || world_map.get_chunks_y() == 0) {
+        return false;
+    }
+
+    double zoom = Game_Manager::camera_zoom;
+    double view_x = Game_Manager::camera.x / zoom;
+    double view_y = Game_Manager::camera.y / zoom;
+    double view_w = Game_Manager::camera.w / zoom;
+    double view_h = Game_Manager::camera.h / zoom;
+    double chunk_size = world_map.get_chunk_size();
+
+    if (view_x + view_w < 0.0 || view_y + view_h < 0.0 || view_x >= chunk_size * world_map.get_chunks_x() ||
+        view_y >= chunk_size * world_map.get_chunks_y()) {
+        return false;
+    }
+
+    first_chunk_x = (uint32_t) max(view_x / chunk_size, 0.0);
+    first_chunk_y = (uint32_t) max(view_y / chunk_size, 0.0);
+    last_chunk_x = (uint32_t) max(min((view_x + view_w) / chunk_size, world_map.get_chunks_x() - 1.0), 0.0);
+    last_chunk_y = (uint32_t) max(min((view_y + view_h) / chunk_size, world_map.get_chunks_y() - 1.0), 0.0);
+
+    return true;
+}
 
 void Game::render_to_textures () {
-    /**Rtt_Manager::set_render_target("example");
-       ///Render something here
-       Rtt_Manager::reset_render_target();*/
+    if (!Game_Manager::in_progress) {
+        return;
+    }
+
+    Background::render_to_textures();
+    Chunk_Texture_Cache::start_frame();
+
+    uint32_t first_chunk_x = 0;
+    uint32_t first_chunk_y = 0;
+    uint32_t last_chunk_x = 0;
+    uint32_t last_chunk_y = 0;
+
+    if (!get_visible_chunks(first_chunk_x, first_chunk_y, last_chunk_x, last_chunk_y)) {
+        return;
+    }
+
+    for (uint32_t chunk_y = first_chunk_y; chunk_y <= last_chunk_y; chunk_y++) {
+        for (uint32_t chunk_x = first_chunk_x; chunk_x <= last_chunk_x; chunk_x++) {
+            const World_Chunk* chunk = world_map.find_chunk(chunk_x, chunk_y);
+
+            if (chunk != 0) {
+                Chunk_Texture_Cache::update(world_map, *chunk);
+            }
+        }
+    }
 }
 
-void Game::update_background () {}
+void Game::update_background () {
+    if (Game_Manager::in_progress) {
+        Background::update();
+    }
+}
 
 void Game::render_background () {
-    Render::render_rectangle(0.0, 0.0, Game_Window::width(), Game_Window::height(), 1.0, "ui_black");
+    if (!Game_Manager::in_progress) {
+        Render::render_rectangle(0.0, 0.0, Game_Window::width(), Game_Window::height(), 1.0, "ui_black");
+
+        return;
+    }
+
+    double zoom = Game_Manager::camera_zoom;
+    double margin = Game_Constants::WORLD_CHUNK_MARGIN;
+
+    world_map.request_area(Game_Manager::camera.x / zoom - margin, Game_Manager::camera.y / zoom - margin,
+                           Game_Manager::camera.w / zoom + margin * 2.0, Game_Manager::camera.h / zoom + margin * 2.0);
+
+    // Deep water is the most common tile by far, so it is drawn once beneath everything else
+    Render::render_rectangle(0.0, 0.0, Game_Window::width(), Game_Window::height(), 1.0,
+                             Chunk_Texture_Cache::TILE_COLORS[WORLD_TILE_DEEP_WATER]);
+
+    uint32_t first_chunk_x = 0;
+    uint32_t first_chunk_y = 0;
+    uint32_t last_chunk_x = 0;
+    uint32_t last_chunk_y = 0;
+
+    if (get_visible_chunks(first_chunk_x, first_chunk_y, last_chunk_x, last_chunk_y)) {
+        double chunk_size = world_map.get_chunk_size();
+
+        for (uint32_t chunk_y = first_chunk_y; chunk_y <= last_chunk_y; chunk_y++) {
+            for (uint32_t chunk_x = first_chunk_x; chunk_x <= last_chunk_x; chunk_x++) {
+                const World_Chunk* chunk = world_map.find_chunk(chunk_x, chunk_y);
+
+                // Chunks still being generated show as deep water until they are ready
+                if (chunk == 0) {
+                    continue;
+                }
+
+                double x = chunk_x * chunk_size * zoom - Game_Manager::camera.x;
+                double y = chunk_y * chunk_size * zoom - Game_Manager::camera.y;
+                Rtt_Data* texture = Chunk_Texture_Cache::get_texture(world_map, *chunk);
+
+                // A chunk whose texture is not ready yet is drawn tile by tile for now
+                if (texture != 0) {
+                    Render::render_rtt(x, y, texture, 1.0, zoom, zoom);
+                } else {
+                    Chunk_Texture_Cache::render_tiles(world_map, *chunk, x, y, zoom);
+                }
+            }
+        }
+    }
+
+    Background::render();
 }
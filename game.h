@@ -6,12 +6,86 @@
 #define game_h
 
 ///#include "example_object.h"
+#include "entity_store.h"
+#include "spatial_grid.h"
+#include "state_hash.h"
+#include "simulation_rng.h"
+#include "world_map.h"
+#include "sprite_batch.h"
+#include "navigation.h"
+#include "ai_scheduler.h"
+#include "particle_system.h"
+#include "command_ids.h"
 
 #include <vector>
+#include <string>
+
+#include "raknet/Source/BitStream.h"
 
 class Game {
+    private:
+        // Reused by spatial queries, so that queries during a tick do not allocate
+        static std::vector<uint32_t> query_results;
+
+        static void handle_collisions();
+        static void update_state_hash();
+        // Fills query_results with the handle indices of the entities within the camera, plus margin on each side
+        static void query_visible_entities(double margin);
+        // Finds the range of chunks overlapping the camera
+        // Returns false if there are none
+        static bool get_visible_chunks(uint32_t& first_chunk_x, uint32_t& first_chunk_y, uint32_t& last_chunk_x,
+                                       uint32_t& last_chunk_y);
+
     public:
+        // The most players whose held commands are tracked, which also guards against reading a corrupt player index as
+        // a huge allocation
+        static const uint32_t MAX_PLAYERS;
+
         ///static std::vector<Example_Object> example_objects;
+        static Entity_Store entities;
+        static Spatial_Grid spatial_grid;
+
+        // The tick currently being simulated, starting from 1
+        static uint64_t current_tick;
+        // Hash of the simulation state at the end of current_tick, chained with every tick before it
+        static uint64_t state_hash;
+        static State_Hash_History state_hashes;
+        // Every random decision that affects the simulation must come from here
+        static Simulation_Rng rng;
+        // The world's terrain is generated from this alone, so every peer must use the same seed
+        static uint64_t world_seed;
+        static World_Map world_map;
+        // Ships are steered around land through here
+        static Navigation navigation;
+        // Decides which ships think on each tick
+        static Ai_Scheduler ai_scheduler;
+        static Sprite_Batch sprite_batch;
+        // Purely visual, so effects can be spawned from the simulation without affecting it
+        static Particle_System particles;
+        // Indexed by player, the commands each player is holding down
+        static std::vector<Command_State_Set> player_command_states;
+
+        // Entities should be created and destroyed through these, so that the spatial grid stays in sync
+        static Entity_Handle create_entity(Entity_Type type, const Fixed& x, const Fixed& y);
+        static void destroy_queued_entities();
+
+        // Every command that changes the simulation must enter it through here, so that it can be recorded
+        // player is the index of the client the command came from
+        // command is a command ID
+        static void handle_player_command(uint32_t player, const Player_Command& command);
+        // Every player's held command states must enter the simulation through here once per tick, for the same
+        // reason
+        // Only changes are recorded, since held commands are usually held for many ticks
+        static void handle_player_command_states(uint32_t player, const Command_State_Set& states);
+        static bool get_player_command_state(uint32_t player, uint32_t command);
+
+        // A keyframe holds the entire simulation state at the end of current_tick
+        static void write_keyframe(RakNet::BitStream& bitstream);
+        // Returns false if the data is malformed, in which case the world is left cleared
+        static bool read_keyframe(RakNet::BitStream& bitstream);
+
+        // Starts a new world map from the passed seed
+        static void set_world_seed(uint64_t seed);
 
         static void clear_world();
         static void generate_world();
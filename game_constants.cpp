@@ -7,12 +7,621 @@
 #include <game_constants_loader.h>
 #include <engine_strings.h>
 #include <engine_data.h>
+#include <log.h>
 
 using namespace std;
 
 /// BEGIN SCRIPT-GENERATED CONSTANT INITIALIZATIONS
+#ifdef GAME_CONSTANTS_BAKED
+    constexpr double Game_Constants::WORLD_WIDTH;
+    constexpr double Game_Constants::WORLD_HEIGHT;
+    constexpr double Game_Constants::SPATIAL_GRID_CELL_SIZE;
+    constexpr double Game_Constants::SHIP_RADIUS;
+    constexpr double Game_Constants::SHIP_SPEED;
+    constexpr double Game_Constants::CANNONBALL_RADIUS;
+    constexpr int32_t Game_Constants::CANNONBALL_DAMAGE;
+    constexpr double Game_Constants::INTEREST_ENTER_MARGIN;
+    constexpr double Game_Constants::INTEREST_EXIT_MARGIN;
+    constexpr uint64_t Game_Constants::WORLD_SEED;
+    constexpr double Game_Constants::WORLD_TILE_SIZE;
+    constexpr uint32_t Game_Constants::WORLD_CHUNK_TILES;
+    constexpr double Game_Constants::WORLD_CHUNK_MARGIN;
+    constexpr uint32_t Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL;
+    constexpr uint32_t Game_Constants::WORLD_CHUNK_IDLE_UPDATES;
+    constexpr uint32_t Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT;
+    constexpr uint32_t Game_Constants::WORLD_CHUNKS_PER_BATCH;
+    constexpr uint32_t Game_Constants::WORLD_CHUNK_TEXTURE_COUNT;
+    constexpr uint32_t Game_Constants::WORLD_CHUNK_RENDERS_PER_FRAME;
+    constexpr uint32_t Game_Constants::BACKGROUND_LAYER_TEXTURE_COUNT;
+    constexpr double Game_Constants::BACKGROUND_CACHE_MARGIN;
+    constexpr uint32_t Game_Constants::TEXT_CACHE_TEXTURE_COUNT;
+    constexpr double Game_Constants::TEXT_CACHE_TEXTURE_WIDTH;
+    constexpr double Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT;
+    constexpr uint32_t Game_Constants::DEV_INFO_REFRESH_INTERVAL;
+    constexpr uint32_t Game_Constants::NAVIGATION_CELL_TILES;
+    constexpr uint32_t Game_Constants::NAVIGATION_WORK_PER_TICK;
+    constexpr uint32_t Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT;
+    constexpr double Game_Constants::NAVIGATION_WAYPOINT_RADIUS;
+    constexpr double Game_Constants::AI_LOD_FULL_DISTANCE;
+    constexpr double Game_Constants::AI_LOD_REDUCED_DISTANCE;
+    constexpr uint32_t Game_Constants::AI_LOD_REDUCED_INTERVAL;
+    constexpr uint32_t Game_Constants::AI_LOD_COARSE_INTERVAL;
+    constexpr uint32_t Game_Constants::AI_WORK_PER_TICK;
+    constexpr uint32_t Game_Constants::EFFECT_CAPACITY;
+    constexpr uint32_t Game_Constants::PARTICLE_CAPACITY;
+    constexpr uint32_t Game_Constants::PARTICLE_WAKE_INTERVAL;
+#else
+    double Game_Constants::WORLD_WIDTH = 0.0;
+    double Game_Constants::WORLD_HEIGHT = 0.0;
+    double Game_Constants::SPATIAL_GRID_CELL_SIZE = 0.0;
+    double Game_Constants::SHIP_RADIUS = 0.0;
+    double Game_Constants::SHIP_SPEED = 0.0;
+    double Game_Constants::CANNONBALL_RADIUS = 0.0;
+    int32_t Game_Constants::CANNONBALL_DAMAGE = 0;
+    double Game_Constants::INTEREST_ENTER_MARGIN = 0.0;
+    double Game_Constants::INTEREST_EXIT_MARGIN = 0.0;
+    uint64_t Game_Constants::WORLD_SEED = 0;
+    double Game_Constants::WORLD_TILE_SIZE = 0.0;
+    uint32_t Game_Constants::WORLD_CHUNK_TILES = 0;
+    double Game_Constants::WORLD_CHUNK_MARGIN = 0.0;
+    uint32_t Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL = 0;
+    uint32_t Game_Constants::WORLD_CHUNK_IDLE_UPDATES = 0;
+    uint32_t Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT = 0;
+    uint32_t Game_Constants::WORLD_CHUNKS_PER_BATCH = 0;
+    uint32_t Game_Constants::WORLD_CHUNK_TEXTURE_COUNT = 0;
+    uint32_t Game_Constants::WORLD_CHUNK_RENDERS_PER_FRAME = 0;
+    uint32_t Game_Constants::BACKGROUND_LAYER_TEXTURE_COUNT = 0;
+    double Game_Constants::BACKGROUND_CACHE_MARGIN = 0.0;
+    uint32_t Game_Constants::TEXT_CACHE_TEXTURE_COUNT = 0;
+    double Game_Constants::TEXT_CACHE_TEXTURE_WIDTH = 0.0;
+    double Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT = 0.0;
+    uint32_t Game_Constants::DEV_INFO_REFRESH_INTERVAL = 0;
+    uint32_t Game_Constants::NAVIGATION_CELL_TILES = 0;
+    uint32_t Game_Constants::NAVIGATION_WORK_PER_TICK = 0;
+    uint32_t Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT = 0;
+    double Game_Constants::NAVIGATION_WAYPOINT_RADIUS = 0.0;
+    double Game_Constants::AI_LOD_FULL_DISTANCE = 0.0;
+    double Game_Constants::AI_LOD_REDUCED_DISTANCE = 0.0;
+    uint32_t Game_Constants::AI_LOD_REDUCED_INTERVAL = 0;
+    uint32_t Game_Constants::AI_LOD_COARSE_INTERVAL = 0;
+    uint32_t Game_Constants::AI_WORK_PER_TICK = 0;
+    uint32_t Game_Constants::EFFECT_CAPACITY = 0;
+    uint32_t Game_Constants::PARTICLE_CAPACITY = 0;
+    uint32_t Game_Constants::PARTICLE_WAKE_INTERVAL = 0;
+#endif
 /// END SCRIPT-GENERATED CONSTANT INITIALIZATIONS
 
+namespace {
+    class Game_Constant_Setter {
+        public:
+            const char* name;
+            void (* set)(const string& value);
+    };
+
+    // FNV-1a, with the seed folded into the offset basis
+    uint32_t hash_constant_name (const string& name, uint32_t seed) {
+        uint32_t hash = 2166136261U ^ seed;
+
+        for (size_t i = 0; i < name.length(); i++) {
+            hash = (hash ^ (unsigned char) name[i]) * 16777619U;
+        }
+
+        return hash;
+    }
+
+    /// BEGIN SCRIPT-GENERATED CONSTANT SETTERS
+    void set_world_width (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::WORLD_WIDTH) {
+                Log::add_error("Game constant 'world_width' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_WIDTH = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_world_height (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::WORLD_HEIGHT) {
+                Log::add_error("Game constant 'world_height' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_HEIGHT = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_spatial_grid_cell_size (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::SPATIAL_GRID_CELL_SIZE) {
+                Log::add_error("Game constant 'spatial_grid_cell_size' differs from its baked value");
+            }
+        #else
+            Game_Constants::SPATIAL_GRID_CELL_SIZE = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_ship_radius (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::SHIP_RADIUS) {
+                Log::add_error("Game constant 'ship_radius' differs from its baked value");
+            }
+        #else
+            Game_Constants::SHIP_RADIUS = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_ship_speed (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::SHIP_SPEED) {
+                Log::add_error("Game constant 'ship_speed' differs from its baked value");
+            }
+        #else
+            Game_Constants::SHIP_SPEED = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_cannonball_radius (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::CANNONBALL_RADIUS) {
+                Log::add_error("Game constant 'cannonball_radius' differs from its baked value");
+            }
+        #else
+            Game_Constants::CANNONBALL_RADIUS = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_cannonball_damage (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_long(value) != Game_Constants::CANNONBALL_DAMAGE) {
+                Log::add_error("Game constant 'cannonball_damage' differs from its baked value");
+            }
+        #else
+            Game_Constants::CANNONBALL_DAMAGE = Strings::string_to_long(value);
+        #endif
+    }
+
+    void set_interest_enter_margin (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::INTEREST_ENTER_MARGIN) {
+                Log::add_error("Game constant 'interest_enter_margin' differs from its baked value");
+            }
+        #else
+            Game_Constants::INTEREST_ENTER_MARGIN = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_interest_exit_margin (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::INTEREST_EXIT_MARGIN) {
+                Log::add_error("Game constant 'interest_exit_margin' differs from its baked value");
+            }
+        #else
+            Game_Constants::INTEREST_EXIT_MARGIN = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_world_seed (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_SEED) {
+                Log::add_error("Game constant 'world_seed' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_SEED = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_tile_size (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::WORLD_TILE_SIZE) {
+                Log::add_error("Game constant 'world_tile_size' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_TILE_SIZE = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_world_chunk_tiles (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNK_TILES) {
+                Log::add_error("Game constant 'world_chunk_tiles' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_TILES = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_chunk_margin (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::WORLD_CHUNK_MARGIN) {
+                Log::add_error("Game constant 'world_chunk_margin' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_MARGIN = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_world_chunk_request_interval (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL) {
+                Log::add_error("Game constant 'world_chunk_request_interval' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_REQUEST_INTERVAL = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_chunk_idle_updates (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNK_IDLE_UPDATES) {
+                Log::add_error("Game constant 'world_chunk_idle_updates' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_IDLE_UPDATES = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_compressed_chunk_limit (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT) {
+                Log::add_error("Game constant 'world_compressed_chunk_limit' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_chunks_per_batch (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNKS_PER_BATCH) {
+                Log::add_error("Game constant 'world_chunks_per_batch' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNKS_PER_BATCH = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_chunk_texture_count (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNK_TEXTURE_COUNT) {
+                Log::add_error("Game constant 'world_chunk_texture_count' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_TEXTURE_COUNT = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_world_chunk_renders_per_frame (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::WORLD_CHUNK_RENDERS_PER_FRAME) {
+                Log::add_error("Game constant 'world_chunk_renders_per_frame' differs from its baked value");
+            }
+        #else
+            Game_Constants::WORLD_CHUNK_RENDERS_PER_FRAME = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_background_layer_texture_count (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::BACKGROUND_LAYER_TEXTURE_COUNT) {
+                Log::add_error("Game constant 'background_layer_texture_count' differs from its baked value");
+            }
+        #else
+            Game_Constants::BACKGROUND_LAYER_TEXTURE_COUNT = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_background_cache_margin (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::BACKGROUND_CACHE_MARGIN) {
+                Log::add_error("Game constant 'background_cache_margin' differs from its baked value");
+            }
+        #else
+            Game_Constants::BACKGROUND_CACHE_MARGIN = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_text_cache_texture_count (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::TEXT_CACHE_TEXTURE_COUNT) {
+                Log::add_error("Game constant 'text_cache_texture_count' differs from its baked value");
+            }
+        #else
+            Game_Constants::TEXT_CACHE_TEXTURE_COUNT = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_text_cache_texture_width (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::TEXT_CACHE_TEXTURE_WIDTH) {
+                Log::add_error("Game constant 'text_cache_texture_width' differs from its baked value");
+            }
+        #else
+            Game_Constants::TEXT_CACHE_TEXTURE_WIDTH = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_text_cache_texture_height (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT) {
+                Log::add_error("Game constant 'text_cache_texture_height' differs from its baked value");
+            }
+        #else
+            Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_dev_info_refresh_interval (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::DEV_INFO_REFRESH_INTERVAL) {
+                Log::add_error("Game constant 'dev_info_refresh_interval' differs from its baked value");
+            }
+        #else
+            Game_Constants::DEV_INFO_REFRESH_INTERVAL = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_navigation_cell_tiles (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::NAVIGATION_CELL_TILES) {
+                Log::add_error("Game constant 'navigation_cell_tiles' differs from its baked value");
+            }
+        #else
+            Game_Constants::NAVIGATION_CELL_TILES = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_navigation_work_per_tick (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::NAVIGATION_WORK_PER_TICK) {
+                Log::add_error("Game constant 'navigation_work_per_tick' differs from its baked value");
+            }
+        #else
+            Game_Constants::NAVIGATION_WORK_PER_TICK = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_navigation_flow_field_limit (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT) {
+                Log::add_error("Game constant 'navigation_flow_field_limit' differs from its baked value");
+            }
+        #else
+            Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_navigation_waypoint_radius (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::NAVIGATION_WAYPOINT_RADIUS) {
+                Log::add_error("Game constant 'navigation_waypoint_radius' differs from its baked value");
+            }
+        #else
+            Game_Constants::NAVIGATION_WAYPOINT_RADIUS = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_ai_lod_full_distance (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::AI_LOD_FULL_DISTANCE) {
+                Log::add_error("Game constant 'ai_lod_full_distance' differs from its baked value");
+            }
+        #else
+            Game_Constants::AI_LOD_FULL_DISTANCE = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_ai_lod_reduced_distance (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_double(value) != Game_Constants::AI_LOD_REDUCED_DISTANCE) {
+                Log::add_error("Game constant 'ai_lod_reduced_distance' differs from its baked value");
+            }
+        #else
+            Game_Constants::AI_LOD_REDUCED_DISTANCE = Strings::string_to_double(value);
+        #endif
+    }
+
+    void set_ai_lod_reduced_interval (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::AI_LOD_REDUCED_INTERVAL) {
+                Log::add_error("Game constant 'ai_lod_reduced_interval' differs from its baked value");
+            }
+        #else
+            Game_Constants::AI_LOD_REDUCED_INTERVAL = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_ai_lod_coarse_interval (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::AI_LOD_COARSE_INTERVAL) {
+                Log::add_error("Game constant 'ai_lod_coarse_interval' differs from its baked value");
+            }
+        #else
+            Game_Constants::AI_LOD_COARSE_INTERVAL = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_ai_work_per_tick (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::AI_WORK_PER_TICK) {
+                Log::add_error("Game constant 'ai_work_per_tick' differs from its baked value");
+            }
+        #else
+            Game_Constants::AI_WORK_PER_TICK = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_effect_capacity (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::EFFECT_CAPACITY) {
+                Log::add_error("Game constant 'effect_capacity' differs from its baked value");
+            }
+        #else
+            Game_Constants::EFFECT_CAPACITY = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_particle_capacity (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::PARTICLE_CAPACITY) {
+                Log::add_error("Game constant 'particle_capacity' differs from its baked value");
+            }
+        #else
+            Game_Constants::PARTICLE_CAPACITY = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+
+    void set_particle_wake_interval (const string& value) {
+        #ifdef GAME_CONSTANTS_BAKED
+            if (Strings::string_to_unsigned_long(value) != Game_Constants::PARTICLE_WAKE_INTERVAL) {
+                Log::add_error("Game constant 'particle_wake_interval' differs from its baked value");
+            }
+        #else
+            Game_Constants::PARTICLE_WAKE_INTERVAL = Strings::string_to_unsigned_long(value);
+        #endif
+    }
+    /// END SCRIPT-GENERATED CONSTANT SETTERS
+
+    // Each name hashes with seed 0 into a bucket, and then with its bucket's seed into its own slot of the table,
+    // so finding a constant takes two hashes and one string compare no matter how many constants there are
+    /// BEGIN SCRIPT-GENERATED CONSTANT TABLE
+    const uint32_t CONSTANT_TABLE_SIZE = 128;
+    const uint32_t CONSTANT_BUCKET_COUNT = 32;
+    const uint32_t CONSTANT_BUCKET_SEEDS[CONSTANT_BUCKET_COUNT] = {
+        3, 3, 1, 0, 1, 2, 1, 1, 0, 2, 2, 3, 0, 2, 0, 2, 1, 1, 0, 0, 1, 0, 0, 1, 2, 2, 0, 2, 1, 1, 1, 1
+    };
+    const Game_Constant_Setter CONSTANT_TABLE[CONSTANT_TABLE_SIZE] = {
+        {"navigation_flow_field_limit", set_navigation_flow_field_limit},
+        {"world_chunk_tiles", set_world_chunk_tiles},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_chunk_request_interval", set_world_chunk_request_interval},
+        {"ai_lod_reduced_interval", set_ai_lod_reduced_interval},
+        {0, 0},
+        {0, 0},
+        {"navigation_waypoint_radius", set_navigation_waypoint_radius},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_tile_size", set_world_tile_size},
+        {"dev_info_refresh_interval", set_dev_info_refresh_interval},
+        {0, 0},
+        {0, 0},
+        {"world_chunks_per_batch", set_world_chunks_per_batch},
+        {"cannonball_damage", set_cannonball_damage},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"interest_enter_margin", set_interest_enter_margin},
+        {"navigation_cell_tiles", set_navigation_cell_tiles},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_width", set_world_width},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"ai_lod_coarse_interval", set_ai_lod_coarse_interval},
+        {"ai_lod_reduced_distance", set_ai_lod_reduced_distance},
+        {0, 0},
+        {0, 0},
+        {"background_layer_texture_count", set_background_layer_texture_count},
+        {0, 0},
+        {0, 0},
+        {"ship_radius", set_ship_radius},
+        {"interest_exit_margin", set_interest_exit_margin},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_height", set_world_height},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"particle_capacity", set_particle_capacity},
+        {0, 0},
+        {0, 0},
+        {"world_chunk_texture_count", set_world_chunk_texture_count},
+        {"particle_wake_interval", set_particle_wake_interval},
+        {"ship_speed", set_ship_speed},
+        {"ai_work_per_tick", set_ai_work_per_tick},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_chunk_idle_updates", set_world_chunk_idle_updates},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"cannonball_radius", set_cannonball_radius},
+        {"effect_capacity", set_effect_capacity},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"text_cache_texture_height", set_text_cache_texture_height},
+        {"world_chunk_margin", set_world_chunk_margin},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"navigation_work_per_tick", set_navigation_work_per_tick},
+        {"world_chunk_renders_per_frame", set_world_chunk_renders_per_frame},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"text_cache_texture_count", set_text_cache_texture_count},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"text_cache_texture_width", set_text_cache_texture_width},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_compressed_chunk_limit", set_world_compressed_chunk_limit},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"world_seed", set_world_seed},
+        {0, 0},
+        {0, 0},
+        {"ai_lod_full_distance", set_ai_lod_full_distance},
+        {"spatial_grid_cell_size", set_spatial_grid_cell_size},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {0, 0},
+        {"background_cache_margin", set_background_cache_margin},
+        {0, 0},
+        {0, 0}
+    };
+    /// END SCRIPT-GENERATED CONSTANT TABLE
+}
+
 void Game_Constants_Loader::set_game_constant (string name, string value) {
     if (name == "zoom_rate") {
         Engine_Data::ZOOM_RATE = Strings::string_to_double(value);
@@ -20,8 +629,14 @@ void Game_Constants_Loader::set_game_constant (string name, string value) {
         Engine_Data::ZOOM_MIN = Strings::string_to_double(value);
     } else if (name == "zoom_max") {
         Engine_Data::ZOOM_MAX = Strings::string_to_double(value);
-    }
+    } else {
+        uint32_t bucket = hash_constant_name(name, 0) & (CONSTANT_BUCKET_COUNT - 1);
+        uint32_t slot = hash_constant_name(name, CONSTANT_BUCKET_SEEDS[bucket]) & (CONSTANT_TABLE_SIZE - 1);
+        const Game_Constant_Setter& setter = CONSTANT_TABLE[slot];
 
-    /// BEGIN SCRIPT-GENERATED CONSTANT SETUP
-    /// END SCRIPT-GENERATED CONSTANT SETUP
+        // Names that are not game constants can still land on an occupied slot
+        if (setter.name != 0 && name == setter.name) {
+            setter.set(value);
+        }
+    }
 }
@@ -8,9 +8,88 @@
 #include <string>
 #include <cstdint>
 
+// Building with GAME_CONSTANTS_BAKED makes the constants constexpr, using the values in the data when
+// generate-game-constants-source was last run, so the compiler can fold them into the code that uses them
 class Game_Constants {
     public:
         /// BEGIN SCRIPT-GENERATED CONSTANT DECLARATIONS
+        #ifdef GAME_CONSTANTS_BAKED
+            static constexpr double WORLD_WIDTH = 8192.0;
+            static constexpr double WORLD_HEIGHT = 8192.0;
+            static constexpr double SPATIAL_GRID_CELL_SIZE = 64.0;
+            static constexpr double SHIP_RADIUS = 16.0;
+            static constexpr double SHIP_SPEED = 1.0;
+            static constexpr double CANNONBALL_RADIUS = 2.0;
+            static constexpr int32_t CANNONBALL_DAMAGE = 10;
+            static constexpr double INTEREST_ENTER_MARGIN = 256.0;
+            static constexpr double INTEREST_EXIT_MARGIN = 512.0;
+            static constexpr uint64_t WORLD_SEED = 1;
+            static constexpr double WORLD_TILE_SIZE = 16.0;
+            static constexpr uint32_t WORLD_CHUNK_TILES = 32;
+            static constexpr double WORLD_CHUNK_MARGIN = 512.0;
+            static constexpr uint32_t WORLD_CHUNK_REQUEST_INTERVAL = 8;
+            static constexpr uint32_t WORLD_CHUNK_IDLE_UPDATES = 300;
+            static constexpr uint32_t WORLD_COMPRESSED_CHUNK_LIMIT = 1024;
+            static constexpr uint32_t WORLD_CHUNKS_PER_BATCH = 32;
+            static constexpr uint32_t WORLD_CHUNK_TEXTURE_COUNT = 64;
+            static constexpr uint32_t WORLD_CHUNK_RENDERS_PER_FRAME = 4;
+            static constexpr uint32_t BACKGROUND_LAYER_TEXTURE_COUNT = 4;
+            static constexpr double BACKGROUND_CACHE_MARGIN = 128.0;
+            static constexpr uint32_t TEXT_CACHE_TEXTURE_COUNT = 8;
+            static constexpr double TEXT_CACHE_TEXTURE_WIDTH = 1024.0;
+            static constexpr double TEXT_CACHE_TEXTURE_HEIGHT = 512.0;
+            static constexpr uint32_t DEV_INFO_REFRESH_INTERVAL = 15;
+            static constexpr uint32_t NAVIGATION_CELL_TILES = 2;
+            static constexpr uint32_t NAVIGATION_WORK_PER_TICK = 4096;
+            static constexpr uint32_t NAVIGATION_FLOW_FIELD_LIMIT = 32;
+            static constexpr double NAVIGATION_WAYPOINT_RADIUS = 16.0;
+            static constexpr double AI_LOD_FULL_DISTANCE = 512.0;
+            static constexpr double AI_LOD_REDUCED_DISTANCE = 2048.0;
+            static constexpr uint32_t AI_LOD_REDUCED_INTERVAL = 4;
+            static constexpr uint32_t AI_LOD_COARSE_INTERVAL = 16;
+            static constexpr uint32_t AI_WORK_PER_TICK = 2048;
+            static constexpr uint32_t EFFECT_CAPACITY = 512;
+            static constexpr uint32_t PARTICLE_CAPACITY = 8192;
+            static constexpr uint32_t PARTICLE_WAKE_INTERVAL = 6;
+        #else
+            static double WORLD_WIDTH;
+            static double WORLD_HEIGHT;
+            static double SPATIAL_GRID_CELL_SIZE;
+            static double SHIP_RADIUS;
+            static double SHIP_SPEED;
+            static double CANNONBALL_RADIUS;
+            static int32_t CANNONBALL_DAMAGE;
+            static double INTEREST_ENTER_MARGIN;
+            static double INTEREST_EXIT_MARGIN;
+            static uint64_t WORLD_SEED;
+            static double WORLD_TILE_SIZE;
+            static uint32_t WORLD_CHUNK_TILES;
+            static double WORLD_CHUNK_MARGIN;
+            static uint32_t WORLD_CHUNK_REQUEST_INTERVAL;
+            static uint32_t WORLD_CHUNK_IDLE_UPDATES;
+            static uint32_t WORLD_COMPRESSED_CHUNK_LIMIT;
+            static uint32_t WORLD_CHUNKS_PER_BATCH;
+            static uint32_t WORLD_CHUNK_TEXTURE_COUNT;
+            static uint32_t WORLD_CHUNK_RENDERS_PER_FRAME;
+            static uint32_t BACKGROUND_LAYER_TEXTURE_COUNT;
+            static double BACKGROUND_CACHE_MARGIN;
+            static uint32_t TEXT_CACHE_TEXTURE_COUNT;
+            static double TEXT_CACHE_TEXTURE_WIDTH;
+            static double TEXT_CACHE_TEXTURE_HEIGHT;
+            static uint32_t DEV_INFO_REFRESH_INTERVAL;
+            static uint32_t NAVIGATION_CELL_TILES;
+            static uint32_t NAVIGATION_WORK_PER_TICK;
+            static uint32_t NAVIGATION_FLOW_FIELD_LIMIT;
+            static double NAVIGATION_WAYPOINT_RADIUS;
+            static double AI_LOD_FULL_DISTANCE;
+            static double AI_LOD_REDUCED_DISTANCE;
+            static uint32_t AI_LOD_REDUCED_INTERVAL;
+            static uint32_t AI_LOD_COARSE_INTERVAL;
+            static uint32_t AI_WORK_PER_TICK;
+            static uint32_t EFFECT_CAPACITY;
+            static uint32_t PARTICLE_CAPACITY;
+            static uint32_t PARTICLE_WAKE_INTERVAL;
+        #endif
         /// END SCRIPT-GENERATED CONSTANT DECLARATIONS
 };
 
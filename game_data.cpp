@@ -3,56 +3,181 @@
 /* See the file docs/LICENSE.txt for the full license text. */
 
 #include "game_data.h"
+#include "async_loader.h"
+#include "job_system.h"
+#include "game_options.h"
+
+#include <log.h>
+#include <engine_strings.h>
+#include <data_manager.h>
+#include <data_reader.h>
 
 using namespace std;
 
-///vector<Example_Game_Tag> Game_Data::example_game_tags;
+Data_Pack Game_Data::data_pack;
+map<string, vector<vector<string>>> Game_Data::text_tags;
+Tag_Registry<Background_Layer> Game_Data::background_layers("background layer");
+///Tag_Registry<Example_Game_Tag> Game_Data::example_game_tags("example game tag");
 
-///Don't forget to increment this for each progress item in load_data_game() below
-const int Game_Data::game_data_load_item_count = 0;
+///Don't forget to increment this for each task added to the loader in load_data_game() below
+const int Game_Data::game_data_load_item_count = 1;
 void Game_Data::load_data_game (Progress_Bar& bar) {
-    ///bar.progress("Loading example game tag");
-    ///Data_Manager::load_data("example_game_tag");
+    // The game options have been loaded by now, and the loader needs the workers before on_startup runs
+    Job_System::start(Game_Options::worker_threads);
+
+    // Compiling the text here would read every tag just for the game's few, so a missing or out of date pack falls
+    // back to the engine's text reader, which only reads the tags asked for
+    // This is always the case on Android, where the data lives inside the APK
+    // The engine's reader runs on this thread, so it only keeps the lines of each tag, and the parsing is left to the
+    // loader below, as it is for the pack
+    if (!data_pack.open("data.pack", "data")) {
+        Data_Manager::load_data("background_layer");
+        ///Data_Manager::load_data("example_game_tag");
+    }
+
+    // Each tag type is independent, so they are all parsed at once
+    Async_Loader loader;
+
+    loader.add("Loading background layers", load_background_layers);
+    ///loader.add("Loading example game tags", load_example_game_tags);
+
+    loader.run(bar);
+
+    data_pack.close();
+    text_tags.clear();
 }
 
 void Game_Data::load_data_tag_game (string tag, File_IO_Load* load) {
-    /**if(tag=="example_game_tag"){
-        load_example_game_tag(load);
+    // Only called when the game's tags are read from the text data, rather than from the data pack
+    if (tag == "background_layer") {
+        read_text_tag(tag, load);
+    }
+    /**else if(tag=="example_game_tag"){
+        read_text_tag(tag,load);
        }*/
 }
 
 void Game_Data::unload_data_game () {
+    background_layers.clear();
     ///example_game_tags.clear();
 }
 
-/**void Game_Data::load_example_game_tag(File_IO_Load* load){
-    example_game_tags.push_back(Example_Game_Tag());
+void Game_Data::read_text_tag (const string& type, File_IO_Load* load) {
+    text_tags[type].push_back(Data_Reader::read_data(load, "</" + type + ">"));
+}
 
-    vector<string> lines=Data_Reader::read_data(load,"</example_game_tag>");
+void Game_Data::load_tags (const string& type, void (*load)(const vector<String_View>&)) {
+    vector<String_View> lines;
 
-    for(size_t i=0;i<lines.size();i++){
-        string& line=lines[i];
+    if (data_pack.is_loaded()) {
+        vector<uint32_t> tags;
+
+        data_pack.find_tags(type.c_str(), tags);
 
-        if(Data_Reader::check_prefix(line,"name:")){
-            example_game_tags.back().name=line;
+        for (size_t i = 0; i < tags.size(); i++) {
+            data_pack.get_lines(data_pack.get_tag(tags[i]), lines);
+            load(lines);
         }
+
+        return;
     }
-   }*/
 
-/**Example_Game_Tag* Game_Data::get_example_game_tag(string name){
-    Example_Game_Tag* ptr_object=0;
+    // Only looked up, since the loaders of the other tag types read text_tags at the same time
+    map<string, vector<vector<string>>>::const_iterator text = text_tags.find(type);
+
+    if (text == text_tags.end()) {
+        return;
+    }
+
+    for (size_t i = 0; i < text->second.size(); i++) {
+        const vector<string>& text_lines = text->second[i];
+
+        lines.clear();
+
+        for (size_t n = 0; n < text_lines.size(); n++) {
+            lines.push_back(String_View(text_lines[n]));
+        }
+
+        load(lines);
+    }
+}
+
+void Game_Data::load_background_layers () {
+    load_tags("background_layer", load_background_layer);
+}
+
+void Game_Data::load_background_layer (const vector<String_View>& lines) {
+    Background_Layer layer;
 
-    for(size_t i=0;i<example_game_tags.size();i++){
-        if(example_game_tags[i].name==name){
-            ptr_object=&example_game_tags[i];
+    for (size_t i = 0; i < lines.size(); i++) {
+        String_View line = lines[i];
 
-            break;
+        if (Data_Pack::check_prefix(line, "name:")) {
+            layer.name = line.to_string();
+        } else if (Data_Pack::check_prefix(line, "style:")) {
+            layer.style = Background_Layer::get_style(line.to_string());
+
+            if (layer.style == BACKGROUND_LAYER_STYLE_COUNT) {
+                Log::add_error("Error loading background layer: unknown style '" + line.to_string() + "'");
+
+                layer.style = BACKGROUND_LAYER_STYLE_GLINTS;
+            }
+        } else if (Data_Pack::check_prefix(line, "color:")) {
+            layer.color = line.to_string();
+        } else if (Data_Pack::check_prefix(line, "opacity:")) {
+            layer.opacity = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "parallax:")) {
+            layer.parallax = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "spacing:")) {
+            layer.spacing = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "size:")) {
+            layer.size = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "drift_x:")) {
+            layer.drift_x = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "drift_y:")) {
+            layer.drift_y = Strings::string_to_double(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "period:")) {
+            layer.period = Strings::string_to_unsigned_long(line.to_string());
+        } else if (Data_Pack::check_prefix(line, "refresh_interval:")) {
+            layer.refresh_interval = Strings::string_to_unsigned_long(line.to_string());
         }
     }
 
-    if(ptr_object==0){
-        Log::add_error("Error accessing example game tag '"+name+"'");
+    background_layers.get(background_layers.add(layer.name)) = layer;
+}
+
+uint32_t Game_Data::get_background_layer_count () {
+    return background_layers.get_count();
+}
+
+const Background_Layer& Game_Data::get_background_layer (uint32_t handle) {
+    return background_layers.get(handle);
+}
+
+/**void Game_Data::load_example_game_tags(){
+    load_tags("example_game_tag",load_example_game_tag);
+   }*/
+
+/**void Game_Data::load_example_game_tag(const vector<String_View>& lines){
+    string name;
+
+    for(size_t i=0;i<lines.size();i++){
+        String_View line=lines[i];
+
+        if(Data_Pack::check_prefix(line,"name:")){
+            name=line.to_string();
+        }
     }
 
-    return ptr_object;
+    Example_Game_Tag& tag=example_game_tags.get(example_game_tags.add(name));
+
+    tag.name=name;
+   }*/
+
+/**uint32_t Game_Data::get_example_game_tag_handle(const string& name){
+    return example_game_tags.get_handle(name);
+   }*/
+
+/**Example_Game_Tag& Game_Data::get_example_game_tag(uint32_t handle){
+    return example_game_tags.get(handle);
    }*/
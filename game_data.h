@@ -5,16 +5,34 @@
 #ifndef game_data_h
 #define game_data_h
 
+#include "data_pack.h"
+#include "tag_registry.h"
+#include "background_layer.h"
 ///#include "example_game_tag.h"
 
 #include <progress_bar.h>
 #include <file_io.h>
 
 #include <vector>
+#include <string>
+#include <map>
 
 class Game_Data {
     private:
-    ///static std::vector<Example_Game_Tag> example_game_tags;
+        // The game's own tags are read from the compiled data pack, or through the engine from the text data when the
+        // pack is missing or out of date
+        // It is only open while loading
+        static Data_Pack data_pack;
+        // The lines of each tag read from the text data, by tag type, kept until the loader has parsed them
+        static std::map<std::string, std::vector<std::vector<std::string>>> text_tags;
+        static Tag_Registry<Background_Layer> background_layers;
+    ///static Tag_Registry<Example_Game_Tag> example_game_tags;
+
+        // Keeps the lines of a tag from the text data for load_tags
+        static void read_text_tag(const std::string& type, File_IO_Load* load);
+        // Passes the lines of every tag of the type to load, from the data pack if it is open, or from the text data
+        // otherwise
+        static void load_tags(const std::string& type, void (*load)(const std::vector<String_View>&));
 
     public:
         // The total number of progress bar items in load_data_game()
@@ -26,8 +44,18 @@ class Game_Data {
         static void load_data_tag_game(std::string tag, File_IO_Load* load);
         static void unload_data_game();
 
-        ///static void load_example_game_tag(File_IO_Load* load);
-        ///static Example_Game_Tag* get_example_game_tag(std::string name);
+        // Called on a worker thread, alongside the loaders of the other tag types
+        static void load_background_layers();
+        static void load_background_layer(const std::vector<String_View>& lines);
+        // Handles run from 0 to the count, in the order the layers appear in the data
+        static uint32_t get_background_layer_count();
+        static const Background_Layer& get_background_layer(uint32_t handle);
+
+        ///static void load_example_game_tags();
+        ///static void load_example_game_tag(const std::vector<String_View>& lines);
+        // Resolve a name to a handle once, and then use the handle to get the tag
+        ///static uint32_t get_example_game_tag_handle(const std::string& name);
+        ///static Example_Game_Tag& get_example_game_tag(uint32_t handle);
 };
 
 #endif
@@ -2,6 +2,11 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "game.h"
+#include "command_ids.h"
+#include "network_game.h"
+#include "input_dispatch.h"
+
 #include <game_manager.h>
 #include <network_engine.h>
 #include <network_server.h>
@@ -12,6 +17,77 @@
 
 using namespace std;
 
+namespace {
+    bool handle_command_gui (uint32_t command) {
+        // Commands missing from the data have this ID too
+        if (command == Command_Ids::INVALID) {
+            return false;
+        }
+        // Pause the game
+        else if (command == Command_Ids::PAUSE) {
+            Game_Manager::toggle_pause();
+
+            return true;
+        }
+        // Example multiplayer pause
+        /**if(command==Command_Ids::PAUSE){
+            if(Network_Engine::status=="server"){
+                Game_Manager::toggle_pause();
+
+                Network_Server::send_paused();
+            }
+
+            return true;
+           }*/
+        // Toggle chat box
+        else if (command == Command_Ids::CHAT) {
+            Engine::chat.toggle_on();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool handle_command (uint32_t command) {
+        const uint8_t* keystates = SDL_GetKeyboardState(NULL);
+
+        if (command == Command_Ids::INVALID) {
+            return false;
+        }
+
+        ///DEV COMMANDS
+        if (Options::dev && keystates[SDL_SCANCODE_F1]) {
+            // Example dev command
+            /**if(command==Command_Ids::SOME_DEV_COMMAND){
+                ///Dev command here.
+
+                return true;
+               }*/
+        }
+
+        ///END OF DEV COMMANDS
+
+        if (!Game_Manager::paused) {
+            // Example command
+            /**if(command==Command_Ids::SOME_COMMAND){
+                ///Command here
+
+                return true;
+               }*/
+
+            // Example multiplayer command input
+            /**if(command==Command_Ids::SOME_COMMAND){
+                Network_Game::add_command(command);
+
+                return true;
+               }*/
+        }
+
+        return false;
+    }
+}
+
 void Game_Manager::handle_drag_and_drop (string file) {
     ///Do something with file
 }
@@ -19,6 +95,7 @@ void Game_Manager::handle_drag_and_drop (string file) {
 void Game_Manager::prepare_for_input () {
     if (in_progress) {
         command_states.clear();
+        Network_Game::clear_command_states();
 
         display_scoreboard = false;
     }
@@ -31,8 +108,10 @@ void Game_Manager::handle_command_states_multiplayer () {
 
             for (size_t i = 0; i < Network_Engine::clients.size(); i++) {
                 if (!paused) {
+                    Game::handle_player_command_states((uint32_t) i, Network_Game::get_command_states((uint32_t) i));
+
                     // Example multiplayer command state
-                    /**if(Network_Engine::clients[i].game_command_state("some_command")){
+                    /**if(Game::get_player_command_state(i,Command_Ids::SOME_COMMAND)){
                         ///Deal with command state here
                        }*/
                 }
@@ -44,19 +123,35 @@ void Game_Manager::handle_command_states_multiplayer () {
 void Game_Manager::handle_game_commands_multiplayer () {
     if (in_progress) {
         if (Network_Engine::status == "server") {
+            vector<pair<uint32_t, Player_Command>> changes;
+            vector<Player_Command> commands;
+
+            Network_Game::take_player_changes(changes);
+
+            // These are applied even while paused, so that a view never stays with a player its client has left
+            for (size_t i = 0; i < changes.size(); i++) {
+                Game::handle_player_command(changes[i].first, changes[i].second);
+            }
+
             for (size_t i = 0; i < Network_Engine::clients.size(); i++) {
+                Network_Game::take_commands((uint32_t) i, commands);
+
+                // Commands queued through the engine arrive as names, and are interned here
                 for (size_t j = 0; j < Network_Engine::clients[i].command_buffer.size(); j++) {
-                    string command_name = Network_Engine::clients[i].command_buffer[j];
+                    uint32_t command = Command_Ids::get_id(Network_Engine::clients[i].command_buffer[j]);
 
-                    if (!paused) {
-                        // Example multiplayer command
-                        /**if(command_name=="some_command"){
-                            ///Deal with command here
-                           }*/
+                    if (command != Command_Ids::INVALID) {
+                        commands.push_back(Player_Command(command));
                     }
                 }
 
                 Network_Engine::clients[i].command_buffer.clear();
+
+                if (!paused) {
+                    for (size_t j = 0; j < commands.size(); j++) {
+                        Game::handle_player_command((uint32_t) i, commands[j]);
+                    }
+                }
             }
         }
     }
@@ -85,87 +180,27 @@ void Game_Manager::handle_input_states () {
         if (!paused) {
             // Example multiplayer command state
             /**if(Object_Manager::game_command_state("some_command")){
-                command_states.push_back("some_command");
+                Network_Game::set_command_state(Command_Ids::SOME_COMMAND);
                }*/
         }
+
+        Network_Game::send_commands();
     }
 }
 
 bool Game_Manager::handle_game_command_gui (string command_name) {
-    // Pause the game
-    if (command_name == "pause") {
-        toggle_pause();
-
-        return true;
-    }
-    // Example multiplayer pause
-    /**if(command_name=="pause"){
-        if(Network_Engine::status=="server"){
-            toggle_pause();
-
-            Network_Server::send_paused();
-        }
-
-        return true;
-       }*/
-    // Toggle chat box
-    else if (command_name == "chat") {
-        Engine::chat.toggle_on();
-
-        return true;
-    }
-
-    return false;
+    return handle_command_gui(Command_Ids::get_id(command_name));
 }
 
 bool Game_Manager::handle_game_command (string command_name) {
-    const uint8_t* keystates = SDL_GetKeyboardState(NULL);
-
-    ///DEV COMMANDS
-    if (Options::dev && keystates[SDL_SCANCODE_F1]) {
-        // Example dev command
-        /**if(command_name=="some_dev_command"){
-            ///Dev command here.
-
-            return true;
-           }*/
-    }
-
-    ///END OF DEV COMMANDS
-
-    if (!paused) {
-        // Example command
-        /**if(command_name=="some_command"){
-            ///Command here
-
-            return true;
-           }*/
-
-        // Example multiplayer command input
-        /**if(command_name=="some_command"){
-            Network_Engine::add_command(command_name);
-
-            return true;
-           }*/
-    }
-
-    return false;
+    return handle_command(Command_Ids::get_id(command_name));
 }
 
 bool Game_Manager::handle_input_events_gui () {
     bool event_consumed = false;
 
     if (in_progress) {
-        const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
-
-        for (size_t i = 0; i < game_commands.size() && !event_consumed; i++) {
-            if ((Engine_Input::event.type == SDL_CONTROLLERBUTTONDOWN &&
-                 game_commands[i].button == Engine_Input::event.cbutton.button) ||
-                (Engine_Input::event.type == SDL_KEYDOWN && Engine_Input::event.key.repeat == 0 &&
-                 game_commands[i].key == Engine_Input::event.key.keysym.scancode)) {
-                event_consumed = handle_game_command_gui(game_commands[i].name);
-            }
-        }
+        event_consumed = Input_Dispatch::dispatch(Engine_Input::event, handle_command_gui);
     }
 
     return event_consumed;
@@ -175,16 +210,7 @@ bool Game_Manager::handle_input_events () {
     bool event_consumed = false;
 
     if (in_progress) {
-        const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
-
-        for (size_t i = 0; i < game_commands.size() && !event_consumed; i++) {
-            if ((Engine_Input::event.type == SDL_CONTROLLERBUTTONDOWN &&
-                 game_commands[i].button == Engine_Input::event.cbutton.button) ||
-                (Engine_Input::event.type == SDL_KEYDOWN && Engine_Input::event.key.repeat == 0 &&
-                 game_commands[i].key == Engine_Input::event.key.keysym.scancode)) {
-                event_consumed = handle_game_command(game_commands[i].name);
-            }
-        }
+        event_consumed = Input_Dispatch::dispatch(Engine_Input::event, handle_command);
     }
 
     return event_consumed;
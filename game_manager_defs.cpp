@@ -2,6 +2,14 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "game.h"
+#include "game_constants.h"
+#include "game_options.h"
+#include "job_system.h"
+#include "command_ids.h"
+#include "input_dispatch.h"
+#include "text_cache.h"
+
 #include <game_manager.h>
 #include <options.h>
 #include <music_manager.h>
@@ -20,10 +28,19 @@
 
 using namespace std;
 
-void Game_Manager::on_startup () {}
+void Game_Manager::on_startup () {
+    Job_System::start(Game_Options::worker_threads);
+
+    // A server joined later sends its own seed
+    Game::world_seed = Game_Constants::WORLD_SEED;
+
+    // The game commands have been loaded by now
+    Command_Ids::setup();
+    Input_Dispatch::rebuild();
+}
 
 bool Game_Manager::effect_allowed () {
-    uint32_t effects = /**Game_Data::effects_example.size()*/ 0;
+    uint32_t effects = Game::particles.get_effect_count();
 
     if (effects < Options::effect_limit) {
         return true;
@@ -90,16 +107,16 @@ void Game_Manager::set_camera () {
         camera.x = 0.0;
     }
 
-    if (camera.x + camera.w > 0 /**World size x*/ * camera_zoom) {
-        camera.x = 0 /**World size x*/ * camera_zoom - camera.w;
+    if (camera.x + camera.w > Game_Constants::WORLD_WIDTH * camera_zoom) {
+        camera.x = Game_Constants::WORLD_WIDTH * camera_zoom - camera.w;
     }
 
     if (camera.y < 0.0) {
         camera.y = 0.0;
     }
 
-    if (camera.y + camera.h > 0 /**World size y*/ * camera_zoom) {
-        camera.y = 0 /**World size y*/ * camera_zoom - camera.h;
+    if (camera.y + camera.h > Game_Constants::WORLD_HEIGHT * camera_zoom) {
+        camera.y = Game_Constants::WORLD_HEIGHT * camera_zoom - camera.h;
     }
 
     Screen_Shake::update_camera_after(camera);
@@ -130,11 +147,12 @@ void Game_Manager::render_scoreboard () {
 
         Render::render_rectangle(0.0, 0.0, Game_Window::width(), Game_Window::height(), 0.5, "ui_black");
 
-        font->show(72.0, (Game_Window::height() - (Strings::newline_count(
-                                                       name_list) + 1) * font->spacing_y) / 2.0, name_list, "ui_white");
-        font->show(168.0, (Game_Window::height() - (Strings::newline_count(
-                                                        ping_list) + 1) * font->spacing_y) / 2.0, ping_list,
-                   "ui_white");
+        Text_Cache::show(font, 72.0, (Game_Window::height() - (Strings::newline_count(
+                                                                 name_list) + 1) * font->spacing_y) / 2.0, name_list,
+                         "ui_white");
+        Text_Cache::show(font, 168.0, (Game_Window::height() - (Strings::newline_count(
+                                                                  ping_list) + 1) * font->spacing_y) / 2.0, ping_list,
+                         "ui_white");
     }
 }
 
@@ -143,9 +161,9 @@ void Game_Manager::render_title_background () {
 
     Render::render_rectangle(0.0, 0.0, Game_Window::width(), Game_Window::height(), 1.0, "ui_black");
 
-    font->show(0.0, Game_Window::height() - font->spacing_y * 2.0,
-               "Version: " + Engine_Version::get_version() + " " + Engine_Version::get_status() + "\nChecksum: " + Engine::CHECKSUM,
-               "ui_white");
+    Text_Cache::show(font, 0.0, Game_Window::height() - font->spacing_y * 2.0,
+                     "Version: " + Engine_Version::get_version() + " " + Engine_Version::get_status() + "\nChecksum: " +
+                     Engine::CHECKSUM, "ui_white");
 
     Image_Data* logo = Image_Manager::get_image("logo");
     double logo_scale_x = (double) Game_Window::width() / (double) 1280.0;
@@ -159,13 +177,16 @@ void Game_Manager::render_pause () {
     Bitmap_Font* font = Object_Manager::get_font("standard");
     string msg = "Paused";
 
-    font->show((Game_Window::width() - (font->spacing_x * msg.length())) / 2.0,
-               (Game_Window::height() - font->spacing_y) / 2.0, msg, "ui_white");
+    Text_Cache::show(font, (Game_Window::width() - (font->spacing_x * msg.length())) / 2.0,
+                     (Game_Window::height() - font->spacing_y) / 2.0, msg, "ui_white");
 }
 
 void Game_Manager::render_fps (int render_rate, double ms_per_frame, int logic_frame_rate) {
-    Object_Manager::get_font("small")->show(2.0, 2.0, "FPS: " + Strings::num_to_string(
-                                                render_rate) + "\n" + Network_Engine::get_stats(), "ui_white");
+    Bitmap_Font* font = Object_Manager::get_font("small");
+
+    // The frame rate only changes once a second, but the network stats change nearly every frame
+    Text_Cache::show(font, 2.0, 2.0, "FPS: " + Strings::num_to_string(render_rate), "ui_white");
+    font->show(2.0, 2.0 + font->spacing_y, Network_Engine::get_stats(), "ui_white");
 }
 
 void Game_Manager::render_loading_screen (const Progress_Bar& bar, string message) {
@@ -4,9 +4,12 @@
 
 #include "game_options.h"
 
+#include <engine_strings.h>
+
 using namespace std;
 
 ///int Game_Options::example_option=0;
+uint32_t Game_Options::worker_threads = 0;
 
 bool Game_Options::get_option (string name, string& value) {
     /**if(name=="cl_example_option"){
@@ -15,6 +18,12 @@ bool Game_Options::get_option (string name, string& value) {
         return true;
        }*/
 
+    if (name == "cl_worker_threads") {
+        value = Strings::num_to_string(worker_threads);
+
+        return true;
+    }
+
     return false;
 }
 
@@ -22,4 +31,8 @@ void Game_Options::set_option (string name, string value) {
     /**if(name=="cl_example_option"){
         example_option=Strings::string_to_long(value);
        }*/
+
+    if (name == "cl_worker_threads") {
+        worker_threads = Strings::string_to_unsigned_long(value);
+    }
 }
@@ -6,10 +6,12 @@
 #define game_options_h
 
 #include <string>
+#include <cstdint>
 
 class Game_Options {
     public:
         ///static int example_option;
+        static uint32_t worker_threads;
 
         static bool get_option(std::string name, std::string& value);
         static void set_option(std::string name, std::string value);
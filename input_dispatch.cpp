@@ -0,0 +1,111 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "input_dispatch.h"
+#include "command_ids.h"
+#include "state_hash.h"
+
+#include <object_manager.h>
+
+using namespace std;
+
+vector<uint32_t> Input_Dispatch::key_offsets;
+vector<uint32_t> Input_Dispatch::key_commands;
+vector<uint32_t> Input_Dispatch::button_offsets;
+vector<uint32_t> Input_Dispatch::button_commands;
+uint64_t Input_Dispatch::binding_hash = 0;
+
+uint64_t Input_Dispatch::get_binding_hash () {
+    const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
+    uint64_t hash = State_Hash_History::mix(0, game_commands.size());
+
+    for (size_t i = 0; i < game_commands.size(); i++) {
+        hash = State_Hash_History::mix(hash, (uint64_t) game_commands[i].key);
+        hash = State_Hash_History::mix(hash, (uint64_t) (int64_t) game_commands[i].button);
+    }
+
+    return hash;
+}
+
+void Input_Dispatch::build_table (const vector<int32_t>& bindings, uint32_t input_count, vector<uint32_t>& offsets,
+                                  vector<uint32_t>& commands) {
+    const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
+
+    offsets.assign(input_count + 1, 0);
+
+    // Count the commands bound to each input, then turn the counts into offsets
+    for (size_t i = 0; i < bindings.size(); i++) {
+        if (bindings[i] >= 0 && (uint32_t) bindings[i] < input_count) {
+            offsets[bindings[i] + 1]++;
+        }
+    }
+
+    for (uint32_t i = 0; i < input_count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+
+    commands.assign(offsets[input_count], Command_Ids::INVALID);
+
+    // Commands keep their data order within an input, which is the order the old scan tried them in
+    for (size_t i = 0; i < bindings.size(); i++) {
+        if (bindings[i] >= 0 && (uint32_t) bindings[i] < input_count) {
+            commands[next[bindings[i]]++] = Command_Ids::get_id(game_commands[i].name);
+        }
+    }
+}
+
+void Input_Dispatch::rebuild () {
+    const vector<Game_Command>& game_commands = Object_Manager::get_game_commands();
+    vector<int32_t> keys;
+    vector<int32_t> buttons;
+
+    for (size_t i = 0; i < game_commands.size(); i++) {
+        // An unbound key is SDL_SCANCODE_UNKNOWN, and an unbound button is negative
+        keys.push_back(game_commands[i].key != SDL_SCANCODE_UNKNOWN ? (int32_t) game_commands[i].key : -1);
+        buttons.push_back((int32_t) game_commands[i].button);
+    }
+
+    build_table(keys, SDL_NUM_SCANCODES, key_offsets, key_commands);
+    build_table(buttons, SDL_CONTROLLER_BUTTON_MAX, button_offsets, button_commands);
+
+    binding_hash = get_binding_hash();
+}
+
+bool Input_Dispatch::dispatch (const SDL_Event& event, bool (*handler)(uint32_t command)) {
+    const vector<uint32_t>* offsets = 0;
+    const vector<uint32_t>* commands = 0;
+    uint32_t input = 0;
+
+    if (event.type == SDL_CONTROLLERBUTTONDOWN) {
+        offsets = &button_offsets;
+        commands = &button_commands;
+        input = event.cbutton.button;
+    } else if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
+        offsets = &key_offsets;
+        commands = &key_commands;
+        input = (uint32_t) event.key.keysym.scancode;
+    }
+
+    if (offsets == 0) {
+        return false;
+    }
+
+    if (get_binding_hash() != binding_hash) {
+        rebuild();
+    }
+
+    if (input + 1 >= offsets->size()) {
+        return false;
+    }
+
+    for (uint32_t i = (*offsets)[input]; i < (*offsets)[input + 1]; i++) {
+        if (handler((*commands)[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
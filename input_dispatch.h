@@ -0,0 +1,39 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef input_dispatch_h
+#define input_dispatch_h
+
+#include <SDL.h>
+
+#include <vector>
+#include <cstdint>
+
+// Maps each scancode and controller button straight to the IDs of the commands bound to it,
+// so an input event costs a table lookup instead of a scan of every command
+// Rebuilt whenever a binding changes
+// The engine can change bindings without the game hearing about it, such as when resetting them to their defaults,
+// so dispatch checks a hash of the bindings and rebuilds when it no longer matches
+class Input_Dispatch {
+    private:
+        // For each scancode or button, its commands are [offsets[i], offsets[i + 1]) in the matching commands list
+        static std::vector<uint32_t> key_offsets;
+        static std::vector<uint32_t> key_commands;
+        static std::vector<uint32_t> button_offsets;
+        static std::vector<uint32_t> button_commands;
+        static uint64_t binding_hash;
+
+        static uint64_t get_binding_hash();
+        static void build_table(const std::vector<int32_t>& bindings, uint32_t input_count,
+                                std::vector<uint32_t>& offsets, std::vector<uint32_t>& commands);
+
+    public:
+        static void rebuild();
+
+        // Calls handler with each command bound to the event's key or button, until one of them consumes it
+        // Returns true if the event was consumed
+        static bool dispatch(const SDL_Event& event, bool (*handler)(uint32_t command));
+};
+
+#endif
@@ -0,0 +1,229 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "job_system.h"
+#include "trace_profiler.h"
+
+#include <engine_strings.h>
+
+#include <algorithm>
+
+using namespace std;
+
+Job_Batch::Job_Batch () {
+    function = 0;
+    remaining = 0;
+}
+
+Job::Job () {
+    batch = 0;
+    begin = 0;
+    end = 0;
+}
+
+Job::Job (Job_Batch* new_batch, uint32_t new_begin, uint32_t new_end) {
+    batch = new_batch;
+    begin = new_begin;
+    end = new_end;
+}
+
+vector<Job_Queue*>* Job_System::queues = 0;
+mutex* Job_System::wake_mutex = 0;
+condition_variable* Job_System::wake_condition = 0;
+atomic<uint32_t> Job_System::queued_jobs(0);
+uint32_t Job_System::thread_count = 1;
+
+void Job_System::start (uint32_t new_thread_count) {
+    if (queues != 0) {
+        return;
+    }
+
+    if (new_thread_count == 0) {
+        new_thread_count = thread::hardware_concurrency();
+    }
+
+    if (new_thread_count == 0) {
+        new_thread_count = 1;
+    }
+
+    queues = new vector<Job_Queue*>();
+    wake_mutex = new mutex();
+    wake_condition = new condition_variable();
+    thread_count = new_thread_count;
+
+    for (uint32_t i = 0; i < thread_count; i++) {
+        queues->push_back(new Job_Queue());
+    }
+
+    for (uint32_t i = 1; i < thread_count; i++) {
+        thread(worker_loop, i).detach();
+    }
+}
+
+uint32_t Job_System::get_thread_count () {
+    return thread_count;
+}
+
+bool Job_System::take_job (deque<Job>& jobs, bool from_back, Job& job, const Job_Batch* batch) {
+    if (jobs.empty()) {
+        return false;
+    }
+
+    if (batch == 0) {
+        job = from_back ? jobs.back() : jobs.front();
+
+        if (from_back) {
+            jobs.pop_back();
+        } else {
+            jobs.pop_front();
+        }
+    } else {
+        // The same ends are searched first as when taking any job, so that the order stays the same
+        deque<Job>::iterator it = jobs.end();
+
+        for (size_t i = 0; i < jobs.size() && it == jobs.end(); i++) {
+            size_t n = from_back ? jobs.size() - 1 - i : i;
+
+            if (jobs[n].batch == batch) {
+                it = jobs.begin() + n;
+            }
+        }
+
+        if (it == jobs.end()) {
+            return false;
+        }
+
+        job = *it;
+        jobs.erase(it);
+    }
+
+    queued_jobs--;
+
+    return true;
+}
+
+bool Job_System::pop_job (uint32_t worker, Job& job, const Job_Batch* batch) {
+    Job_Queue* own_queue = (*queues)[worker];
+
+    {
+        lock_guard<mutex> lock(own_queue->mutex);
+
+        if (take_job(own_queue->jobs, true, job, batch)) {
+            return true;
+        }
+    }
+
+    for (uint32_t offset = 1; offset < thread_count; offset++) {
+        Job_Queue* victim_queue = (*queues)[(worker + offset) % thread_count];
+        lock_guard<mutex> lock(victim_queue->mutex);
+
+        if (take_job(victim_queue->jobs, false, job, batch)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Job_System::run_job (const Job& job) {
+    Trace_Scope trace("job", "job");
+
+    (*job.batch->function)(job.begin, job.end);
+
+    job.batch->remaining.fetch_sub(1, memory_order_release);
+}
+
+void Job_System::worker_loop (uint32_t worker) {
+    Job job;
+
+    Trace_Profiler::set_thread_name("worker " + Strings::num_to_string(worker));
+
+    while (true) {
+        if (pop_job(worker, job, 0)) {
+            run_job(job);
+        } else {
+            unique_lock<mutex> lock(*wake_mutex);
+
+            wake_condition->wait(lock, [] () {
+                return queued_jobs.load() > 0;
+            });
+        }
+    }
+}
+
+void Job_System::submit (Job_Batch& batch, uint32_t count, uint32_t grain_size,
+                         const function<void(uint32_t, uint32_t)>& job_function) {
+    if (grain_size == 0) {
+        grain_size = 1;
+    }
+
+    uint32_t range_count = (count + grain_size - 1) / grain_size;
+
+    batch.function = &job_function;
+    batch.remaining = range_count;
+
+    if (queues == 0) {
+        for (uint32_t begin = 0; begin < count; begin += grain_size) {
+            run_job(Job(&batch, begin, min(begin + grain_size, count)));
+        }
+
+        return;
+    }
+
+    // Counted before the jobs are visible, so that a worker can never see more jobs than queued_jobs claims
+    queued_jobs += range_count;
+
+    for (uint32_t range = 0; range < range_count; range++) {
+        uint32_t begin = range * grain_size;
+        Job_Queue* queue = (*queues)[range % thread_count];
+        lock_guard<mutex> lock(queue->mutex);
+
+        queue->jobs.push_back(Job(&batch, begin, min(begin + grain_size, count)));
+    }
+
+    {
+        lock_guard<mutex> lock(*wake_mutex);
+    }
+
+    wake_condition->notify_all();
+}
+
+bool Job_System::run_queued_job (const Job_Batch& batch) {
+    Job job;
+
+    if (queues == 0 || !pop_job(0, job, &batch)) {
+        return false;
+    }
+
+    run_job(job);
+
+    return true;
+}
+
+void Job_System::parallel_for (uint32_t count, uint32_t grain_size,
+                               const function<void(uint32_t, uint32_t)>& job_function) {
+    if (grain_size == 0) {
+        grain_size = 1;
+    }
+
+    uint32_t range_count = (count + grain_size - 1) / grain_size;
+
+    if (queues == 0 || thread_count == 1 || range_count <= 1) {
+        for (uint32_t begin = 0; begin < count; begin += grain_size) {
+            job_function(begin, min(begin + grain_size, count));
+        }
+
+        return;
+    }
+
+    Job_Batch batch;
+
+    submit(batch, count, grain_size, job_function);
+
+    while (batch.remaining.load(memory_order_acquire) > 0) {
+        if (!run_queued_job(batch)) {
+            this_thread::yield();
+        }
+    }
+}
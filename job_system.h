@@ -0,0 +1,86 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef job_system_h
+#define job_system_h
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+class Job_Batch {
+    public:
+        const std::function<void(uint32_t, uint32_t)>* function;
+        std::atomic<uint32_t> remaining;
+
+        Job_Batch ();
+};
+
+class Job {
+    public:
+        Job_Batch* batch;
+        uint32_t begin;
+        uint32_t end;
+
+        Job ();
+        Job (Job_Batch* new_batch, uint32_t new_begin, uint32_t new_end);
+};
+
+class Job_Queue {
+    public:
+        std::mutex mutex;
+        std::deque<Job> jobs;
+};
+
+// Work-stealing thread pool for splitting a game phase into ranges of entities
+// Every worker owns a queue, pops from the back of its own queue, and steals from the front of the others' queues
+// The calling thread is worker 0 and helps execute its own batch, so a phase always makes progress
+// While it waits, it only runs jobs from the batch it is waiting on, so an unrelated long job never holds it up
+class Job_System {
+    private:
+        // Heap allocated and never freed, so that workers still parked at exit never touch destroyed statics
+        static std::vector<Job_Queue*>* queues;
+        static std::mutex* wake_mutex;
+        static std::condition_variable* wake_condition;
+        static std::atomic<uint32_t> queued_jobs;
+        static uint32_t thread_count;
+
+        // If batch is not 0, only a job from that batch is taken
+        static bool pop_job(uint32_t worker, Job& job, const Job_Batch* batch);
+        static bool take_job(std::deque<Job>& jobs, bool from_back, Job& job, const Job_Batch* batch);
+        static void run_job(const Job& job);
+        static void worker_loop(uint32_t worker);
+
+    public:
+        // Pass 0 to use one worker per hardware thread
+        // Only the first call has any effect
+        static void start(uint32_t new_thread_count);
+        // Includes the calling thread
+        static uint32_t get_thread_count();
+
+        // Splits [0, count) into ranges of at most grain_size and runs job_function(begin, end) on each of them,
+        // returning once all of them have finished
+        // The ranges depend only on count and grain_size, never on the number of threads, so as long as each range
+        // only writes to its own elements the result is identical for any thread count
+        // Must not be called from inside of a job
+        static void parallel_for(uint32_t count, uint32_t grain_size,
+                                 const std::function<void(uint32_t, uint32_t)>& job_function);
+
+        // Queues the ranges of [0, count) like parallel_for, but returns without waiting for them to run
+        // The ranges have all finished once batch.remaining reaches 0, and batch and job_function must stay alive
+        // until then
+        // If the job system has not been started, the ranges are run before returning
+        static void submit(Job_Batch& batch, uint32_t count, uint32_t grain_size,
+                           const std::function<void(uint32_t, uint32_t)>& job_function);
+        // Runs one queued job from batch on the calling thread, as worker 0
+        // Returns false if there was nothing to run
+        static bool run_queued_job(const Job_Batch& batch);
+};
+
+#endif
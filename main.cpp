@@ -4,11 +4,20 @@
 
 #include "main.h"
 #include "game_data.h"
+#include "dedicated_server.h"
 
 #include <main_startup.h>
 
 using namespace std;
 
 int main (int argc, char* args[]) {
-    return main_startup(argc, args, Game_Data::game_data_load_item_count);
+    #ifdef GAME_DEDICATED_SERVER
+        return Dedicated_Server::run(argc, args);
+    #else
+        if (Dedicated_Server::is_requested(argc, args)) {
+            return Dedicated_Server::run(argc, args);
+        }
+
+        return main_startup(argc, args, Game_Data::game_data_load_item_count);
+    #endif
 }
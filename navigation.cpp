@@ -0,0 +1,1029 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "navigation.h"
+#include "game_constants.h"
+#include "world_generator.h"
+#include "trace_profiler.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+namespace {
+    // Movement costs, where a diagonal step costs about the square root of 2 straight steps
+    const uint32_t STRAIGHT_COST = 10;
+    const uint32_t DIAGONAL_COST = 14;
+
+    // An admissible estimate of the cost of moving between two cells with 8-way movement
+    uint32_t octile_distance (uint32_t from_x, uint32_t from_y, uint32_t to_x, uint32_t to_y) {
+        uint32_t dx = from_x > to_x ? from_x - to_x : to_x - from_x;
+        uint32_t dy = from_y > to_y ? from_y - to_y : to_y - from_y;
+
+        return STRAIGHT_COST * max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * min(dx, dy);
+    }
+}
+
+Navigation_Region::Navigation_Region () {
+    built = false;
+}
+
+Navigation_Flow_Field::Navigation_Flow_Field () {
+    goal_node = Navigation::INVALID;
+    last_used = 0;
+    expansions = 0;
+}
+
+Navigation_Agent::Navigation_Agent () {
+    generation = 0;
+    state = NAVIGATION_STATE_NONE;
+    next_waypoint = 0;
+    final_leg = false;
+    in_queue = false;
+}
+
+const uint32_t Navigation::INVALID = 0xFFFFFFFF;
+const uint16_t Navigation::BLOCKED = 0xFFFF;
+
+Navigation::Navigation () {
+    cell_tiles = 1;
+    cells_x = 0;
+    cells_y = 0;
+    region_cells = 1;
+    regions_x = 0;
+    regions_y = 0;
+    flow_field_use_count = 0;
+    queue_start = 0;
+}
+
+Navigation::~Navigation () {
+    clear();
+}
+
+void Navigation::setup (const World_Map& world_map) {
+    clear();
+
+    uint32_t chunk_tiles = max(world_map.get_chunk_tiles(), (uint32_t) 1);
+
+    // Regions line up with chunks, so that a changed chunk only touches the regions it overlaps
+    cell_tiles = min(max(Game_Constants::NAVIGATION_CELL_TILES, (uint32_t) 1), chunk_tiles);
+    cell_size = Fixed::from_double(world_map.get_tile_size() * cell_tiles);
+    region_cells = chunk_tiles / cell_tiles;
+    cells_x = world_map.get_tiles_x() / cell_tiles;
+    cells_y = world_map.get_tiles_y() / cell_tiles;
+    regions_x = (cells_x + region_cells - 1) / region_cells;
+    regions_y = (cells_y + region_cells - 1) / region_cells;
+
+    regions.assign((size_t) regions_x * regions_y, Navigation_Region());
+    search_costs.assign(region_cells * region_cells + 1, INVALID);
+    search_parents.assign(region_cells * region_cells + 1, INVALID);
+}
+
+void Navigation::clear () {
+    delete_flow_fields();
+    regions.assign(regions.size(), Navigation_Region());
+    agents.clear();
+    queue.clear();
+    queue_start = 0;
+}
+
+uint32_t Navigation::get_region_index (uint32_t cell) const {
+    return (cell / cells_x / region_cells) * regions_x + (cell % cells_x) / region_cells;
+}
+
+uint32_t Navigation::get_region_cell (uint32_t cell) const {
+    return ((cell / cells_x) % region_cells) * region_cells + (cell % cells_x) % region_cells;
+}
+
+bool Navigation::is_cell_water (World_Map& world_map, uint32_t cell_x, uint32_t cell_y) const {
+    for (uint32_t y = 0; y < cell_tiles; y++) {
+        for (uint32_t x = 0; x < cell_tiles; x++) {
+            uint8_t tile = world_map.get_tile(cell_x * cell_tiles + x, cell_y * cell_tiles + y);
+
+            if (tile != WORLD_TILE_DEEP_WATER && tile != WORLD_TILE_WATER) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+Navigation_Region& Navigation::get_region (World_Map& world_map, uint32_t region_index) {
+    if (!regions[region_index].built) {
+        build_region(world_map, region_index);
+    }
+
+    return regions[region_index];
+}
+
+void Navigation::build_region (World_Map& world_map, uint32_t region_index) {
+    Trace_Scope trace("build_navigation_region", "navigation");
+
+    Navigation_Region& region = regions[region_index];
+    uint32_t first_x = (region_index % regions_x) * region_cells;
+    uint32_t first_y = (region_index / regions_x) * region_cells;
+    vector<bool> water(region_cells * region_cells, false);
+
+    for (uint32_t y = 0; y < region_cells; y++) {
+        for (uint32_t x = 0; x < region_cells; x++) {
+            if (first_x + x < cells_x && first_y + y < cells_y) {
+                water[y * region_cells + x] = is_cell_water(world_map, first_x + x, first_y + y);
+            }
+        }
+    }
+
+    region.built = true;
+    region.cell_areas.assign(region_cells * region_cells, BLOCKED);
+    region.area_centers.clear();
+
+    vector<uint32_t> stack;
+    vector<uint32_t> members;
+
+    // Areas are numbered in the order their first cell is found, row by row
+    for (uint32_t first = 0; first < region.cell_areas.size(); first++) {
+        if (!water[first] || region.cell_areas[first] != BLOCKED) {
+            continue;
+        }
+
+        uint16_t area = (uint16_t) region.area_centers.size();
+        uint64_t sum_x = 0;
+        uint64_t sum_y = 0;
+
+        members.clear();
+        stack.push_back(first);
+        region.cell_areas[first] = area;
+
+        while (!stack.empty()) {
+            uint32_t local = stack.back();
+            uint32_t x = local % region_cells;
+            uint32_t y = local / region_cells;
+
+            stack.pop_back();
+            members.push_back(local);
+            sum_x += x;
+            sum_y += y;
+
+            uint32_t neighbors[4] = {
+                x > 0 ? local - 1 : INVALID, x + 1 < region_cells ? local + 1 : INVALID,
+                y > 0 ? local - region_cells : INVALID, y + 1 < region_cells ? local + region_cells : INVALID
+            };
+
+            for (uint32_t n = 0; n < 4; n++) {
+                if (neighbors[n] != INVALID && water[neighbors[n]] && region.cell_areas[neighbors[n]] == BLOCKED) {
+                    region.cell_areas[neighbors[n]] = area;
+                    stack.push_back(neighbors[n]);
+                }
+            }
+        }
+
+        // The member nearest to the average position, which unlike the average itself is always in the area
+        uint32_t middle_x = (uint32_t) (sum_x / members.size());
+        uint32_t middle_y = (uint32_t) (sum_y / members.size());
+        uint32_t center = members[0];
+        uint32_t center_distance = INVALID;
+
+        sort(members.begin(), members.end());
+
+        for (size_t i = 0; i < members.size(); i++) {
+            uint32_t distance = octile_distance(members[i] % region_cells, members[i] / region_cells, middle_x,
+                                                middle_y);
+
+            if (distance < center_distance) {
+                center = members[i];
+                center_distance = distance;
+            }
+        }
+
+        region.area_centers.push_back((first_y + center / region_cells) * cells_x + first_x + center % region_cells);
+    }
+}
+
+uint32_t Navigation::get_node (World_Map& world_map, uint32_t cell) {
+    if (cell >= cells_x * cells_y) {
+        return INVALID;
+    }
+
+    uint32_t region_index = get_region_index(cell);
+    uint16_t area = get_region(world_map, region_index).cell_areas[get_region_cell(cell)];
+
+    if (area == BLOCKED) {
+        return INVALID;
+    }
+
+    return region_index * region_cells * region_cells + area;
+}
+
+uint32_t Navigation::find_open_cell (World_Map& world_map, uint32_t cell) {
+    uint32_t region_index = get_region_index(cell);
+    const Navigation_Region& region = get_region(world_map, region_index);
+    uint32_t first_x = (region_index % regions_x) * region_cells;
+    uint32_t first_y = (region_index / regions_x) * region_cells;
+    uint32_t best = INVALID;
+    uint32_t best_distance = INVALID;
+
+    for (uint32_t local = 0; local < region.cell_areas.size(); local++) {
+        if (region.cell_areas[local] != BLOCKED) {
+            uint32_t distance = octile_distance(first_x + local % region_cells, first_y + local / region_cells,
+                                                cell % cells_x, cell / cells_x);
+
+            if (distance < best_distance) {
+                best = (first_y + local / region_cells) * cells_x + first_x + local % region_cells;
+                best_distance = distance;
+            }
+        }
+    }
+
+    return best;
+}
+
+uint32_t Navigation::get_neighbors (World_Map& world_map, uint32_t node, vector<pair<uint32_t, uint32_t>>& neighbors,
+                                    vector<uint64_t>& read_regions) {
+    uint32_t region_size = region_cells * region_cells;
+    uint32_t region_index = node / region_size;
+    uint16_t area = (uint16_t) (node % region_size);
+    uint32_t region_x = region_index % regions_x;
+    uint32_t region_y = region_index / regions_x;
+    uint32_t center = get_region(world_map, region_index).area_centers[area];
+    // Right, down, left, up
+    const int32_t offsets[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    uint32_t new_regions = 0;
+
+    neighbors.clear();
+
+    if (((read_regions[region_index / 64] >> (region_index % 64)) & 1) == 0) {
+        read_regions[region_index / 64] |= (uint64_t) 1 << (region_index % 64);
+        new_regions++;
+    }
+
+    for (uint32_t direction = 0; direction < 4; direction++) {
+        int32_t offset_x = offsets[direction][0];
+        int32_t offset_y = offsets[direction][1];
+
+        if ((offset_x < 0 && region_x == 0) || (offset_y < 0 && region_y == 0) ||
+            (offset_x > 0 && region_x + 1 >= regions_x) || (offset_y > 0 && region_y + 1 >= regions_y)) {
+            continue;
+        }
+
+        uint32_t other_index = (region_y + offset_y) * regions_x + region_x + offset_x;
+        const Navigation_Region& region = get_region(world_map, region_index);
+        const Navigation_Region& other = get_region(world_map, other_index);
+
+        // A region with no neighboring nodes is read all the same, since if it changes it could gain some
+        if (((read_regions[other_index / 64] >> (other_index % 64)) & 1) == 0) {
+            read_regions[other_index / 64] |= (uint64_t) 1 << (other_index % 64);
+            new_regions++;
+        }
+
+        for (uint32_t i = 0; i < region_cells; i++) {
+            // The pair of cells facing each other across the border
+            uint32_t local = 0;
+            uint32_t other_local = 0;
+
+            if (offset_x != 0) {
+                local = i * region_cells + (offset_x > 0 ? region_cells - 1 : 0);
+                other_local = i * region_cells + (offset_x > 0 ? 0 : region_cells - 1);
+            } else {
+                local = (offset_y > 0 ? region_cells - 1 : 0) * region_cells + i;
+                other_local = (offset_y > 0 ? 0 : region_cells - 1) * region_cells + i;
+            }
+
+            if (region.cell_areas[local] != area || other.cell_areas[other_local] == BLOCKED) {
+                continue;
+            }
+
+            uint16_t other_area = other.cell_areas[other_local];
+            uint32_t other_node = other_index * region_size + other_area;
+            bool found = false;
+
+            for (size_t n = 0; n < neighbors.size() && !found; n++) {
+                found = neighbors[n].first == other_node;
+            }
+
+            if (!found) {
+                uint32_t other_center = other.area_centers[other_area];
+                uint32_t cost = octile_distance(center % cells_x, center / cells_x, other_center % cells_x,
+                                                other_center / cells_x);
+
+                neighbors.push_back(make_pair(other_node, max(cost, (uint32_t) 1)));
+            }
+        }
+    }
+
+    return new_regions;
+}
+
+uint32_t Navigation::get_portal (World_Map& world_map, uint32_t from_node, uint32_t to_node) {
+    uint32_t region_size = region_cells * region_cells;
+    uint32_t from_index = from_node / region_size;
+    uint32_t to_index = to_node / region_size;
+    const Navigation_Region& from = get_region(world_map, from_index);
+    const Navigation_Region& to = get_region(world_map, to_index);
+    int32_t offset_x = (int32_t) (to_index % regions_x) - (int32_t) (from_index % regions_x);
+    int32_t offset_y = (int32_t) (to_index / regions_x) - (int32_t) (from_index / regions_x);
+    uint32_t to_first_x = (to_index % regions_x) * region_cells;
+    uint32_t to_first_y = (to_index / regions_x) * region_cells;
+    vector<uint32_t> portal;
+
+    for (uint32_t i = 0; i < region_cells; i++) {
+        uint32_t local = 0;
+        uint32_t to_local = 0;
+
+        if (offset_x != 0) {
+            local = i * region_cells + (offset_x > 0 ? region_cells - 1 : 0);
+            to_local = i * region_cells + (offset_x > 0 ? 0 : region_cells - 1);
+        } else {
+            local = (offset_y > 0 ? region_cells - 1 : 0) * region_cells + i;
+            to_local = (offset_y > 0 ? 0 : region_cells - 1) * region_cells + i;
+        }
+
+        if (from.cell_areas[local] == from_node % region_size && to.cell_areas[to_local] == to_node % region_size) {
+            portal.push_back((to_first_y + to_local / region_cells) * cells_x + to_first_x + to_local % region_cells);
+        }
+    }
+
+    if (portal.empty()) {
+        return INVALID;
+    }
+
+    return portal[portal.size() / 2];
+}
+
+Navigation_Flow_Field* Navigation::get_flow_field (uint32_t goal_node) {
+    for (size_t i = 0; i < flow_fields.size(); i++) {
+        if (flow_fields[i]->goal_node == goal_node) {
+            flow_fields[i]->last_used = ++flow_field_use_count;
+
+            return flow_fields[i];
+        }
+    }
+
+    if (!flow_fields.empty() && flow_fields.size() >= Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT) {
+        size_t oldest = 0;
+
+        for (size_t i = 1; i < flow_fields.size(); i++) {
+            if (flow_fields[i]->last_used < flow_fields[oldest]->last_used) {
+                oldest = i;
+            }
+        }
+
+        delete flow_fields[oldest];
+        flow_fields.erase(flow_fields.begin() + oldest);
+    }
+
+    Navigation_Flow_Field* field = new Navigation_Flow_Field();
+
+    field->goal_node = goal_node;
+    field->last_used = ++flow_field_use_count;
+    field->regions.assign((regions.size() + 63) / 64, 0);
+    field->next_nodes[goal_node] = goal_node;
+    field->costs[goal_node] = 0;
+    field->open.push_back(goal_node);
+
+    flow_fields.push_back(field);
+
+    return field;
+}
+
+uint32_t Navigation::expand_flow_field (World_Map& world_map, Navigation_Flow_Field& field) {
+    Trace_Scope trace("expand_flow_field", "navigation");
+
+    // Dijkstra's algorithm outward from the goal
+    // Ties are broken by node, so the field is the same no matter how it was reached
+    pop_heap(field.open.begin(), field.open.end(), greater<uint64_t>());
+
+    uint64_t entry = field.open.back();
+    uint32_t node = (uint32_t) (entry & 0xFFFFFFFF);
+    uint32_t cost = (uint32_t) (entry >> 32);
+    uint32_t work = 1;
+
+    field.open.pop_back();
+    field.expansions++;
+
+    if (cost == field.costs[node]) {
+        work += get_neighbors(world_map, node, flow_field_neighbors, field.regions) * region_cells * region_cells;
+
+        for (size_t i = 0; i < flow_field_neighbors.size(); i++) {
+            uint32_t next_cost = cost + flow_field_neighbors[i].second;
+            unordered_map<uint32_t, uint32_t>::iterator it = field.costs.find(flow_field_neighbors[i].first);
+
+            if (it == field.costs.end() || next_cost < it->second) {
+                field.costs[flow_field_neighbors[i].first] = next_cost;
+                field.next_nodes[flow_field_neighbors[i].first] = node;
+                field.open.push_back(((uint64_t) next_cost << 32) | flow_field_neighbors[i].first);
+                push_heap(field.open.begin(), field.open.end(), greater<uint64_t>());
+            }
+        }
+    }
+
+    // Once the search is done, only the next nodes are needed
+    if (field.open.empty()) {
+        unordered_map<uint32_t, uint32_t>().swap(field.costs);
+        vector<uint64_t>().swap(field.open);
+    }
+
+    return work;
+}
+
+bool Navigation::is_settled (const Navigation_Flow_Field& field, uint32_t node) const {
+    if (field.open.empty()) {
+        return true;
+    }
+
+    unordered_map<uint32_t, uint32_t>::const_iterator it = field.costs.find(node);
+
+    // Entries come out of open in order, and every entry added later is larger, so a node is settled once its own
+    // entry is smaller than anything left
+    return it != field.costs.end() && (((uint64_t) it->second << 32) | node) < field.open.front();
+}
+
+void Navigation::delete_flow_fields () {
+    for (size_t i = 0; i < flow_fields.size(); i++) {
+        delete flow_fields[i];
+    }
+
+    flow_fields.clear();
+}
+
+uint32_t Navigation::find_path (World_Map& world_map, uint32_t from_node, uint32_t start, uint32_t target,
+                                vector<uint32_t>& waypoints) {
+    uint32_t region_size = region_cells * region_cells;
+    uint32_t region_index = from_node / region_size;
+    uint16_t area = (uint16_t) (from_node % region_size);
+    const Navigation_Region& region = get_region(world_map, region_index);
+    uint32_t first_x = (region_index % regions_x) * region_cells;
+    uint32_t first_y = (region_index / regions_x) * region_cells;
+    uint32_t target_x = target % cells_x;
+    uint32_t target_y = target / cells_x;
+    // The target may lie in the next region, so it gets the slot after the region's own cells
+    uint32_t target_local = region_size;
+    uint32_t start_local = get_region_cell(start);
+    uint32_t searched = 0;
+
+    waypoints.clear();
+
+    if (start == target) {
+        waypoints.push_back(target);
+
+        return 1;
+    }
+
+    fill(search_costs.begin(), search_costs.end(), INVALID);
+    search_open.clear();
+
+    search_costs[start_local] = 0;
+    search_parents[start_local] = INVALID;
+    search_open.push_back(((uint64_t) octile_distance(start % cells_x, start / cells_x, target_x, target_y) << 32) |
+                          start_local);
+
+    while (!search_open.empty()) {
+        pop_heap(search_open.begin(), search_open.end(), greater<uint64_t>());
+
+        uint64_t entry = search_open.back();
+        uint32_t local = (uint32_t) (entry & 0xFFFFFFFF);
+
+        search_open.pop_back();
+
+        if (local == target_local) {
+            break;
+        }
+
+        uint32_t x = first_x + local % region_cells;
+        uint32_t y = first_y + local / region_cells;
+        uint32_t cost = search_costs[local];
+
+        // Skip entries left behind when a cheaper way to the cell was found
+        if ((uint32_t) (entry >> 32) != cost + octile_distance(x, y, target_x, target_y)) {
+            continue;
+        }
+
+        searched++;
+
+        // A cell can be entered if it is in this area, or if it is the target
+        // Diagonal steps are only allowed when both of the cells beside them are open, so ships never cut corners
+        bool open[3][3];
+
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                int64_t neighbor_x = (int64_t) x + dx;
+                int64_t neighbor_y = (int64_t) y + dy;
+                bool inside = neighbor_x >= first_x && neighbor_y >= first_y &&
+                              neighbor_x < first_x + region_cells && neighbor_y < first_y + region_cells;
+
+                open[dy + 1][dx + 1] = (neighbor_x == target_x && neighbor_y == target_y) ||
+                                       (inside && region.cell_areas[(neighbor_y - first_y) * region_cells +
+                                                                    neighbor_x - first_x] == area);
+            }
+        }
+
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                if ((dx == 0 && dy == 0) || !open[dy + 1][dx + 1] ||
+                    (dx != 0 && dy != 0 && (!open[1][dx + 1] || !open[dy + 1][1]))) {
+                    continue;
+                }
+
+                uint32_t neighbor_x = x + dx;
+                uint32_t neighbor_y = y + dy;
+                uint32_t neighbor_local = neighbor_x == target_x && neighbor_y == target_y ? target_local :
+                                          (neighbor_y - first_y) * region_cells + neighbor_x - first_x;
+                uint32_t next_cost = cost + (dx != 0 && dy != 0 ? DIAGONAL_COST : STRAIGHT_COST);
+
+                if (next_cost < search_costs[neighbor_local]) {
+                    search_costs[neighbor_local] = next_cost;
+                    search_parents[neighbor_local] = local;
+                    search_open.push_back(((uint64_t) (next_cost + octile_distance(neighbor_x, neighbor_y, target_x,
+                                                                                   target_y)) << 32) |
+                                          neighbor_local);
+                    push_heap(search_open.begin(), search_open.end(), greater<uint64_t>());
+                }
+            }
+        }
+    }
+
+    if (search_costs[target_local] == INVALID) {
+        return searched;
+    }
+
+    // Walk back from the target, keeping only the cells where the path turns
+    waypoints.push_back(target);
+
+    uint32_t previous_x = target_x;
+    uint32_t previous_y = target_y;
+    int32_t direction_x = 0;
+    int32_t direction_y = 0;
+
+    for (uint32_t local = search_parents[target_local]; local != start_local; local = search_parents[local]) {
+        uint32_t x = first_x + local % region_cells;
+        uint32_t y = first_y + local / region_cells;
+        int32_t step_x = (int32_t) x - (int32_t) previous_x;
+        int32_t step_y = (int32_t) y - (int32_t) previous_y;
+
+        if (waypoints.size() > 1 && step_x == direction_x && step_y == direction_y) {
+            waypoints.back() = y * cells_x + x;
+        } else {
+            waypoints.push_back(y * cells_x + x);
+        }
+
+        direction_x = step_x;
+        direction_y = step_y;
+        previous_x = x;
+        previous_y = y;
+    }
+
+    reverse(waypoints.begin(), waypoints.end());
+
+    return searched;
+}
+
+uint32_t Navigation::plan_leg (World_Map& world_map, const Entity_Store& entities, const Entity_Handle& handle,
+                               uint32_t budget) {
+    Navigation_Agent& agent = agents[handle.index];
+    uint32_t dense = entities.get_dense(handle);
+
+    agent.waypoints.clear();
+    agent.next_waypoint = 0;
+
+    if (dense == Entity_Store::INVALID_DENSE || cells_x == 0 || cells_y == 0) {
+        agent.state = NAVIGATION_STATE_NONE;
+
+        return 1;
+    }
+
+    agent.state = NAVIGATION_STATE_FAILED;
+
+    Fixed max_x = Fixed::from_int(cells_x - 1);
+    Fixed max_y = Fixed::from_int(cells_y - 1);
+    uint32_t start = (uint32_t) Fixed::clamp(entities.y[dense] / cell_size, Fixed(), max_y).to_int() * cells_x +
+                     (uint32_t) Fixed::clamp(entities.x[dense] / cell_size, Fixed(), max_x).to_int();
+    uint32_t goal = (uint32_t) Fixed::clamp(agent.goal_y / cell_size, Fixed(), max_y).to_int() * cells_x +
+                    (uint32_t) Fixed::clamp(agent.goal_x / cell_size, Fixed(), max_x).to_int();
+
+    // A ship caught on a shoal, or a goal on land such as a port, uses the nearest open cell instead
+    if (get_node(world_map, start) == INVALID) {
+        start = find_open_cell(world_map, start);
+    }
+
+    if (start != INVALID && get_node(world_map, goal) == INVALID) {
+        goal = find_open_cell(world_map, goal);
+    }
+
+    if (start == INVALID || goal == INVALID) {
+        return 1;
+    }
+
+    uint32_t start_node = get_node(world_map, start);
+    uint32_t goal_node = get_node(world_map, goal);
+    Navigation_Flow_Field* field = get_flow_field(goal_node);
+    uint32_t work = 1;
+
+    // The field is only built as far as this ship needs for now
+    while (!is_settled(*field, start_node) && work < budget) {
+        work += expand_flow_field(world_map, *field);
+    }
+
+    if (!is_settled(*field, start_node)) {
+        agent.state = NAVIGATION_STATE_QUEUED;
+
+        return work;
+    }
+
+    unordered_map<uint32_t, uint32_t>::const_iterator next = field->next_nodes.find(start_node);
+
+    if (next == field->next_nodes.end()) {
+        return work;
+    }
+
+    uint32_t target = goal;
+
+    agent.final_leg = start_node == goal_node;
+
+    if (!agent.final_leg) {
+        target = get_portal(world_map, start_node, next->second);
+    }
+
+    uint32_t searched = find_path(world_map, start_node, start, target, agent.waypoints);
+
+    if (!agent.waypoints.empty()) {
+        agent.state = NAVIGATION_STATE_FOLLOWING;
+    }
+
+    return searched + work;
+}
+
+void Navigation::invalidate_changed_regions (World_Map& world_map) {
+    changed_chunks.clear();
+    world_map.take_changed_chunks(changed_chunks);
+
+    if (changed_chunks.empty()) {
+        return;
+    }
+
+    vector<uint64_t> changed_regions((regions.size() + 63) / 64, 0);
+    uint32_t chunks_x = world_map.get_chunks_x();
+
+    // Regions are exactly chunk sized, so each changed chunk is one changed region
+    for (size_t i = 0; i < changed_chunks.size(); i++) {
+        uint32_t region_x = changed_chunks[i] % chunks_x;
+        uint32_t region_y = changed_chunks[i] / chunks_x;
+
+        if (region_x < regions_x && region_y < regions_y) {
+            uint32_t region_index = region_y * regions_x + region_x;
+
+            regions[region_index] = Navigation_Region();
+            changed_regions[region_index / 64] |= (uint64_t) 1 << (region_index % 64);
+        }
+    }
+
+    for (size_t i = 0; i < flow_fields.size();) {
+        bool affected = false;
+
+        for (size_t n = 0; n < changed_regions.size() && !affected; n++) {
+            affected = (flow_fields[i]->regions[n] & changed_regions[n]) != 0;
+        }
+
+        if (affected) {
+            delete flow_fields[i];
+            flow_fields.erase(flow_fields.begin() + i);
+        } else {
+            i++;
+        }
+    }
+
+    // Ships whose current leg crosses a changed region plan it again
+    for (uint32_t i = 0; i < agents.size(); i++) {
+        Navigation_Agent& agent = agents[i];
+
+        if (agent.state != NAVIGATION_STATE_FOLLOWING) {
+            continue;
+        }
+
+        for (size_t n = agent.next_waypoint; n < agent.waypoints.size(); n++) {
+            uint32_t region_index = get_region_index(agent.waypoints[n]);
+
+            if ((changed_regions[region_index / 64] >> (region_index % 64)) & 1) {
+                enqueue(Entity_Handle(i, agent.generation));
+
+                break;
+            }
+        }
+    }
+}
+
+void Navigation::enqueue (const Entity_Handle& handle) {
+    Navigation_Agent& agent = agents[handle.index];
+
+    agent.state = NAVIGATION_STATE_QUEUED;
+
+    if (!agent.in_queue) {
+        agent.in_queue = true;
+        queue.push_back(handle);
+    }
+}
+
+void Navigation::set_goal (const Entity_Handle& handle, const Fixed& x, const Fixed& y) {
+    if (handle.index >= agents.size()) {
+        agents.resize(handle.index + 1);
+    }
+
+    Navigation_Agent& agent = agents[handle.index];
+
+    // A stale queue entry for a previous entity in this slot is skipped when it comes up, since its generation
+    // no longer matches
+    if (agent.generation != handle.generation) {
+        agent = Navigation_Agent();
+        agent.generation = handle.generation;
+    }
+
+    agent.goal_x = x;
+    agent.goal_y = y;
+    agent.waypoints.clear();
+    agent.next_waypoint = 0;
+
+    enqueue(handle);
+}
+
+void Navigation::stop (const Entity_Handle& handle) {
+    if (handle.index < agents.size() && agents[handle.index].generation == handle.generation) {
+        agents[handle.index].state = NAVIGATION_STATE_NONE;
+        agents[handle.index].waypoints.clear();
+    }
+}
+
+void Navigation::remove (const Entity_Handle& handle) {
+    if (handle.index < agents.size() && agents[handle.index].generation == handle.generation) {
+        bool in_queue = agents[handle.index].in_queue;
+
+        agents[handle.index] = Navigation_Agent();
+        agents[handle.index].generation = handle.generation;
+        agents[handle.index].in_queue = in_queue;
+    }
+}
+
+void Navigation::update (World_Map& world_map, const Entity_Store& entities) {
+    Trace_Scope trace("navigation", "navigation");
+
+    invalidate_changed_regions(world_map);
+
+    Fixed radius = Fixed::from_double(Game_Constants::NAVIGATION_WAYPOINT_RADIUS);
+    Fixed radius_squared = radius * radius;
+
+    for (uint32_t i = 0; i < agents.size(); i++) {
+        Navigation_Agent& agent = agents[i];
+
+        if (agent.state != NAVIGATION_STATE_FOLLOWING) {
+            continue;
+        }
+
+        Entity_Handle handle(i, agent.generation);
+        uint32_t dense = entities.get_dense(handle);
+
+        if (dense == Entity_Store::INVALID_DENSE) {
+            agent.state = NAVIGATION_STATE_NONE;
+
+            continue;
+        }
+
+        uint32_t waypoint = agent.waypoints[agent.next_waypoint];
+        Fixed dx = cell_size * Fixed::from_int(waypoint % cells_x) + cell_size / Fixed::from_int(2) - entities.x[dense];
+        Fixed dy = cell_size * Fixed::from_int(waypoint / cells_x) + cell_size / Fixed::from_int(2) - entities.y[dense];
+
+        if (dx * dx + dy * dy <= radius_squared && ++agent.next_waypoint >= agent.waypoints.size()) {
+            if (agent.final_leg) {
+                agent.state = NAVIGATION_STATE_ARRIVED;
+                agent.waypoints.clear();
+            } else {
+                enqueue(handle);
+            }
+        }
+    }
+
+    uint32_t work = 0;
+
+    while (queue_start < queue.size() && work < Game_Constants::NAVIGATION_WORK_PER_TICK) {
+        Entity_Handle handle = queue[queue_start++];
+        Navigation_Agent& agent = agents[handle.index];
+
+        if (agent.generation == handle.generation) {
+            agent.in_queue = false;
+
+            if (agent.state == NAVIGATION_STATE_QUEUED) {
+                work += plan_leg(world_map, entities, handle, Game_Constants::NAVIGATION_WORK_PER_TICK - work);
+
+                // The tick's work ran out before the ship's flow field was far enough along, so it waits at the front
+                // of the queue
+                if (agent.state == NAVIGATION_STATE_QUEUED) {
+                    agent.in_queue = true;
+                    queue_start--;
+
+                    break;
+                }
+            }
+        }
+    }
+
+    if (queue_start == queue.size()) {
+        queue.clear();
+        queue_start = 0;
+    } else if (queue_start > queue.size() / 2) {
+        queue.erase(queue.begin(), queue.begin() + queue_start);
+        queue_start = 0;
+    }
+}
+
+Navigation_State Navigation::get_target (const Entity_Handle& handle, Fixed& x, Fixed& y) const {
+    if (handle.index >= agents.size() || agents[handle.index].generation != handle.generation) {
+        return NAVIGATION_STATE_NONE;
+    }
+
+    const Navigation_Agent& agent = agents[handle.index];
+
+    if (agent.state == NAVIGATION_STATE_FOLLOWING) {
+        uint32_t waypoint = agent.waypoints[agent.next_waypoint];
+
+        x = cell_size * Fixed::from_int(waypoint % cells_x) + cell_size / Fixed::from_int(2);
+        y = cell_size * Fixed::from_int(waypoint / cells_x) + cell_size / Fixed::from_int(2);
+    }
+
+    return agent.state;
+}
+
+uint32_t Navigation::get_queue_length () const {
+    return queue.size() - queue_start;
+}
+
+uint32_t Navigation::get_flow_field_count () const {
+    return flow_fields.size();
+}
+
+void Navigation::write (RakNet::BitStream& bitstream) const {
+    uint32_t agent_count = 0;
+
+    for (uint32_t i = 0; i < agents.size(); i++) {
+        if (agents[i].state != NAVIGATION_STATE_NONE) {
+            agent_count++;
+        }
+    }
+
+    bitstream.WriteCompressed(agent_count);
+
+    for (uint32_t i = 0; i < agents.size(); i++) {
+        const Navigation_Agent& agent = agents[i];
+
+        if (agent.state == NAVIGATION_STATE_NONE) {
+            continue;
+        }
+
+        bitstream.WriteCompressed(i);
+        bitstream.WriteCompressed(agent.generation);
+        bitstream.Write((uint8_t) agent.state);
+        bitstream.Write(agent.goal_x.raw);
+        bitstream.Write(agent.goal_y.raw);
+        bitstream.WriteCompressed((uint32_t) agent.waypoints.size());
+
+        for (size_t n = 0; n < agent.waypoints.size(); n++) {
+            bitstream.WriteCompressed(agent.waypoints[n]);
+        }
+
+        bitstream.WriteCompressed(agent.next_waypoint);
+        bitstream.Write(agent.final_leg);
+    }
+
+    bitstream.WriteCompressed(get_queue_length());
+
+    for (size_t i = queue_start; i < queue.size(); i++) {
+        bitstream.WriteCompressed(queue[i].index);
+        bitstream.WriteCompressed(queue[i].generation);
+    }
+
+    bitstream.Write(flow_field_use_count);
+    bitstream.WriteCompressed((uint32_t) flow_fields.size());
+
+    for (size_t i = 0; i < flow_fields.size(); i++) {
+        bitstream.WriteCompressed(flow_fields[i]->goal_node);
+        bitstream.Write(flow_fields[i]->last_used);
+        bitstream.WriteCompressed(flow_fields[i]->expansions);
+    }
+}
+
+bool Navigation::read (World_Map& world_map, RakNet::BitStream& bitstream) {
+    clear();
+
+    uint32_t agent_count = 0;
+
+    if (!bitstream.ReadCompressed(agent_count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < agent_count; i++) {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+        uint8_t state = 0;
+        Fixed goal_x;
+        Fixed goal_y;
+        uint32_t waypoint_count = 0;
+
+        if (!bitstream.ReadCompressed(index) || !bitstream.ReadCompressed(generation) || !bitstream.Read(state) ||
+            !bitstream.Read(goal_x.raw) || !bitstream.Read(goal_y.raw) || !bitstream.ReadCompressed(waypoint_count) ||
+            (index < agents.size() && agents[index].state != NAVIGATION_STATE_NONE) ||
+            state == NAVIGATION_STATE_NONE || state > NAVIGATION_STATE_FAILED ||
+            waypoint_count > region_cells * region_cells + 1) {
+            return false;
+        }
+
+        if (index >= agents.size()) {
+            agents.resize(index + 1);
+        }
+
+        Navigation_Agent& agent = agents[index];
+
+        agent.generation = generation;
+        agent.state = (Navigation_State) state;
+        agent.goal_x = goal_x;
+        agent.goal_y = goal_y;
+        agent.waypoints.resize(waypoint_count);
+
+        for (uint32_t n = 0; n < waypoint_count; n++) {
+            if (!bitstream.ReadCompressed(agent.waypoints[n]) || agent.waypoints[n] >= cells_x * cells_y) {
+                return false;
+            }
+        }
+
+        if (!bitstream.ReadCompressed(agent.next_waypoint) || !bitstream.Read(agent.final_leg) ||
+            (agent.state == NAVIGATION_STATE_FOLLOWING && agent.next_waypoint >= waypoint_count)) {
+            return false;
+        }
+    }
+
+    uint32_t queue_length = 0;
+
+    if (!bitstream.ReadCompressed(queue_length)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < queue_length; i++) {
+        Entity_Handle handle;
+
+        if (!bitstream.ReadCompressed(handle.index) || !bitstream.ReadCompressed(handle.generation)) {
+            return false;
+        }
+
+        if (handle.index >= agents.size()) {
+            agents.resize(handle.index + 1);
+        }
+
+        // Entries for entities that have since been removed are kept, so that the queue is served exactly as it
+        // would have been
+        if (agents[handle.index].generation == handle.generation) {
+            agents[handle.index].in_queue = true;
+        }
+
+        queue.push_back(handle);
+    }
+
+    uint64_t use_count = 0;
+    uint32_t field_count = 0;
+    uint32_t region_size = region_cells * region_cells;
+
+    if (!bitstream.Read(use_count) || !bitstream.ReadCompressed(field_count) ||
+        field_count > max(Game_Constants::NAVIGATION_FLOW_FIELD_LIMIT, (uint32_t) 1)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < field_count; i++) {
+        uint32_t goal_node = 0;
+        uint64_t last_used = 0;
+        uint32_t expansions = 0;
+
+        if (!bitstream.ReadCompressed(goal_node) || !bitstream.Read(last_used) ||
+            !bitstream.ReadCompressed(expansions) || goal_node / region_size >= regions.size() ||
+            goal_node % region_size >= get_region(world_map, goal_node / region_size).area_centers.size() ||
+            last_used > use_count) {
+            return false;
+        }
+
+        Navigation_Flow_Field* field = get_flow_field(goal_node);
+
+        // A second field for the same goal would have been handed the first one
+        if (flow_fields.size() != i + 1) {
+            return false;
+        }
+
+        // The tiles are the same as when the field was built, so the same steps build the same field
+        while (field->expansions < expansions) {
+            if (field->open.empty()) {
+                return false;
+            }
+
+            expand_flow_field(world_map, *field);
+        }
+
+        field->last_used = last_used;
+    }
+
+    flow_field_use_count = use_count;
+
+    return true;
+}
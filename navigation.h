@@ -0,0 +1,193 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef navigation_h
+#define navigation_h
+
+#include "world_map.h"
+#include "entity_store.h"
+#include "fixed.h"
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+enum Navigation_State : uint8_t {
+    NAVIGATION_STATE_NONE,
+    // Waiting for the service to plan the next leg of the route
+    NAVIGATION_STATE_QUEUED,
+    NAVIGATION_STATE_FOLLOWING,
+    NAVIGATION_STATE_ARRIVED,
+    // The goal cannot be reached from where the ship is
+    NAVIGATION_STATE_FAILED
+};
+
+// A square region of navigation cells, split into areas of cells that can all reach each other without leaving it
+class Navigation_Region {
+    public:
+        bool built;
+        // Indexed by cell within the region, row by row, holding the cell's area or Navigation::BLOCKED
+        std::vector<uint16_t> cell_areas;
+        // The cell nearest to the middle of each area, as a world cell index
+        std::vector<uint32_t> area_centers;
+
+        Navigation_Region ();
+};
+
+// For one goal, the next area to head for from every area that can reach it
+// A field is built a little at a time, outward from the goal, and its next areas are final once they are settled
+class Navigation_Flow_Field {
+    public:
+        uint32_t goal_node;
+        // Keyed by node
+        std::unordered_map<uint32_t, uint32_t> next_nodes;
+        // One bit per region the field has read, so that it can be dropped when one of them changes
+        std::vector<uint64_t> regions;
+        uint64_t last_used;
+
+        // The search, which is only kept until the field is complete
+        // Keyed by node
+        std::unordered_map<uint32_t, uint32_t> costs;
+        std::vector<uint64_t> open;
+        // The number of entries taken from open so far, which is enough to build the field again to the same point
+        uint32_t expansions;
+
+        Navigation_Flow_Field ();
+};
+
+class Navigation_Agent {
+    public:
+        uint32_t generation;
+        Navigation_State state;
+        Fixed goal_x;
+        Fixed goal_y;
+        // World cell indices of the current leg, ending at the next area or at the goal
+        std::vector<uint32_t> waypoints;
+        uint32_t next_waypoint;
+        // True if the current leg ends at the goal
+        bool final_leg;
+        bool in_queue;
+
+        Navigation_Agent ();
+};
+
+// Plans routes for ships around land and shoals
+// The water is divided into cells of a few tiles each, the cells into regions, and each region into areas
+// A route is found in two levels: a flow field over the areas of every region, built once per goal and shared by every
+// ship heading there, picks the next area, and a search limited to the ship's current area finds the path to it
+// Ships queue for each leg of their route, and the queue is served up to a fixed amount of work per tick
+// Building a flow field counts toward that work, so a ship whose field is not yet built as far as it needs keeps its
+// place at the front of the queue until later ticks finish the job
+// The regions are a cache that never changes the routes, but the flow fields decide when ships get their legs, so
+// they are saved with the agents, and every peer plans the same routes on the same ticks
+// Nothing in the game sets goals yet, since the game creates no ships of its own, so for now the benchmark is the
+// only caller of set_goal
+class Navigation {
+    private:
+        uint32_t cell_tiles;
+        Fixed cell_size;
+        uint32_t cells_x;
+        uint32_t cells_y;
+        uint32_t region_cells;
+        uint32_t regions_x;
+        uint32_t regions_y;
+
+        std::vector<Navigation_Region> regions;
+        std::vector<Navigation_Flow_Field*> flow_fields;
+        uint64_t flow_field_use_count;
+
+        // Indexed by entity handle index
+        std::vector<Navigation_Agent> agents;
+        // Agents waiting for their next leg, first come first served
+        std::vector<Entity_Handle> queue;
+        uint32_t queue_start;
+
+        // Reused by every search
+        std::vector<uint32_t> search_costs;
+        std::vector<uint32_t> search_parents;
+        std::vector<uint64_t> search_open;
+        std::vector<std::pair<uint32_t, uint32_t>> flow_field_neighbors;
+        std::vector<uint32_t> changed_chunks;
+
+        uint32_t get_region_index(uint32_t cell) const;
+        uint32_t get_region_cell(uint32_t cell) const;
+        bool is_cell_water(World_Map& world_map, uint32_t cell_x, uint32_t cell_y) const;
+        Navigation_Region& get_region(World_Map& world_map, uint32_t region_index);
+        void build_region(World_Map& world_map, uint32_t region_index);
+        // Returns INVALID if the cell is land or outside of the world
+        uint32_t get_node(World_Map& world_map, uint32_t cell);
+        // Returns the nearest open cell within the cell's region, or INVALID if the region has none
+        uint32_t find_open_cell(World_Map& world_map, uint32_t cell);
+        // Adds each neighboring node along with the cost of moving to it
+        // Sets the bit in read_regions of every region looked at, and returns how many of those bits were not set yet
+        uint32_t get_neighbors(World_Map& world_map, uint32_t node,
+                               std::vector<std::pair<uint32_t, uint32_t>>& neighbors,
+                               std::vector<uint64_t>& read_regions);
+        // Returns the first cell past the middle of the border between two neighboring nodes
+        uint32_t get_portal(World_Map& world_map, uint32_t from_node, uint32_t to_node);
+
+        // Starts a new field for a goal that has none, without building any of it
+        Navigation_Flow_Field* get_flow_field(uint32_t goal_node);
+        // Settles the next node of the field's search
+        // Returns the work spent, where each region the field reads for the first time costs as much as searching
+        // all of its cells
+        uint32_t expand_flow_field(World_Map& world_map, Navigation_Flow_Field& field);
+        // True once the node's next area can no longer change, or the field is complete
+        bool is_settled(const Navigation_Flow_Field& field, uint32_t node) const;
+        void delete_flow_fields();
+        // Finds a path within from_node's area from start to target, which may be just outside of the area
+        // Returns the number of cells searched
+        uint32_t find_path(World_Map& world_map, uint32_t from_node, uint32_t start, uint32_t target,
+                           std::vector<uint32_t>& waypoints);
+        // Spends no more than about budget building the ship's flow field, and leaves the ship queued if that is not
+        // enough
+        // Returns the amount of work spent
+        uint32_t plan_leg(World_Map& world_map, const Entity_Store& entities, const Entity_Handle& handle,
+                          uint32_t budget);
+
+        void enqueue(const Entity_Handle& handle);
+
+    public:
+        static const uint32_t INVALID;
+        static const uint16_t BLOCKED;
+
+        Navigation ();
+        ~Navigation ();
+
+        // Forgets every route and starts over for the passed world
+        void setup(const World_Map& world_map);
+        void clear();
+
+        // Sends a ship toward a point in the world
+        void set_goal(const Entity_Handle& handle, const Fixed& x, const Fixed& y);
+        void stop(const Entity_Handle& handle);
+        // Call this for every entity that is destroyed
+        void remove(const Entity_Handle& handle);
+
+        // Advances ships that have reached their waypoints, and plans queued legs until the tick's work runs out
+        // Call this once per tick, before anything reads the waypoints
+        void update(World_Map& world_map, const Entity_Store& entities);
+        // Drops whatever was derived from tiles changed since the last call, and sends ships whose leg crosses them
+        // back to the queue
+        // update does this first, but call it again at the end of each tick, so that no keyframe is written while
+        // changes are waiting to be seen
+        void invalidate_changed_regions(World_Map& world_map);
+
+        // Returns the ship's state, along with the point it should steer toward when it is following a route
+        // Safe to call from several threads at once
+        Navigation_State get_target(const Entity_Handle& handle, Fixed& x, Fixed& y) const;
+
+        uint32_t get_queue_length() const;
+        uint32_t get_flow_field_count() const;
+
+        // Saves and restores every agent, the queue, and how far each flow field has been built
+        // The fields themselves are built again on reading, so read this once the changed tiles have been restored
+        void write(RakNet::BitStream& bitstream) const;
+        // Returns false if the data is malformed
+        bool read(World_Map& world_map, RakNet::BitStream& bitstream);
+};
+
+#endif
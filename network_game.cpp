@@ -3,15 +3,482 @@
 /* See the file docs/LICENSE.txt for the full license text. */
 
 #include "network_game.h"
+#include "game.h"
+#include "game_constants.h"
+#include "trace_profiler.h"
+#include "bit_codec.h"
+
+#include <log.h>
+#include <engine_strings.h>
+#include <network_engine.h>
+#include <game_manager.h>
 
 using namespace std;
 
+namespace {
+    // Marks a server entity that has no local counterpart
+    const Entity_Handle UNMAPPED_HANDLE(Entity_Store::INVALID_DENSE, 0);
+}
+
+Client_Replication::Client_Replication () {
+    acked_tick = 0;
+}
+
+void Client_Commands::add (const vector<Player_Command>& commands) {
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].id == Command_Ids::VIEW) {
+            view = commands[i].arguments;
+        }
+
+        buffer.push_back(commands[i]);
+    }
+}
+
+uint64_t Network_Game::last_reported_tick = 0;
+map<uint64_t, uint64_t> Network_Game::first_desync_ticks;
+map<uint64_t, Client_Replication> Network_Game::client_replication;
+RakNet::BitStream Network_Game::snapshot_packet;
+map<uint64_t, Client_Commands> Network_Game::client_commands;
+vector<uint64_t> Network_Game::player_ids;
+Snapshot_History Network_Game::client_snapshots;
+Snapshot Network_Game::decoded_snapshot;
+uint64_t Network_Game::last_applied_tick = 0;
+vector<Entity_Handle> Network_Game::remote_handles;
+vector<uint32_t> Network_Game::remote_generations;
+Command_State_Set Network_Game::local_command_states;
+Command_State_Set Network_Game::sent_command_states;
+vector<Player_Command> Network_Game::local_command_buffer;
+vector<Fixed> Network_Game::sent_view;
+
+void Network_Game::reset_desync_detection () {
+    last_reported_tick = 0;
+    first_desync_ticks.clear();
+}
+
+uint64_t Network_Game::get_first_desync_tick (uint32_t client) {
+    if (client >= Network_Engine::clients.size()) {
+        return 0;
+    }
+
+    map<uint64_t, uint64_t>::const_iterator tick = first_desync_ticks.find(Network_Engine::clients[client].id.g);
+
+    return tick != first_desync_ticks.end() ? tick->second : 0;
+}
+
+void Network_Game::reset_replication () {
+    client_replication.clear();
+
+    client_snapshots.clear();
+    decoded_snapshot.entities.clear();
+    last_applied_tick = 0;
+    remote_handles.clear();
+    remote_generations.clear();
+}
+
+void Network_Game::reset_commands () {
+    client_commands.clear();
+    player_ids.clear();
+
+    local_command_states.clear();
+    sent_command_states.clear();
+    local_command_buffer.clear();
+    sent_view.clear();
+}
+
+void Network_Game::clear_command_states () {
+    local_command_states.clear();
+}
+
+void Network_Game::set_command_state (uint32_t command) {
+    local_command_states.set(command);
+}
+
+void Network_Game::add_command (const Player_Command& command) {
+    if (command.id < Command_Ids::MAX_COMMANDS && command.arguments.size() <= Command_Ids::MAX_ARGUMENTS) {
+        local_command_buffer.push_back(command);
+    }
+}
+
+void Network_Game::send_commands () {
+    // The view decides which ships think on each tick, so it enters the simulation as a command
+    // Rendering state never feeds back into the simulation, so the view can be converted from floating point
+    double zoom = Game_Manager::camera_zoom;
+    vector<Fixed> view;
+
+    view.push_back(Fixed::from_double(Game_Manager::camera.x / zoom));
+    view.push_back(Fixed::from_double(Game_Manager::camera.y / zoom));
+    view.push_back(Fixed::from_double(Game_Manager::camera.w / zoom));
+    view.push_back(Fixed::from_double(Game_Manager::camera.h / zoom));
+
+    if (view != sent_view) {
+        add_command(Player_Command(Command_Ids::VIEW, view));
+
+        sent_view = view;
+    }
+
+    if (Network_Engine::status == "server") {
+        Client_Commands& own_commands = client_commands[Network_Engine::peer->GetMyGUID().g];
+
+        own_commands.states = local_command_states;
+        own_commands.add(local_command_buffer);
+    } else if (Network_Engine::status == "client") {
+        // Held commands only change occasionally, so nothing is sent while the input is unchanged
+        if (local_command_states == sent_command_states && local_command_buffer.empty()) {
+            return;
+        }
+
+        RakNet::BitStream bitstream;
+
+        bitstream.Write((RakNet::MessageID) ID_GAME_COMMANDS);
+
+        local_command_states.write(bitstream);
+
+        Bit_Codec::write_varint(bitstream, local_command_buffer.size());
+
+        for (size_t i = 0; i < local_command_buffer.size(); i++) {
+            local_command_buffer[i].write(bitstream);
+        }
+
+        // States are only sent when they change, so they must all arrive
+        Network_Engine::peer->Send(&bitstream, HIGH_PRIORITY, RELIABLE_ORDERED, ORDERING_CHANNEL_COMMANDS,
+                                   Network_Engine::server_id, false);
+
+        sent_command_states = local_command_states;
+    }
+
+    local_command_buffer.clear();
+}
+
+void Network_Game::read_commands (RakNet::Packet* packet) {
+    RakNet::BitStream bitstream(packet->data, packet->length, false);
+    Command_State_Set states;
+    uint64_t command_count = 0;
+
+    bitstream.IgnoreBytes(sizeof(RakNet::MessageID));
+
+    if (!states.read(bitstream) || !Bit_Codec::read_varint(bitstream, command_count) ||
+        command_count > Command_Ids::MAX_COMMANDS) {
+        Log::add_error("Error reading commands");
+
+        return;
+    }
+
+    vector<Player_Command> buffer(command_count);
+
+    for (size_t i = 0; i < buffer.size(); i++) {
+        if (!buffer[i].read(bitstream)) {
+            Log::add_error("Error reading commands");
+
+            return;
+        }
+    }
+
+    // Nothing from a malformed packet is applied, so the client's states are never left half updated
+    Client_Commands& commands = client_commands[packet->guid.g];
+
+    commands.states = states;
+    commands.add(buffer);
+}
+
+bool Network_Game::get_command_state (uint32_t client, uint32_t command) {
+    if (client >= Network_Engine::clients.size()) {
+        return false;
+    }
+
+    map<uint64_t, Client_Commands>::const_iterator commands = client_commands.find(
+        Network_Engine::clients[client].id.g);
+
+    return commands != client_commands.end() && commands->second.states.get(command);
+}
+
+Command_State_Set Network_Game::get_command_states (uint32_t client) {
+    if (client >= Network_Engine::clients.size()) {
+        return Command_State_Set();
+    }
+
+    map<uint64_t, Client_Commands>::const_iterator commands = client_commands.find(
+        Network_Engine::clients[client].id.g);
+
+    return commands != client_commands.end() ? commands->second.states : Command_State_Set();
+}
+
+void Network_Game::take_commands (uint32_t client, vector<Player_Command>& commands) {
+    commands.clear();
+
+    if (client < Network_Engine::clients.size()) {
+        map<uint64_t, Client_Commands>::iterator client_entry = client_commands.find(
+            Network_Engine::clients[client].id.g);
+
+        if (client_entry != client_commands.end()) {
+            commands.swap(client_entry->second.buffer);
+        }
+    }
+}
+
+void Network_Game::take_player_changes (vector<pair<uint32_t, Player_Command>>& changes) {
+    changes.clear();
+
+    // Players past the end of the list have gone
+    for (size_t i = Network_Engine::clients.size(); i < player_ids.size(); i++) {
+        changes.push_back(make_pair((uint32_t) i, Player_Command(Command_Ids::LEAVE)));
+    }
+
+    if (player_ids.size() > Network_Engine::clients.size()) {
+        player_ids.resize(Network_Engine::clients.size());
+    }
+
+    for (size_t i = 0; i < Network_Engine::clients.size(); i++) {
+        uint64_t id = Network_Engine::clients[i].id.g;
+
+        if (i < player_ids.size() && player_ids[i] == id) {
+            continue;
+        }
+
+        // Another client had this player until now, and its view goes with it
+        if (i < player_ids.size()) {
+            changes.push_back(make_pair((uint32_t) i, Player_Command(Command_Ids::LEAVE)));
+
+            player_ids[i] = id;
+        } else {
+            player_ids.push_back(id);
+        }
+
+        map<uint64_t, Client_Commands>::const_iterator commands = client_commands.find(id);
+
+        if (commands != client_commands.end() && !commands->second.view.empty()) {
+            changes.push_back(make_pair((uint32_t) i, Player_Command(Command_Ids::VIEW, commands->second.view)));
+        }
+    }
+}
+
+void Network_Game::send_snapshots () {
+    Trace_Scope trace("send_snapshots", "network");
+
+    // Tick 0 is reserved to mean no baseline
+    uint64_t tick = Game::current_tick + 1;
+    Fixed enter_margin = Fixed::from_double(Game_Constants::INTEREST_ENTER_MARGIN);
+    Fixed exit_margin = Fixed::from_double(Game_Constants::INTEREST_EXIT_MARGIN);
+    RakNet::RakNetGUID own_id = Network_Engine::peer->GetMyGUID();
+
+    for (size_t i = 0; i < Network_Engine::clients.size(); i++) {
+        // The server's own client entry never receives updates
+        if (Network_Engine::clients[i].id == own_id) {
+            continue;
+        }
+
+        Client_Replication& client = client_replication[Network_Engine::clients[i].id.g];
+
+        // The world only changes once per tick, so there is nothing new to send until the next tick
+        if (client.snapshots.find(tick) != 0) {
+            continue;
+        }
+
+        // The view arrives as a view command, the same one that enters the simulation
+        map<uint64_t, Client_Commands>::const_iterator commands = client_commands.find(Network_Engine::clients[i].id.g);
+
+        if (commands != client_commands.end() && commands->second.view.size() == 4) {
+            const vector<Fixed>& view = commands->second.view;
+
+            client.interest.set_view(view[0], view[1], view[2], view[3]);
+        }
+
+        client.interest.update(Game::spatial_grid, Game::entities, enter_margin, exit_margin);
+
+        Snapshot& current = client.snapshots.add(tick);
+
+        current.capture(tick, Game::entities, client.interest.indices);
+
+        // An entity that entered interest since the baseline is not in the baseline, so it is sent in full,
+        // and one that left is not in the current snapshot, so the client removes it
+        const Snapshot* baseline = client.acked_tick != 0 ? client.snapshots.find(client.acked_tick) : 0;
+
+        snapshot_packet.Reset();
+        snapshot_packet.Write((RakNet::MessageID) ID_GAME_SNAPSHOT);
+
+        Snapshot_Codec::write(snapshot_packet, baseline, current);
+
+        Network_Engine::peer->Send(&snapshot_packet, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, ORDERING_CHANNEL_SNAPSHOT,
+                                   Network_Engine::clients[i].id, false);
+    }
+
+    // Forget clients that have disconnected
+    for (map<uint64_t, Client_Replication>::iterator it = client_replication.begin();
+         it != client_replication.end();) {
+        bool connected = false;
+
+        for (size_t i = 0; i < Network_Engine::clients.size() && !connected; i++) {
+            connected = Network_Engine::clients[i].id.g == it->first;
+        }
+
+        if (connected) {
+            ++it;
+        } else {
+            client_replication.erase(it++);
+        }
+    }
+
+    for (map<uint64_t, Client_Commands>::iterator it = client_commands.begin(); it != client_commands.end();) {
+        bool connected = false;
+
+        for (size_t i = 0; i < Network_Engine::clients.size() && !connected; i++) {
+            connected = Network_Engine::clients[i].id.g == it->first;
+        }
+
+        if (connected) {
+            ++it;
+        } else {
+            client_commands.erase(it++);
+        }
+    }
+
+    for (map<uint64_t, uint64_t>::iterator it = first_desync_ticks.begin(); it != first_desync_ticks.end();) {
+        bool connected = false;
+
+        for (size_t i = 0; i < Network_Engine::clients.size() && !connected; i++) {
+            connected = Network_Engine::clients[i].id.g == it->first;
+        }
+
+        if (connected) {
+            ++it;
+        } else {
+            first_desync_ticks.erase(it++);
+        }
+    }
+}
+
+void Network_Game::read_snapshot (RakNet::BitStream& bitstream) {
+    Trace_Scope trace("read_snapshot", "network");
+
+    uint64_t tick = 0;
+    uint64_t baseline_tick = 0;
+
+    if (!Snapshot_Codec::read_header(bitstream, tick, baseline_tick)) {
+        Log::add_error("Error reading snapshot header");
+
+        return;
+    }
+
+    // Snapshots are unreliable, so an older one can arrive after a newer one
+    if (tick <= last_applied_tick) {
+        return;
+    }
+
+    const Snapshot* baseline = 0;
+
+    if (baseline_tick != 0) {
+        baseline = client_snapshots.find(baseline_tick);
+
+        // The server only encodes against snapshots this client has acknowledged, so this should never happen
+        if (baseline == 0) {
+            Log::add_error("Missing baseline snapshot for tick " + Strings::num_to_string(baseline_tick));
+
+            return;
+        }
+    }
+
+    if (!Snapshot_Codec::read(bitstream, baseline, decoded_snapshot)) {
+        Log::add_error("Error reading snapshot for tick " + Strings::num_to_string(tick));
+
+        return;
+    }
+
+    Snapshot& stored = client_snapshots.add(tick);
+
+    stored.entities.swap(decoded_snapshot.entities);
+
+    last_applied_tick = tick;
+
+    apply_snapshot(stored);
+    send_snapshot_ack(tick);
+}
+
+void Network_Game::apply_snapshot (const Snapshot& snapshot) {
+    Trace_Scope trace("apply_snapshot", "network");
+
+    size_t position = 0;
+
+    for (uint32_t index = 0; index < remote_handles.size(); index++) {
+        while (position < snapshot.entities.size() && snapshot.entities[position].index < index) {
+            position++;
+        }
+
+        bool present = position < snapshot.entities.size() && snapshot.entities[position].index == index &&
+                       snapshot.entities[position].generation == remote_generations[index];
+
+        // The entity is gone, or its server slot now holds a different entity
+        if (!present && remote_handles[index] != UNMAPPED_HANDLE) {
+            Game::entities.queue_destroy(remote_handles[index]);
+            remote_handles[index] = UNMAPPED_HANDLE;
+        }
+    }
+
+    Game::destroy_queued_entities();
+
+    for (size_t i = 0; i < snapshot.entities.size(); i++) {
+        const Entity_Snapshot& entity = snapshot.entities[i];
+
+        if (entity.index >= remote_handles.size()) {
+            remote_handles.resize(entity.index + 1, UNMAPPED_HANDLE);
+            remote_generations.resize(entity.index + 1, 0);
+        }
+
+        uint32_t dense = Game::entities.get_dense(remote_handles[entity.index]);
+
+        if (dense == Entity_Store::INVALID_DENSE) {
+            remote_handles[entity.index] = Game::create_entity((Entity_Type) entity.type, Fixed(), Fixed());
+            remote_generations[entity.index] = entity.generation;
+            dense = Game::entities.get_dense(remote_handles[entity.index]);
+        }
+
+        for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+            Snapshot::apply_field(Game::entities, dense, field, entity.fields[field]);
+        }
+
+        Game::spatial_grid.update(remote_handles[entity.index].index, Game::entities.x[dense],
+                                  Game::entities.y[dense]);
+    }
+}
+
+void Network_Game::send_snapshot_ack (uint64_t tick) {
+    RakNet::BitStream bitstream;
+
+    bitstream.Write((RakNet::MessageID) ID_GAME_SNAPSHOT_ACK);
+    bitstream.WriteCompressed(tick);
+
+    Network_Engine::peer->Send(&bitstream, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, ORDERING_CHANNEL_SNAPSHOT_ACK,
+                               Network_Engine::server_id, false);
+}
+
 bool Network_Game::receive_game_packet (RakNet::Packet* packet, const RakNet::MessageID& packet_id) {
-    /**if(packet_id==ID_GAME_EXAMPLE){
-        ///Do something with this packet
+    if (packet_id == ID_GAME_SNAPSHOT) {
+        RakNet::BitStream bitstream(packet->data, packet->length, false);
+
+        bitstream.IgnoreBytes(sizeof(RakNet::MessageID));
+
+        read_snapshot(bitstream);
 
         return true;
-       }*/
+    } else if (packet_id == ID_GAME_COMMANDS) {
+        read_commands(packet);
+
+        return true;
+    } else if (packet_id == ID_GAME_SNAPSHOT_ACK) {
+        map<uint64_t, Client_Replication>::iterator client = client_replication.find(packet->guid.g);
+
+        if (client != client_replication.end()) {
+            RakNet::BitStream bitstream(packet->data, packet->length, false);
+            uint64_t tick = 0;
+
+            bitstream.IgnoreBytes(sizeof(RakNet::MessageID));
+
+            // Acks are unreliable, so an older one can arrive after a newer one
+            if (bitstream.ReadCompressed(tick) && tick > client->second.acked_tick) {
+                client->second.acked_tick = tick;
+            }
+        }
+
+        return true;
+    }
 
     return false;
 }
@@ -25,15 +492,26 @@ string Network_Game::allow_new_connection () {
 }
 
 void Network_Game::write_initial_game_data (RakNet::BitStream& bitstream) {
-    ///bitstream.WriteCompressed();
+    bitstream.Write(Game::world_seed);
 }
 
 void Network_Game::read_initial_game_data (RakNet::BitStream& bitstream) {
-    ///bitstream.ReadCompressed();
+    uint64_t world_seed = 0;
+
+    if (!bitstream.Read(world_seed)) {
+        Log::add_error("Error reading initial game data");
+
+        return;
+    }
+
+    // The terrain is generated locally, so only the seed is needed to match the server's world
+    Game::set_world_seed(world_seed);
 }
 
 void Network_Game::write_update (RakNet::BitStream& bitstream) {
-    ///bitstream.WriteCompressed();
+    // This bitstream goes to every client, so entity state is sent separately, with each client only getting
+    // the entities it is interested in
+    send_snapshots();
 }
 
 void Network_Game::read_update (RakNet::BitStream& bitstream) {
@@ -49,9 +527,86 @@ void Network_Game::read_server_ready (RakNet::BitStream& bitstream) {
 }
 
 void Network_Game::write_client_ready (RakNet::BitStream& bitstream) {
-    ///Write desync detection data, etc.
+    Trace_Scope trace("write_client_ready", "network");
+
+    // Send the hash of every tick simulated since the last report, so the server can pinpoint the first bad tick
+    uint64_t first_tick = last_reported_tick + 1;
+    uint64_t oldest_tick = Game::current_tick >= Game::state_hashes.get_capacity() ?
+                           Game::current_tick - Game::state_hashes.get_capacity() + 1 : 1;
+
+    if (first_tick < oldest_tick) {
+        first_tick = oldest_tick;
+    }
+
+    uint32_t hash_count = Game::current_tick >= first_tick ? (uint32_t) (Game::current_tick - first_tick + 1) : 0;
+
+    // The engine does not say which client a ready message came from, so the client names itself
+    bitstream.Write(Network_Engine::peer->GetMyGUID().g);
+    bitstream.WriteCompressed(first_tick);
+    bitstream.WriteCompressed(hash_count);
+
+    for (uint32_t i = 0; i < hash_count; i++) {
+        uint64_t hash = 0;
+
+        Game::state_hashes.get(first_tick + i, hash);
+
+        bitstream.Write(hash);
+    }
+
+    last_reported_tick = Game::current_tick;
 }
 
 void Network_Game::read_client_ready (RakNet::BitStream& bitstream) {
-    ///Read desync detection data, etc.
+    Trace_Scope trace("read_client_ready", "network");
+
+    uint64_t client_id = 0;
+    uint64_t first_tick = 0;
+    uint32_t hash_count = 0;
+    bool connected = false;
+
+    if (!bitstream.Read(client_id) || !bitstream.ReadCompressed(first_tick) || !bitstream.ReadCompressed(hash_count) ||
+        hash_count > Game::state_hashes.get_capacity()) {
+        Log::add_error("Error reading client ready");
+
+        return;
+    }
+
+    for (size_t i = 0; i < Network_Engine::clients.size() && !connected; i++) {
+        connected = Network_Engine::clients[i].id.g == client_id;
+    }
+
+    if (!connected) {
+        Log::add_error("Error reading client ready: unknown client");
+
+        return;
+    }
+
+    vector<uint64_t> client_hashes(hash_count, 0);
+
+    // Nothing is compared until the whole message has been read, so a truncated one never flags a desync
+    for (uint32_t i = 0; i < hash_count; i++) {
+        if (!bitstream.Read(client_hashes[i])) {
+            Log::add_error("Error reading client ready");
+
+            return;
+        }
+    }
+
+    if (first_desync_ticks.count(client_id) != 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < hash_count; i++) {
+        uint64_t server_hash = 0;
+
+        // Ticks that have already fallen out of the history cannot be checked
+        if (Game::state_hashes.get(first_tick + i, server_hash) && client_hashes[i] != server_hash) {
+            first_desync_ticks[client_id] = first_tick + i;
+
+            Log::add_error("Desync detected for client " + Strings::num_to_string(client_id) + " at tick " +
+                           Strings::num_to_string(first_tick + i));
+
+            break;
+        }
+    }
 }
@@ -5,22 +5,128 @@
 #ifndef network_game_h
 #define network_game_h
 
+#include "snapshot.h"
+#include "area_of_interest.h"
+#include "command_ids.h"
+
 #include <network_message_identifiers.h>
 
 #include <string>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <utility>
 
 #include "raknet/Source/BitStream.h"
 
 enum {
-    ///ID_GAME_EXAMPLE=ID_GAME_PACKET_ENUM
+    ID_GAME_SNAPSHOT = ID_GAME_PACKET_ENUM,
+    ID_GAME_SNAPSHOT_ACK,
+    ID_GAME_COMMANDS
 };
 
 enum {
-    ///ORDERING_CHANNEL_EXAMPLE=ORDERING_CHANNEL_GAME_PACKET_ENUM
+    ORDERING_CHANNEL_SNAPSHOT = ORDERING_CHANNEL_GAME_PACKET_ENUM,
+    ORDERING_CHANNEL_SNAPSHOT_ACK,
+    ORDERING_CHANNEL_COMMANDS
+};
+
+// The server's replication state for one client
+class Client_Replication {
+    public:
+        Area_Of_Interest interest;
+        // The snapshots sent to this client, each holding only the entities it was interested in at the time
+        Snapshot_History snapshots;
+        // The newest snapshot tick the client has acknowledged, or 0 if it has not acknowledged one yet
+        uint64_t acked_tick;
+
+        Client_Replication ();
+};
+
+// The commands the server has received from one client
+class Client_Commands {
+    public:
+        // The commands the client is currently holding down
+        Command_State_Set states;
+        // One-off commands waiting for the next tick
+        std::vector<Player_Command> buffer;
+        // The arguments of the last view command, so that the view can be sent again if the client's player changes
+        // This is also the view the client's snapshots are filtered by
+        std::vector<Fixed> view;
+
+        void add(const std::vector<Player_Command>& commands);
 };
 
 class Network_Game {
+    private:
+        // The last tick whose state hash this client has sent to the server
+        static uint64_t last_reported_tick;
+        // Keyed by client GUID, holding the first tick the server found that client to be desynced on
+        // Clients that have not desynced have no entry
+        static std::map<uint64_t, uint64_t> first_desync_ticks;
+
+        // Server
+        // Keyed by client GUID
+        static std::map<uint64_t, Client_Replication> client_replication;
+        // Only used to hold a packet while it is being written
+        static RakNet::BitStream snapshot_packet;
+        // Keyed by client GUID
+        static std::map<uint64_t, Client_Commands> client_commands;
+        // Indexed by player, holding the GUID of the client each player belonged to when last checked
+        static std::vector<uint64_t> player_ids;
+
+        // Client
+        static Snapshot_History client_snapshots;
+        static Snapshot decoded_snapshot;
+        static uint64_t last_applied_tick;
+        // Indexed by server handle index
+        static std::vector<Entity_Handle> remote_handles;
+        static std::vector<uint32_t> remote_generations;
+
+        // Local input
+        static Command_State_Set local_command_states;
+        // The states the server was last sent
+        static Command_State_Set sent_command_states;
+        static std::vector<Player_Command> local_command_buffer;
+        // The arguments of the last view command sent
+        static std::vector<Fixed> sent_view;
+
+        // Sends each client a snapshot of only the entities it is interested in,
+        // delta encoded against the last snapshot it acknowledged
+        static void send_snapshots();
+        static void read_snapshot(RakNet::BitStream& bitstream);
+        static void apply_snapshot(const Snapshot& snapshot);
+        static void send_snapshot_ack(uint64_t tick);
+        static void read_commands(RakNet::Packet* packet);
+
     public:
+        static void reset_desync_detection();
+        // client is an index into Network_Engine::clients
+        // Returns 0 if no desync has been detected for the client
+        static uint64_t get_first_desync_tick(uint32_t client);
+        static void reset_replication();
+        static void reset_commands();
+
+        // Command input travels as command IDs rather than names
+        // Called once per frame before input is handled
+        static void clear_command_states();
+        static void set_command_state(uint32_t command);
+        static void add_command(const Player_Command& command);
+        // Sends this frame's input to the server, if it has changed, along with a view command whenever the camera
+        // has moved
+        // On the server, the server's own input is applied directly
+        static void send_commands();
+        // client is an index into Network_Engine::clients
+        static bool get_command_state(uint32_t client, uint32_t command);
+        static Command_State_Set get_command_states(uint32_t client);
+        // Moves the client's pending commands into commands
+        static void take_commands(uint32_t client, std::vector<Player_Command>& commands);
+        // Players are numbered by their client's place in Network_Engine::clients, so when a client leaves, every
+        // client after it changes player
+        // Fills changes with the commands the server sends on the players' behalf to keep up: a leave for each player
+        // whose client has gone or changed, and the last view of each client that is new to its player
+        static void take_player_changes(std::vector<std::pair<uint32_t, Player_Command>>& changes);
+
         static bool receive_game_packet(RakNet::Packet* packet, const RakNet::MessageID& packet_id);
 
         // Returns an empty string if a new connection should be allowed
@@ -0,0 +1,299 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "particle_system.h"
+#include "game_constants.h"
+
+#include <options.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    class Effect_Style {
+        public:
+            Effect_Priority priority;
+            uint32_t particles;
+            // In world units per tick
+            float speed;
+            // The particles are thrown within this many degrees of the effect's angle
+            float spread;
+            float drag;
+            float size;
+            float growth;
+            // In ticks
+            float lifetime;
+            const char* color;
+            float opacity;
+            Sprite_Layer layer;
+    };
+
+    // Indexed by Effect_Type
+    const Effect_Style EFFECT_STYLES[EFFECT_TYPE_COUNT] = {
+        {EFFECT_PRIORITY_LOW, 3, 0.3f, 40.0f, 0.96f, 3.0f, 0.08f, 60.0f, "effect_wake", 0.5f, SPRITE_LAYER_WAKES},
+        {EFFECT_PRIORITY_NORMAL, 12, 1.5f, 360.0f, 0.9f, 2.0f, 0.02f, 30.0f, "effect_splash", 0.8f,
+         SPRITE_LAYER_EFFECTS},
+        {EFFECT_PRIORITY_NORMAL, 10, 0.4f, 360.0f, 0.98f, 4.0f, 0.15f, 120.0f, "effect_smoke", 0.6f,
+         SPRITE_LAYER_EFFECTS},
+        {EFFECT_PRIORITY_HIGH, 16, 2.5f, 360.0f, 0.88f, 3.0f, 0.1f, 24.0f, "effect_explosion", 1.0f,
+         SPRITE_LAYER_EFFECTS}
+    };
+
+    const float DEGREES_TO_RADIANS = 3.14159265f / 180.0f;
+
+    // The particle arrays are padded to a multiple of this, so that the update never needs a scalar remainder loop
+    // Past the live particles, the padding holds finished particles, which are updated along with the rest and
+    // ignored
+    const uint32_t PARTICLE_LANES = 8;
+
+    // Moves every particle forward one tick
+    // The arrays never overlap, and count is a multiple of PARTICLE_LANES, so that the compiler vectorizes this
+    void integrate_particles (uint32_t count, float* __restrict x, float* __restrict y, float* __restrict velocity_x,
+                              float* __restrict velocity_y, const float* __restrict drag, float* __restrict size,
+                              const float* __restrict growth, float* __restrict age) {
+        count = (count + PARTICLE_LANES - 1) & ~(PARTICLE_LANES - 1);
+
+        for (uint32_t i = 0; i < count; i++) {
+            x[i] += velocity_x[i];
+            y[i] += velocity_y[i];
+            velocity_x[i] *= drag[i];
+            velocity_y[i] *= drag[i];
+            size[i] += growth[i];
+            age[i] += 1.0f;
+        }
+    }
+}
+
+Effect::Effect () {
+    active = false;
+    type = EFFECT_TYPE_WAKE;
+    priority = EFFECT_PRIORITY_LOW;
+    live_particles = 0;
+    serial = 0;
+}
+
+Effect_Spawn::Effect_Spawn () {
+    type = EFFECT_TYPE_WAKE;
+    x = 0.0f;
+    y = 0.0f;
+    angle = 0.0f;
+}
+
+Particle_System::Particle_System () {
+    effect_count = 0;
+    effect_serial = 0;
+    particle_count = 0;
+    particle_capacity = 0;
+}
+
+void Particle_System::allocate () {
+    uint32_t effect_capacity = Game_Constants::EFFECT_CAPACITY;
+
+    if (effects.size() == effect_capacity && particle_capacity == Game_Constants::PARTICLE_CAPACITY) {
+        return;
+    }
+
+    particle_capacity = Game_Constants::PARTICLE_CAPACITY;
+
+    uint32_t padded_capacity = (particle_capacity + PARTICLE_LANES - 1) / PARTICLE_LANES * PARTICLE_LANES;
+
+    effects.assign(effect_capacity, Effect());
+    free_effects.reserve(effect_capacity);
+    spawns.reserve(effect_capacity);
+
+    x.assign(padded_capacity, 0.0f);
+    y.assign(padded_capacity, 0.0f);
+    velocity_x.assign(padded_capacity, 0.0f);
+    velocity_y.assign(padded_capacity, 0.0f);
+    drag.assign(padded_capacity, 0.0f);
+    size.assign(padded_capacity, 0.0f);
+    growth.assign(padded_capacity, 0.0f);
+    age.assign(padded_capacity, 0.0f);
+    lifetime.assign(padded_capacity, 0.0f);
+    effect.assign(padded_capacity, 0);
+
+    clear();
+}
+
+void Particle_System::clear () {
+    spawns.clear();
+    particle_count = 0;
+    effect_count = 0;
+    free_effects.clear();
+
+    // Handed out from the back, so the lowest slots are used first
+    for (size_t i = effects.size(); i > 0; i--) {
+        effects[i - 1] = Effect();
+        free_effects.push_back(i - 1);
+    }
+}
+
+float Particle_System::random_fraction () {
+    return (rng.next() >> 8) / 16777216.0f;
+}
+
+void Particle_System::remove_particle (uint32_t particle) {
+    uint32_t last = --particle_count;
+
+    x[particle] = x[last];
+    y[particle] = y[last];
+    velocity_x[particle] = velocity_x[last];
+    velocity_y[particle] = velocity_y[last];
+    drag[particle] = drag[last];
+    size[particle] = size[last];
+    growth[particle] = growth[last];
+    age[particle] = age[last];
+    lifetime[particle] = lifetime[last];
+    effect[particle] = effect[last];
+}
+
+void Particle_System::free_effect (uint32_t slot) {
+    effects[slot] = Effect();
+    free_effects.push_back(slot);
+    effect_count--;
+}
+
+bool Particle_System::cull (Effect_Priority priority) {
+    uint32_t victim = 0;
+    bool found = false;
+
+    for (uint32_t i = 0; i < effects.size(); i++) {
+        const Effect& candidate = effects[i];
+
+        if (candidate.active && candidate.priority < priority &&
+            (!found || candidate.priority < effects[victim].priority ||
+             (candidate.priority == effects[victim].priority && candidate.serial < effects[victim].serial))) {
+            victim = i;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < particle_count;) {
+        if (effect[i] == victim) {
+            remove_particle(i);
+        } else {
+            i++;
+        }
+    }
+
+    free_effect(victim);
+
+    return true;
+}
+
+void Particle_System::start_effect (const Effect_Spawn& spawn) {
+    const Effect_Style& style = EFFECT_STYLES[spawn.type];
+    uint32_t limit = min(Options::effect_limit, (uint32_t) effects.size());
+    uint32_t particles = min(style.particles, particle_capacity);
+
+    if (limit == 0 || particles == 0) {
+        return;
+    }
+
+    while (effect_count >= limit || particle_count + particles > particle_capacity) {
+        // Nothing of a lower priority is left to make room, so this effect is the one dropped
+        if (!cull(style.priority)) {
+            return;
+        }
+    }
+
+    uint32_t slot = free_effects.back();
+    Effect& new_effect = effects[slot];
+
+    free_effects.pop_back();
+    effect_count++;
+
+    new_effect.active = true;
+    new_effect.type = spawn.type;
+    new_effect.priority = style.priority;
+    new_effect.live_particles = particles;
+    new_effect.serial = effect_serial++;
+
+    for (uint32_t i = 0; i < particles; i++) {
+        uint32_t particle = particle_count++;
+        float angle = (spawn.angle + (random_fraction() - 0.5f) * style.spread) * DEGREES_TO_RADIANS;
+        float speed = style.speed * (0.5f + random_fraction() * 0.5f);
+
+        x[particle] = spawn.x;
+        y[particle] = spawn.y;
+        velocity_x[particle] = cos(angle) * speed;
+        velocity_y[particle] = sin(angle) * speed;
+        drag[particle] = style.drag;
+        size[particle] = style.size * (0.75f + random_fraction() * 0.5f);
+        growth[particle] = style.growth;
+        age[particle] = 0.0f;
+        lifetime[particle] = style.lifetime * (0.75f + random_fraction() * 0.5f);
+        effect[particle] = slot;
+    }
+}
+
+void Particle_System::spawn (Effect_Type type, double x, double y, double angle) {
+    allocate();
+
+    if (type < EFFECT_TYPE_COUNT && spawns.size() < effects.size()) {
+        spawns.push_back(Effect_Spawn());
+
+        spawns.back().type = type;
+        spawns.back().x = (float) x;
+        spawns.back().y = (float) y;
+        spawns.back().angle = (float) angle;
+    }
+}
+
+void Particle_System::update () {
+    allocate();
+
+    for (size_t i = 0; i < spawns.size(); i++) {
+        start_effect(spawns[i]);
+    }
+
+    spawns.clear();
+
+    if (particle_count == 0) {
+        return;
+    }
+
+    integrate_particles(particle_count, &x[0], &y[0], &velocity_x[0], &velocity_y[0], &drag[0], &size[0], &growth[0],
+                        &age[0]);
+
+    for (uint32_t i = 0; i < particle_count;) {
+        if (age[i] >= lifetime[i]) {
+            uint32_t slot = effect[i];
+
+            // The last particle moves into this slot, and is checked next
+            remove_particle(i);
+
+            if (--effects[slot].live_particles == 0) {
+                free_effect(slot);
+            }
+        } else {
+            i++;
+        }
+    }
+}
+
+void Particle_System::render (Sprite_Batch& sprite_batch) const {
+    for (uint32_t i = 0; i < particle_count; i++) {
+        const Effect_Style& style = EFFECT_STYLES[effects[effect[i]].type];
+        double opacity = style.opacity * (1.0 - age[i] / lifetime[i]);
+        double half_size = size[i] * 0.5;
+
+        sprite_batch.add_rectangle(style.layer, x[i] - half_size, y[i] - half_size, size[i], size[i], style.color,
+                                   opacity);
+    }
+}
+
+uint32_t Particle_System::get_effect_count () const {
+    return effect_count;
+}
+
+uint32_t Particle_System::get_particle_count () const {
+    return particle_count;
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef particle_system_h
+#define particle_system_h
+
+#include "sprite_batch.h"
+#include "simulation_rng.h"
+
+#include <vector>
+#include <cstdint>
+
+enum Effect_Type : uint8_t {
+    EFFECT_TYPE_WAKE,
+    EFFECT_TYPE_SPLASH,
+    EFFECT_TYPE_SMOKE,
+    EFFECT_TYPE_EXPLOSION,
+    EFFECT_TYPE_COUNT
+};
+
+// When the pools are full, effects of a lower priority are culled to make room for those of a higher one
+enum Effect_Priority : uint8_t {
+    EFFECT_PRIORITY_LOW,
+    EFFECT_PRIORITY_NORMAL,
+    EFFECT_PRIORITY_HIGH
+};
+
+class Effect {
+    public:
+        bool active;
+        Effect_Type type;
+        Effect_Priority priority;
+        uint32_t live_particles;
+        // Effects are numbered in the order they started, so that the oldest of a priority is culled first
+        uint64_t serial;
+
+        Effect ();
+};
+
+class Effect_Spawn {
+    public:
+        Effect_Type type;
+        float x;
+        float y;
+        // The direction the effect is thrown in, in degrees
+        float angle;
+
+        Effect_Spawn ();
+};
+
+// Smoke, splashes, wakes and explosions, made of particles in fixed capacity struct-of-arrays pools
+// The pools are allocated once, the first time they are needed, and nothing is allocated per effect or particle
+// Particles are purely visual, so they use their own random numbers and floating point, and never feed back into
+// the simulation
+class Particle_System {
+    private:
+        // Indexed by effect slot
+        std::vector<Effect> effects;
+        std::vector<uint32_t> free_effects;
+        uint32_t effect_count;
+        uint64_t effect_serial;
+
+        // Effects asked for since the last update
+        // Spawning only queues the effect, so that it stays cheap where particles are never updated, such as on a
+        // dedicated server
+        std::vector<Effect_Spawn> spawns;
+
+        // Particle components, with live particles packed into [0, particle_count)
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> velocity_x;
+        std::vector<float> velocity_y;
+        // Each tick, velocity is multiplied by drag, and size grows by growth
+        std::vector<float> drag;
+        std::vector<float> size;
+        std::vector<float> growth;
+        // In ticks
+        std::vector<float> age;
+        std::vector<float> lifetime;
+        std::vector<uint32_t> effect;
+        uint32_t particle_count;
+        uint32_t particle_capacity;
+
+        Simulation_Rng rng;
+
+        void allocate();
+        float random_fraction();
+        // Moves the last particle into the passed slot
+        void remove_particle(uint32_t particle);
+        void free_effect(uint32_t slot);
+        // Culls the oldest effect with a priority below the passed one
+        // Returns false if there is none
+        bool cull(Effect_Priority priority);
+        void start_effect(const Effect_Spawn& spawn);
+
+    public:
+        Particle_System ();
+
+        void clear();
+
+        // Queues an effect to start on the next update
+        // Spawns beyond the effect capacity in one tick are dropped
+        void spawn(Effect_Type type, double x, double y, double angle = 0.0);
+
+        // Starts the queued effects, then moves every particle forward one tick and removes those that have expired
+        void update();
+        void render(Sprite_Batch& sprite_batch) const;
+
+        uint32_t get_effect_count() const;
+        uint32_t get_particle_count() const;
+};
+
+#endif
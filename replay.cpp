@@ -0,0 +1,430 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "replay.h"
+#include "game.h"
+#include "command_ids.h"
+
+#include <log.h>
+#include <engine_strings.h>
+
+#include <iterator>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    const uint32_t CHUNK_HEADER_SIZE = 5;
+    // Guards against reading a corrupt length as a huge allocation
+    const uint32_t MAX_CHUNK_SIZE = 256 * 1024 * 1024;
+    const uint32_t MAX_COMMAND_LENGTH = 1024;
+}
+
+Replay_Command::Replay_Command () {
+    player = 0;
+}
+
+Replay_Command::Replay_Command (uint32_t new_player, const string& new_name, const vector<Fixed>& new_arguments) {
+    player = new_player;
+    name = new_name;
+    arguments = new_arguments;
+}
+
+Replay_Command_States::Replay_Command_States () {
+    player = 0;
+}
+
+Replay_Command_States::Replay_Command_States (uint32_t new_player, const Command_State_Set& new_states) {
+    player = new_player;
+    states = new_states;
+}
+
+Replay_Tick::Replay_Tick () {
+    tick = 0;
+}
+
+Replay_Keyframe::Replay_Keyframe () {
+    tick = 0;
+    state_hash = 0;
+}
+
+const uint32_t Replay_Recorder::VERSION = 8;
+const uint32_t Replay_Recorder::DEFAULT_KEYFRAME_INTERVAL = 600;
+
+ofstream Replay_Recorder::file;
+bool Replay_Recorder::recording = false;
+uint32_t Replay_Recorder::keyframe_interval = Replay_Recorder::DEFAULT_KEYFRAME_INTERVAL;
+vector<Replay_Command> Replay_Recorder::pending_commands;
+vector<Replay_Command_States> Replay_Recorder::pending_command_states;
+
+void Replay_Recorder::write_chunk (Replay_Chunk_Type chunk_type, const RakNet::BitStream& bitstream) {
+    uint32_t length = bitstream.GetNumberOfBytesUsed();
+    unsigned char header[CHUNK_HEADER_SIZE] = {
+        chunk_type, (unsigned char) length, (unsigned char) (length >> 8), (unsigned char) (length >> 16),
+        (unsigned char) (length >> 24)
+    };
+
+    file.write((const char*) header, CHUNK_HEADER_SIZE);
+    file.write((const char*) bitstream.GetData(), length);
+}
+
+void Replay_Recorder::write_keyframe () {
+    RakNet::BitStream bitstream;
+
+    Game::write_keyframe(bitstream);
+
+    write_chunk(REPLAY_CHUNK_KEYFRAME, bitstream);
+}
+
+bool Replay_Recorder::start (const string& path, uint32_t new_keyframe_interval) {
+    stop();
+
+    file.open(path.c_str(), ios::binary | ios::trunc);
+
+    if (!file.is_open()) {
+        Log::add_error("Error opening replay file for recording: " + path);
+
+        return false;
+    }
+
+    recording = true;
+    keyframe_interval = new_keyframe_interval > 0 ? new_keyframe_interval : DEFAULT_KEYFRAME_INTERVAL;
+    pending_commands.clear();
+    pending_command_states.clear();
+
+    RakNet::BitStream bitstream;
+
+    bitstream.WriteCompressed(VERSION);
+    bitstream.WriteCompressed(keyframe_interval);
+
+    write_chunk(REPLAY_CHUNK_HEADER, bitstream);
+
+    write_keyframe();
+
+    return true;
+}
+
+void Replay_Recorder::stop () {
+    if (recording) {
+        RakNet::BitStream bitstream;
+
+        bitstream.WriteCompressed(Game::current_tick);
+        bitstream.Write(Game::state_hash);
+
+        write_chunk(REPLAY_CHUNK_END, bitstream);
+
+        file.close();
+
+        recording = false;
+        pending_commands.clear();
+        pending_command_states.clear();
+    }
+}
+
+bool Replay_Recorder::is_recording () {
+    return recording;
+}
+
+void Replay_Recorder::record_command (uint32_t player, const string& command, const vector<Fixed>& arguments) {
+    if (recording) {
+        pending_commands.push_back(Replay_Command(player, command, arguments));
+    }
+}
+
+void Replay_Recorder::record_command_states (uint32_t player, const Command_State_Set& states) {
+    if (recording) {
+        pending_command_states.push_back(Replay_Command_States(player, states));
+    }
+}
+
+void Replay_Recorder::end_tick () {
+    if (recording) {
+        if (pending_commands.size() > 0 || pending_command_states.size() > 0) {
+            RakNet::BitStream bitstream;
+            uint32_t command_count = (uint32_t) pending_commands.size();
+            uint32_t states_count = (uint32_t) pending_command_states.size();
+
+            bitstream.WriteCompressed(Game::current_tick);
+            bitstream.WriteCompressed(command_count);
+
+            for (uint32_t i = 0; i < command_count; i++) {
+                uint32_t length = (uint32_t) pending_commands[i].name.length();
+
+                bitstream.WriteCompressed(pending_commands[i].player);
+                bitstream.WriteCompressed(length);
+                bitstream.Write(pending_commands[i].name.c_str(), length);
+                bitstream.WriteCompressed((uint32_t) pending_commands[i].arguments.size());
+
+                for (size_t n = 0; n < pending_commands[i].arguments.size(); n++) {
+                    bitstream.Write(pending_commands[i].arguments[n].raw);
+                }
+            }
+
+            bitstream.WriteCompressed(states_count);
+
+            for (uint32_t i = 0; i < states_count; i++) {
+                bitstream.WriteCompressed(pending_command_states[i].player);
+                pending_command_states[i].states.write_names(bitstream);
+            }
+
+            write_chunk(REPLAY_CHUNK_TICK, bitstream);
+
+            pending_commands.clear();
+            pending_command_states.clear();
+        }
+
+        if (Game::current_tick % keyframe_interval == 0) {
+            write_keyframe();
+        }
+    }
+}
+
+Replay::Replay () {
+    clear();
+}
+
+void Replay::clear () {
+    keyframe_interval = 0;
+    ticks.clear();
+    keyframes.clear();
+    end_tick = 0;
+    end_state_hash = 0;
+}
+
+bool Replay::load (const string& path) {
+    clear();
+
+    ifstream file(path.c_str(), ios::binary);
+
+    if (!file.is_open()) {
+        Log::add_error("Error opening replay file: " + path);
+
+        return false;
+    }
+
+    vector<unsigned char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    size_t position = 0;
+    bool header_read = false;
+
+    while (position + CHUNK_HEADER_SIZE <= data.size()) {
+        Replay_Chunk_Type chunk_type = (Replay_Chunk_Type) data[position];
+        uint32_t length = (uint32_t) data[position + 1] | ((uint32_t) data[position + 2] << 8) |
+                          ((uint32_t) data[position + 3] << 16) | ((uint32_t) data[position + 4] << 24);
+
+        position += CHUNK_HEADER_SIZE;
+
+        if (length > MAX_CHUNK_SIZE || position + length > data.size()) {
+            // A recording cut off part way through a chunk still has everything before that chunk
+            Log::add_error("Replay file is truncated: " + path);
+
+            break;
+        }
+
+        RakNet::BitStream bitstream(&data[0] + position, length, false);
+        bool valid = true;
+
+        if (chunk_type == REPLAY_CHUNK_HEADER) {
+            uint32_t version = 0;
+
+            valid = bitstream.ReadCompressed(version) && version == Replay_Recorder::VERSION &&
+                    bitstream.ReadCompressed(keyframe_interval);
+            header_read = valid;
+        } else if (chunk_type == REPLAY_CHUNK_TICK) {
+            uint32_t command_count = 0;
+
+            ticks.push_back(Replay_Tick());
+
+            valid = bitstream.ReadCompressed(ticks.back().tick) && bitstream.ReadCompressed(command_count);
+
+            for (uint32_t i = 0; i < command_count && valid; i++) {
+                uint32_t player = 0;
+                uint32_t command_length = 0;
+
+                valid = bitstream.ReadCompressed(player) && bitstream.ReadCompressed(command_length) &&
+                        command_length <= MAX_COMMAND_LENGTH;
+
+                if (valid) {
+                    vector<char> name(command_length + 1, 0);
+                    uint32_t argument_count = 0;
+
+                    valid = (command_length == 0 || bitstream.Read(&name[0], command_length)) &&
+                            bitstream.ReadCompressed(argument_count) && argument_count <= Command_Ids::MAX_ARGUMENTS;
+
+                    vector<Fixed> arguments(valid ? argument_count : 0);
+
+                    for (size_t n = 0; n < arguments.size() && valid; n++) {
+                        valid = bitstream.Read(arguments[n].raw);
+                    }
+
+                    ticks.back().commands.push_back(Replay_Command(player, string(&name[0], command_length),
+                                                                   arguments));
+                }
+            }
+
+            uint32_t states_count = 0;
+
+            valid = valid && bitstream.ReadCompressed(states_count);
+
+            for (uint32_t i = 0; i < states_count && valid; i++) {
+                ticks.back().command_states.push_back(Replay_Command_States());
+
+                valid = bitstream.ReadCompressed(ticks.back().command_states.back().player) &&
+                        ticks.back().command_states.back().states.read_names(bitstream);
+            }
+
+            end_tick = max(end_tick, ticks.back().tick);
+        } else if (chunk_type == REPLAY_CHUNK_KEYFRAME) {
+            keyframes.push_back(Replay_Keyframe());
+
+            valid = bitstream.ReadCompressed(keyframes.back().tick) && bitstream.Read(keyframes.back().state_hash);
+
+            keyframes.back().data.assign(data.begin() + position, data.begin() + position + length);
+
+            end_tick = max(end_tick, keyframes.back().tick);
+        } else if (chunk_type == REPLAY_CHUNK_END) {
+            valid = bitstream.ReadCompressed(end_tick) && bitstream.Read(end_state_hash);
+        }
+
+        if (!valid || !header_read) {
+            Log::add_error("Replay file is malformed: " + path);
+
+            clear();
+
+            return false;
+        }
+
+        position += length;
+    }
+
+    if (keyframes.size() == 0) {
+        Log::add_error("Replay file has no keyframes: " + path);
+
+        clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+Replay Replay_Player::replay;
+size_t Replay_Player::next_tick_position = 0;
+size_t Replay_Player::next_keyframe_position = 0;
+uint64_t Replay_Player::first_divergent_tick = 0;
+
+void Replay_Player::check_state_hash () {
+    uint64_t recorded_hash = 0;
+    bool recorded = false;
+
+    while (next_keyframe_position < replay.keyframes.size() &&
+           replay.keyframes[next_keyframe_position].tick < Game::current_tick) {
+        next_keyframe_position++;
+    }
+
+    if (next_keyframe_position < replay.keyframes.size() &&
+        replay.keyframes[next_keyframe_position].tick == Game::current_tick) {
+        recorded_hash = replay.keyframes[next_keyframe_position].state_hash;
+        recorded = true;
+    } else if (Game::current_tick == replay.end_tick && replay.end_state_hash != 0) {
+        recorded_hash = replay.end_state_hash;
+        recorded = true;
+    }
+
+    if (recorded && first_divergent_tick == 0 && recorded_hash != Game::state_hash) {
+        first_divergent_tick = Game::current_tick;
+
+        Log::add_error("Replay diverged from the recording by tick " + Strings::num_to_string(first_divergent_tick));
+    }
+}
+
+bool Replay_Player::load (const string& path) {
+    // Playing back must never feed into a recording
+    Replay_Recorder::stop();
+
+    next_tick_position = 0;
+    next_keyframe_position = 0;
+    first_divergent_tick = 0;
+
+    return replay.load(path);
+}
+
+const Replay& Replay_Player::get_replay () {
+    return replay;
+}
+
+bool Replay_Player::seek (uint64_t tick) {
+    const Replay_Keyframe* keyframe = 0;
+
+    // Keyframes are written in tick order
+    for (size_t i = 0; i < replay.keyframes.size() && replay.keyframes[i].tick <= tick; i++) {
+        keyframe = &replay.keyframes[i];
+    }
+
+    if (keyframe == 0) {
+        return false;
+    }
+
+    vector<unsigned char> data = keyframe->data;
+    RakNet::BitStream bitstream(&data[0], (unsigned int) data.size(), false);
+
+    if (!Game::read_keyframe(bitstream)) {
+        Log::add_error("Error reading replay keyframe for tick " + Strings::num_to_string(keyframe->tick));
+
+        return false;
+    }
+
+    next_tick_position = 0;
+    next_keyframe_position = 0;
+
+    advance(tick);
+
+    return true;
+}
+
+uint64_t Replay_Player::advance (uint64_t tick) {
+    uint64_t target_tick = min(tick, replay.end_tick);
+    uint64_t simulated = 0;
+
+    while (Game::current_tick < target_tick) {
+        uint64_t next_tick = Game::current_tick + 1;
+
+        while (next_tick_position < replay.ticks.size() && replay.ticks[next_tick_position].tick < next_tick) {
+            next_tick_position++;
+        }
+
+        if (next_tick_position < replay.ticks.size() && replay.ticks[next_tick_position].tick == next_tick) {
+            const vector<Replay_Command>& commands = replay.ticks[next_tick_position].commands;
+
+            for (size_t i = 0; i < commands.size(); i++) {
+                uint32_t command = Command_Ids::get_id(commands[i].name);
+
+                // The command no longer exists in the data
+                if (command != Command_Ids::INVALID) {
+                    Game::handle_player_command(commands[i].player, Player_Command(command, commands[i].arguments));
+                }
+            }
+
+            const vector<Replay_Command_States>& command_states = replay.ticks[next_tick_position].command_states;
+
+            for (size_t i = 0; i < command_states.size(); i++) {
+                Game::handle_player_command_states(command_states[i].player, command_states[i].states);
+            }
+        }
+
+        Game::tick();
+        Game::ai();
+        Game::movement();
+        Game::events();
+
+        check_state_hash();
+
+        simulated++;
+    }
+
+    return simulated;
+}
+
+uint64_t Replay_Player::get_first_divergent_tick () {
+    return first_divergent_tick;
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef replay_h
+#define replay_h
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+#include "command_ids.h"
+
+#include "raknet/Source/BitStream.h"
+
+// A replay file is a sequence of chunks, each a chunk type byte, a 4 byte little-endian payload length,
+// and a payload written with a BitStream
+enum Replay_Chunk_Type : uint8_t {
+    REPLAY_CHUNK_HEADER,
+    // The commands that entered the simulation during one tick, and the held command states that changed on it
+    // Ticks without either have no chunk
+    REPLAY_CHUNK_TICK,
+    // The entire simulation state at the end of a tick
+    REPLAY_CHUNK_KEYFRAME,
+    // The last tick recorded and its state hash
+    REPLAY_CHUNK_END
+};
+
+class Replay_Command {
+    public:
+        uint32_t player;
+        std::string name;
+        std::vector<Fixed> arguments;
+
+        Replay_Command ();
+        Replay_Command (uint32_t new_player, const std::string& new_name, const std::vector<Fixed>& new_arguments);
+};
+
+class Replay_Command_States {
+    public:
+        uint32_t player;
+        Command_State_Set states;
+
+        Replay_Command_States ();
+        Replay_Command_States (uint32_t new_player, const Command_State_Set& new_states);
+};
+
+class Replay_Tick {
+    public:
+        uint64_t tick;
+        std::vector<Replay_Command> commands;
+        std::vector<Replay_Command_States> command_states;
+
+        Replay_Tick ();
+};
+
+class Replay_Keyframe {
+    public:
+        uint64_t tick;
+        uint64_t state_hash;
+        // A keyframe as written by Game::write_keyframe
+        std::vector<unsigned char> data;
+
+        Replay_Keyframe ();
+};
+
+// Records every command and change in held command states that enters the simulation, plus a keyframe at regular
+// intervals
+// Since the simulation is deterministic, this is enough to reproduce a game exactly
+class Replay_Recorder {
+    private:
+        static std::ofstream file;
+        static bool recording;
+        static uint32_t keyframe_interval;
+        static std::vector<Replay_Command> pending_commands;
+        static std::vector<Replay_Command_States> pending_command_states;
+
+        static void write_chunk(Replay_Chunk_Type chunk_type, const RakNet::BitStream& bitstream);
+        static void write_keyframe();
+
+    public:
+        static const uint32_t VERSION;
+        static const uint32_t DEFAULT_KEYFRAME_INTERVAL;
+
+        // Starts with a keyframe of the current state, so recording can begin at any tick
+        // Returns false if the file could not be opened
+        static bool start(const std::string& path, uint32_t new_keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+        static void stop();
+        static bool is_recording();
+
+        static void record_command(uint32_t player, const std::string& command, const std::vector<Fixed>& arguments);
+        static void record_command_states(uint32_t player, const Command_State_Set& states);
+        // Called once the simulation has finished a tick
+        static void end_tick();
+};
+
+class Replay {
+    public:
+        uint32_t keyframe_interval;
+        // Sorted by tick
+        std::vector<Replay_Tick> ticks;
+        std::vector<Replay_Keyframe> keyframes;
+        uint64_t end_tick;
+        // 0 if the recording never reached its end chunk
+        uint64_t end_state_hash;
+
+        Replay ();
+
+        void clear();
+        // Returns false if the file could not be read or is malformed
+        bool load(const std::string& path);
+};
+
+// Plays a replay back through the simulation, without rendering, as fast as the CPU allows
+class Replay_Player {
+    private:
+        static Replay replay;
+        static size_t next_tick_position;
+        static size_t next_keyframe_position;
+        static uint64_t first_divergent_tick;
+
+        static void check_state_hash();
+
+    public:
+        static bool load(const std::string& path);
+        static const Replay& get_replay();
+
+        // Restores the nearest keyframe at or before tick, then simulates forward to tick
+        // Returns false if there is no keyframe to start from
+        static bool seek(uint64_t tick);
+        // Simulates until tick or the end of the replay, whichever comes first
+        // Returns the number of ticks simulated
+        static uint64_t advance(uint64_t tick);
+
+        // The first tick whose state hash did not match the recording, or 0 if none has so far
+        // Hashes are only recorded at keyframes and at the end, so the divergence happened at most
+        // one keyframe interval before this tick
+        static uint64_t get_first_divergent_tick();
+};
+
+#endif
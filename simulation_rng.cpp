@@ -0,0 +1,75 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "simulation_rng.h"
+
+using namespace std;
+
+Simulation_Rng::Simulation_Rng () {
+    seed(0);
+}
+
+Simulation_Rng::Simulation_Rng (uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+void Simulation_Rng::seed (uint64_t new_seed, uint64_t stream) {
+    state = 0;
+    increment = (stream << 1) | 1;
+
+    next();
+
+    state += new_seed;
+
+    next();
+}
+
+uint32_t Simulation_Rng::next () {
+    uint64_t old_state = state;
+
+    state = old_state * 6364136223846793005ULL + increment;
+
+    uint32_t xorshifted = (uint32_t) (((old_state >> 18) ^ old_state) >> 27);
+    uint32_t rotation = (uint32_t) (old_state >> 59);
+
+    return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+}
+
+uint32_t Simulation_Rng::range (uint32_t low, uint32_t high) {
+    if (high <= low) {
+        return low;
+    }
+
+    uint64_t span = (uint64_t) high - (uint64_t) low + 1;
+
+    // Multiply-shift maps the full 32 bits onto the range without a division
+    return low + (uint32_t) (((uint64_t) next() * span) >> 32);
+}
+
+Fixed Simulation_Rng::range_fixed (const Fixed& low, const Fixed& high) {
+    if (high <= low) {
+        return low;
+    }
+
+    uint64_t span = (uint64_t) (high.raw - low.raw);
+    // Separate statements, since the evaluation order of operands is unspecified
+    uint64_t random = (uint64_t) next() << 32;
+
+    random |= next();
+
+    return Fixed::from_raw(low.raw + (int64_t) (random % span));
+}
+
+uint64_t Simulation_Rng::get_state () const {
+    return state;
+}
+
+uint64_t Simulation_Rng::get_increment () const {
+    return increment;
+}
+
+void Simulation_Rng::set_state (uint64_t new_state, uint64_t new_increment) {
+    state = new_state;
+    increment = new_increment;
+}
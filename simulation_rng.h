@@ -0,0 +1,38 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef simulation_rng_h
+#define simulation_rng_h
+
+#include "fixed.h"
+
+#include <cstdint>
+
+// PCG32 random number generator for simulation state
+// Unlike the standard library's distributions, its output is fully specified, so every platform produces the same
+// sequence from the same seed
+class Simulation_Rng {
+    private:
+        uint64_t state;
+        uint64_t increment;
+
+    public:
+        Simulation_Rng ();
+        Simulation_Rng (uint64_t seed, uint64_t stream = 0);
+
+        void seed(uint64_t new_seed, uint64_t stream = 0);
+
+        uint32_t next();
+        // Returns a number in [low, high]
+        uint32_t range(uint32_t low, uint32_t high);
+        // Returns a number in [low, high)
+        Fixed range_fixed(const Fixed& low, const Fixed& high);
+
+        uint64_t get_state() const;
+        uint64_t get_increment() const;
+        // Restores a generator saved with get_state and get_increment
+        void set_state(uint64_t new_state, uint64_t new_increment);
+};
+
+#endif
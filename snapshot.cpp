@@ -0,0 +1,300 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "snapshot.h"
+#include "bit_codec.h"
+
+using namespace std;
+
+namespace {
+    // Fractional bits dropped from each field before it is replicated
+    const int32_t FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_COUNT] = {
+        // Positions to 1/16 of a world unit
+        12, 12,
+        // Velocities to 1/256 of a world unit per tick
+        8, 8,
+        // Heading to 1/256 of a degree
+        8,
+        // Hull and AI state are sent as is
+        0, 0
+    };
+
+    // No entity takes fewer bits than this: the size class of its index gap, whether it is full, and whether it
+    // changed
+    const uint64_t MIN_ENTITY_BITS = 4;
+}
+
+Entity_Snapshot::Entity_Snapshot () {
+    index = 0;
+    generation = 0;
+    type = 0;
+
+    for (uint32_t i = 0; i < SNAPSHOT_FIELD_COUNT; i++) {
+        fields[i] = 0;
+    }
+}
+
+Snapshot::Snapshot () {
+    tick = 0;
+}
+
+void Snapshot::add_entity (const Entity_Store& store, uint32_t index, uint32_t dense) {
+    entities.push_back(Entity_Snapshot());
+
+    Entity_Snapshot& entity = entities.back();
+
+    entity.index = index;
+    entity.generation = store.get_handle(dense).generation;
+    entity.type = store.type[dense];
+    entity.fields[SNAPSHOT_FIELD_X] = store.x[dense].raw >> FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_X];
+    entity.fields[SNAPSHOT_FIELD_Y] = store.y[dense].raw >> FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_Y];
+    entity.fields[SNAPSHOT_FIELD_VELOCITY_X] = store.velocity_x[dense].raw >>
+                                               FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_VELOCITY_X];
+    entity.fields[SNAPSHOT_FIELD_VELOCITY_Y] = store.velocity_y[dense].raw >>
+                                               FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_VELOCITY_Y];
+    entity.fields[SNAPSHOT_FIELD_HEADING] = store.heading[dense].raw >> FIELD_PRECISION_SHIFTS[SNAPSHOT_FIELD_HEADING];
+    entity.fields[SNAPSHOT_FIELD_HULL] = store.hull[dense];
+    entity.fields[SNAPSHOT_FIELD_AI_STATE] = store.ai_state[dense];
+}
+
+void Snapshot::capture (uint64_t new_tick, const Entity_Store& store) {
+    tick = new_tick;
+    entities.clear();
+    entities.reserve(store.size());
+
+    // Walking the handle indices, rather than the dense slots, keeps the entities sorted by index
+    for (uint32_t index = 0; index < store.get_index_count(); index++) {
+        uint32_t dense = store.get_dense_from_index(index);
+
+        if (dense != Entity_Store::INVALID_DENSE) {
+            add_entity(store, index, dense);
+        }
+    }
+}
+
+void Snapshot::capture (uint64_t new_tick, const Entity_Store& store, const vector<uint32_t>& indices) {
+    tick = new_tick;
+    entities.clear();
+    entities.reserve(indices.size());
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        uint32_t dense = store.get_dense_from_index(indices[i]);
+
+        if (dense != Entity_Store::INVALID_DENSE) {
+            add_entity(store, indices[i], dense);
+        }
+    }
+}
+
+void Snapshot::apply_field (Entity_Store& store, uint32_t dense, uint32_t field, int64_t value) {
+    int64_t raw = value * ((int64_t) 1 << FIELD_PRECISION_SHIFTS[field]);
+
+    if (field == SNAPSHOT_FIELD_X) {
+        store.x[dense] = Fixed::from_raw(raw);
+    } else if (field == SNAPSHOT_FIELD_Y) {
+        store.y[dense] = Fixed::from_raw(raw);
+    } else if (field == SNAPSHOT_FIELD_VELOCITY_X) {
+        store.velocity_x[dense] = Fixed::from_raw(raw);
+    } else if (field == SNAPSHOT_FIELD_VELOCITY_Y) {
+        store.velocity_y[dense] = Fixed::from_raw(raw);
+    } else if (field == SNAPSHOT_FIELD_HEADING) {
+        store.heading[dense] = Fixed::from_raw(raw);
+    } else if (field == SNAPSHOT_FIELD_HULL) {
+        store.hull[dense] = (int32_t) raw;
+    } else if (field == SNAPSHOT_FIELD_AI_STATE) {
+        store.ai_state[dense] = (uint8_t) raw;
+    }
+}
+
+Snapshot_History::Snapshot_History () {
+    clear();
+}
+
+void Snapshot_History::clear () {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+        snapshots[i].tick = 0;
+        snapshots[i].entities.clear();
+        used[i] = false;
+    }
+}
+
+Snapshot& Snapshot_History::add (uint64_t tick) {
+    uint32_t slot = (uint32_t) (tick % CAPACITY);
+
+    used[slot] = true;
+    snapshots[slot].tick = tick;
+
+    return snapshots[slot];
+}
+
+const Snapshot* Snapshot_History::find (uint64_t tick) const {
+    uint32_t slot = (uint32_t) (tick % CAPACITY);
+
+    if (used[slot] && snapshots[slot].tick == tick) {
+        return &snapshots[slot];
+    }
+
+    return 0;
+}
+
+void Snapshot_Codec::write (RakNet::BitStream& bitstream, const Snapshot* baseline, const Snapshot& current) {
+    bitstream.WriteCompressed(current.tick);
+    bitstream.WriteCompressed(baseline != 0 ? baseline->tick : (uint64_t) 0);
+
+    Bit_Codec::write_varint(bitstream, current.entities.size());
+
+    size_t baseline_position = 0;
+    uint32_t next_index = 0;
+
+    for (size_t i = 0; i < current.entities.size(); i++) {
+        const Entity_Snapshot& entity = current.entities[i];
+        const Entity_Snapshot* previous = 0;
+
+        if (baseline != 0) {
+            while (baseline_position < baseline->entities.size() &&
+                   baseline->entities[baseline_position].index < entity.index) {
+                baseline_position++;
+            }
+
+            if (baseline_position < baseline->entities.size() &&
+                baseline->entities[baseline_position].index == entity.index &&
+                baseline->entities[baseline_position].generation == entity.generation) {
+                previous = &baseline->entities[baseline_position];
+            }
+        }
+
+        Bit_Codec::write_varint(bitstream, entity.index - next_index);
+        next_index = entity.index + 1;
+
+        if (previous != 0) {
+            bool changed = false;
+
+            for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT && !changed; field++) {
+                changed = entity.fields[field] != previous->fields[field];
+            }
+
+            bitstream.Write(false);
+            bitstream.Write(changed);
+
+            if (changed) {
+                for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+                    bool field_changed = entity.fields[field] != previous->fields[field];
+
+                    bitstream.Write(field_changed);
+
+                    if (field_changed) {
+                        Bit_Codec::write_signed(bitstream, entity.fields[field] - previous->fields[field]);
+                    }
+                }
+            }
+        } else {
+            // New since the baseline, or its slot has been reused
+            bitstream.Write(true);
+            Bit_Codec::write_varint(bitstream, entity.generation);
+            Bit_Codec::write_bits(bitstream, entity.type, 8);
+
+            for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+                Bit_Codec::write_signed(bitstream, entity.fields[field]);
+            }
+        }
+    }
+}
+
+bool Snapshot_Codec::read_header (RakNet::BitStream& bitstream, uint64_t& tick, uint64_t& baseline_tick) {
+    return bitstream.ReadCompressed(tick) && bitstream.ReadCompressed(baseline_tick);
+}
+
+bool Snapshot_Codec::read (RakNet::BitStream& bitstream, const Snapshot* baseline, Snapshot& result) {
+    uint64_t count = 0;
+
+    // Guards against reserving a huge allocation for a count that the rest of the data could never hold
+    if (!Bit_Codec::read_varint(bitstream, count) || count > bitstream.GetNumberOfUnreadBits() / MIN_ENTITY_BITS) {
+        return false;
+    }
+
+    result.entities.clear();
+    result.entities.reserve((size_t) count);
+
+    size_t baseline_position = 0;
+    uint32_t next_index = 0;
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t index_gap = 0;
+        bool full = false;
+
+        if (!Bit_Codec::read_varint(bitstream, index_gap) || !bitstream.Read(full)) {
+            return false;
+        }
+
+        result.entities.push_back(Entity_Snapshot());
+
+        Entity_Snapshot& entity = result.entities.back();
+
+        entity.index = next_index + (uint32_t) index_gap;
+        next_index = entity.index + 1;
+
+        if (!full) {
+            if (baseline == 0) {
+                return false;
+            }
+
+            while (baseline_position < baseline->entities.size() &&
+                   baseline->entities[baseline_position].index < entity.index) {
+                baseline_position++;
+            }
+
+            if (baseline_position >= baseline->entities.size() ||
+                baseline->entities[baseline_position].index != entity.index) {
+                return false;
+            }
+
+            const Entity_Snapshot& previous = baseline->entities[baseline_position];
+            bool changed = false;
+
+            entity = previous;
+
+            if (!bitstream.Read(changed)) {
+                return false;
+            }
+
+            if (changed) {
+                for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+                    bool field_changed = false;
+
+                    if (!bitstream.Read(field_changed)) {
+                        return false;
+                    }
+
+                    if (field_changed) {
+                        int64_t difference = 0;
+
+                        if (!Bit_Codec::read_signed(bitstream, difference)) {
+                            return false;
+                        }
+
+                        entity.fields[field] += difference;
+                    }
+                }
+            }
+        } else {
+            uint64_t generation = 0;
+            uint64_t type = 0;
+
+            if (!Bit_Codec::read_varint(bitstream, generation) || !Bit_Codec::read_bits(bitstream, type, 8)) {
+                return false;
+            }
+
+            entity.generation = (uint32_t) generation;
+            entity.type = (uint8_t) type;
+
+            for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT; field++) {
+                if (!Bit_Codec::read_signed(bitstream, entity.fields[field])) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
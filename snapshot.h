@@ -0,0 +1,87 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef snapshot_h
+#define snapshot_h
+
+#include "entity_store.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+enum Snapshot_Field {
+    SNAPSHOT_FIELD_X,
+    SNAPSHOT_FIELD_Y,
+    SNAPSHOT_FIELD_VELOCITY_X,
+    SNAPSHOT_FIELD_VELOCITY_Y,
+    SNAPSHOT_FIELD_HEADING,
+    SNAPSHOT_FIELD_HULL,
+    SNAPSHOT_FIELD_AI_STATE,
+    SNAPSHOT_FIELD_COUNT
+};
+
+// The replicated state of one entity, quantized to network precision
+class Entity_Snapshot {
+    public:
+        uint32_t index;
+        uint32_t generation;
+        uint8_t type;
+        int64_t fields[SNAPSHOT_FIELD_COUNT];
+
+        Entity_Snapshot ();
+};
+
+// The replicated state of the world at one tick
+// Entities are always sorted by handle index, so two snapshots can be compared in a single merge pass
+class Snapshot {
+    private:
+        void add_entity(const Entity_Store& store, uint32_t index, uint32_t dense);
+
+    public:
+        uint64_t tick;
+        std::vector<Entity_Snapshot> entities;
+
+        Snapshot ();
+
+        void capture(uint64_t new_tick, const Entity_Store& store);
+        // Only captures the entities with the passed handle indices, which must be sorted
+        void capture(uint64_t new_tick, const Entity_Store& store, const std::vector<uint32_t>& indices);
+        // Writes a snapshot field back into the component it was quantized from
+        static void apply_field(Entity_Store& store, uint32_t dense, uint32_t field, int64_t value);
+};
+
+// Remembers recent snapshots, so that updates can be encoded against, or decoded from, an older one
+class Snapshot_History {
+    private:
+        static const uint32_t CAPACITY = 32;
+
+        Snapshot snapshots[CAPACITY];
+        bool used[CAPACITY];
+
+    public:
+        Snapshot_History ();
+
+        void clear();
+        Snapshot& add(uint64_t tick);
+        // Returns 0 if the tick's snapshot is not in the history
+        const Snapshot* find(uint64_t tick) const;
+};
+
+// Encodes a snapshot as a bit-level delta against a baseline snapshot the receiver already has
+// Unchanged entities cost a couple of bits, changed fields are sent as variable-length differences,
+// and entities missing from the baseline are sent in full
+class Snapshot_Codec {
+    public:
+        // Pass 0 for baseline to encode every entity in full
+        static void write(RakNet::BitStream& bitstream, const Snapshot* baseline, const Snapshot& current);
+        // Reads the ticks of the snapshot and of the baseline it was encoded against, before read is called
+        static bool read_header(RakNet::BitStream& bitstream, uint64_t& tick, uint64_t& baseline_tick);
+        // baseline must be the snapshot for the baseline tick from read_header, or 0 if that tick was 0
+        // Returns false if the data is malformed
+        static bool read(RakNet::BitStream& bitstream, const Snapshot* baseline, Snapshot& result);
+};
+
+#endif
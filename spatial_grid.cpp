@@ -0,0 +1,202 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "spatial_grid.h"
+
+using namespace std;
+
+const uint32_t Spatial_Grid::INVALID = 0xFFFFFFFF;
+
+Spatial_Grid::Spatial_Grid () {
+    cell_size = Fixed::from_int(1);
+    cells_x = 0;
+    cells_y = 0;
+}
+
+void Spatial_Grid::setup (const Fixed& new_world_width, const Fixed& new_world_height, const Fixed& new_cell_size) {
+    world_width = new_world_width;
+    world_height = new_world_height;
+    cell_size = new_cell_size > Fixed() ? new_cell_size : Fixed::from_int(1);
+
+    cells_x = (uint32_t) ((world_width.raw + cell_size.raw - 1) / cell_size.raw);
+    cells_y = (uint32_t) ((world_height.raw + cell_size.raw - 1) / cell_size.raw);
+
+    if (cells_x == 0) {
+        cells_x = 1;
+    }
+
+    if (cells_y == 0) {
+        cells_y = 1;
+    }
+
+    clear();
+}
+
+void Spatial_Grid::clear () {
+    cell_heads.assign((size_t) cells_x * (size_t) cells_y, INVALID);
+
+    entry_cells.clear();
+    entry_next.clear();
+    entry_previous.clear();
+    entry_x.clear();
+    entry_y.clear();
+}
+
+Fixed Spatial_Grid::get_world_width () const {
+    return world_width;
+}
+
+Fixed Spatial_Grid::get_world_height () const {
+    return world_height;
+}
+
+Fixed Spatial_Grid::get_cell_size () const {
+    return cell_size;
+}
+
+uint32_t Spatial_Grid::get_cell_x (const Fixed& x) const {
+    // Anything outside of the world is clamped into the border cells
+    if (x.raw <= 0) {
+        return 0;
+    }
+
+    uint32_t cell_x = (uint32_t) (x.raw / cell_size.raw);
+
+    return cell_x < cells_x ? cell_x : cells_x - 1;
+}
+
+uint32_t Spatial_Grid::get_cell_y (const Fixed& y) const {
+    if (y.raw <= 0) {
+        return 0;
+    }
+
+    uint32_t cell_y = (uint32_t) (y.raw / cell_size.raw);
+
+    return cell_y < cells_y ? cell_y : cells_y - 1;
+}
+
+void Spatial_Grid::link (uint32_t index, uint32_t cell) {
+    uint32_t head = cell_heads[cell];
+
+    entry_cells[index] = cell;
+    entry_previous[index] = INVALID;
+    entry_next[index] = head;
+
+    if (head != INVALID) {
+        entry_previous[head] = index;
+    }
+
+    cell_heads[cell] = index;
+}
+
+void Spatial_Grid::unlink (uint32_t index) {
+    uint32_t cell = entry_cells[index];
+    uint32_t next = entry_next[index];
+    uint32_t previous = entry_previous[index];
+
+    if (previous != INVALID) {
+        entry_next[previous] = next;
+    } else {
+        cell_heads[cell] = next;
+    }
+
+    if (next != INVALID) {
+        entry_previous[next] = previous;
+    }
+
+    entry_cells[index] = INVALID;
+    entry_next[index] = INVALID;
+    entry_previous[index] = INVALID;
+}
+
+bool Spatial_Grid::contains (uint32_t index) const {
+    return index < entry_cells.size() && entry_cells[index] != INVALID;
+}
+
+void Spatial_Grid::insert (uint32_t index, const Fixed& x, const Fixed& y) {
+    if (index >= entry_cells.size()) {
+        entry_cells.resize(index + 1, INVALID);
+        entry_next.resize(index + 1, INVALID);
+        entry_previous.resize(index + 1, INVALID);
+        entry_x.resize(index + 1);
+        entry_y.resize(index + 1);
+    }
+
+    if (contains(index)) {
+        unlink(index);
+    }
+
+    entry_x[index] = x;
+    entry_y[index] = y;
+
+    link(index, get_cell_y(y) * cells_x + get_cell_x(x));
+}
+
+void Spatial_Grid::update (uint32_t index, const Fixed& x, const Fixed& y) {
+    if (!contains(index)) {
+        insert(index, x, y);
+
+        return;
+    }
+
+    entry_x[index] = x;
+    entry_y[index] = y;
+
+    uint32_t cell = get_cell_y(y) * cells_x + get_cell_x(x);
+
+    if (cell != entry_cells[index]) {
+        unlink(index);
+        link(index, cell);
+    }
+}
+
+void Spatial_Grid::remove (uint32_t index) {
+    if (contains(index)) {
+        unlink(index);
+    }
+}
+
+void Spatial_Grid::query_rect (const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h,
+                               vector<uint32_t>& results) const {
+    uint32_t start_x = get_cell_x(x);
+    uint32_t start_y = get_cell_y(y);
+    uint32_t end_x = get_cell_x(x + w);
+    uint32_t end_y = get_cell_y(y + h);
+
+    for (uint32_t cell_y = start_y; cell_y <= end_y; cell_y++) {
+        for (uint32_t cell_x = start_x; cell_x <= end_x; cell_x++) {
+            // Cells fully inside of the rectangle do not need their entries tested
+            bool interior = cell_x > start_x && cell_x < end_x && cell_y > start_y && cell_y < end_y;
+
+            for (uint32_t index = cell_heads[cell_y * cells_x + cell_x]; index != INVALID; index = entry_next[index]) {
+                if (interior || (entry_x[index] >= x && entry_x[index] <= x + w && entry_y[index] >= y &&
+                                 entry_y[index] <= y + h)) {
+                    results.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+void Spatial_Grid::query_radius (const Fixed& x, const Fixed& y, const Fixed& radius,
+                                 vector<uint32_t>& results) const {
+    uint32_t start_x = get_cell_x(x - radius);
+    uint32_t start_y = get_cell_y(y - radius);
+    uint32_t end_x = get_cell_x(x + radius);
+    uint32_t end_y = get_cell_y(y + radius);
+    Fixed radius_squared = radius * radius;
+
+    for (uint32_t cell_y = start_y; cell_y <= end_y; cell_y++) {
+        for (uint32_t cell_x = start_x; cell_x <= end_x; cell_x++) {
+            for (uint32_t index = cell_heads[cell_y * cells_x + cell_x]; index != INVALID; index = entry_next[index]) {
+                Fixed distance_x = entry_x[index] - x;
+                Fixed distance_y = entry_y[index] - y;
+
+                if (distance_x * distance_x + distance_y * distance_y <= radius_squared) {
+                    results.push_back(index);
+                }
+            }
+        }
+    }
+}
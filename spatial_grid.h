@@ -0,0 +1,66 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef spatial_grid_h
+#define spatial_grid_h
+
+#include "fixed.h"
+
+#include <vector>
+#include <cstdint>
+
+// Uniform grid covering the world, used as a broadphase for collision, neighbor and culling queries
+// Entries are keyed by entity handle index, which is stable for the lifetime of an entity
+// Each cell is an intrusive doubly linked list, so moving an entry between cells is O(1) and
+// entries that stay in their cell cost nothing to update
+class Spatial_Grid {
+    private:
+        Fixed world_width;
+        Fixed world_height;
+        Fixed cell_size;
+        uint32_t cells_x;
+        uint32_t cells_y;
+
+        // Indexed by cell
+        std::vector<uint32_t> cell_heads;
+
+        // Indexed by entity handle index
+        std::vector<uint32_t> entry_cells;
+        std::vector<uint32_t> entry_next;
+        std::vector<uint32_t> entry_previous;
+        std::vector<Fixed> entry_x;
+        std::vector<Fixed> entry_y;
+
+        uint32_t get_cell_x(const Fixed& x) const;
+        uint32_t get_cell_y(const Fixed& y) const;
+        void link(uint32_t index, uint32_t cell);
+        void unlink(uint32_t index);
+
+    public:
+        static const uint32_t INVALID;
+
+        Spatial_Grid ();
+
+        // Clears all entries and resizes the grid to cover the passed world dimensions
+        void setup(const Fixed& new_world_width, const Fixed& new_world_height, const Fixed& new_cell_size);
+        void clear();
+
+        Fixed get_world_width() const;
+        Fixed get_world_height() const;
+        Fixed get_cell_size() const;
+
+        bool contains(uint32_t index) const;
+        void insert(uint32_t index, const Fixed& x, const Fixed& y);
+        // Only relinks the entry if it has crossed into another cell
+        void update(uint32_t index, const Fixed& x, const Fixed& y);
+        void remove(uint32_t index);
+
+        // Each query appends matching entity handle indices to results
+        // The cost is proportional to the number of cells overlapped plus the number of entries in those cells
+        void query_rect(const Fixed& x, const Fixed& y, const Fixed& w, const Fixed& h,
+                        std::vector<uint32_t>& results) const;
+        void query_radius(const Fixed& x, const Fixed& y, const Fixed& radius, std::vector<uint32_t>& results) const;
+};
+
+#endif
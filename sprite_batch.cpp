@@ -0,0 +1,136 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "sprite_batch.h"
+
+#include <render.h>
+#include <game_manager.h>
+
+#include <algorithm>
+
+using namespace std;
+
+Sprite::Sprite () {
+    image = 0;
+    color = "";
+    x = 0.0;
+    y = 0.0;
+    w = 0.0;
+    h = 0.0;
+    opacity = 1.0;
+    angle = 0.0;
+}
+
+Sprite_Batch::Sprite_Batch () {
+    view_x = 0.0;
+    view_y = 0.0;
+    view_w = 0.0;
+    view_h = 0.0;
+    zoom = 1.0;
+
+    sprite_count = 0;
+    culled_count = 0;
+    batch_count = 0;
+}
+
+void Sprite_Batch::begin () {
+    sprites.clear();
+    order.clear();
+    texture_ids.clear();
+
+    zoom = Game_Manager::camera_zoom;
+    view_x = Game_Manager::camera.x / zoom;
+    view_y = Game_Manager::camera.y / zoom;
+    view_w = Game_Manager::camera.w / zoom;
+    view_h = Game_Manager::camera.h / zoom;
+
+    sprite_count = 0;
+    culled_count = 0;
+    batch_count = 0;
+}
+
+void Sprite_Batch::add (Sprite_Layer layer, Image_Data* image, double x, double y, double w, double h,
+                        double opacity, double angle, const char* color) {
+    sprite_count++;
+
+    // A rotated sprite is culled by a square large enough to hold it at any angle
+    double margin = angle != 0.0 ? (w + h) / 2.0 : 0.0;
+
+    if (x + w + margin < view_x || y + h + margin < view_y || x - margin > view_x + view_w ||
+        y - margin > view_y + view_h) {
+        culled_count++;
+
+        return;
+    }
+
+    uint32_t texture_id = 0;
+
+    if (image != 0) {
+        unordered_map<const Image_Data*, uint32_t>::iterator it = texture_ids.find(image);
+
+        if (it != texture_ids.end()) {
+            texture_id = it->second;
+        } else {
+            texture_id = texture_ids.size() + 1;
+            texture_ids[image] = texture_id;
+        }
+    }
+
+    // Layer, then texture, then the order the sprite was added in
+    order.push_back(((uint64_t) layer << 56) | ((uint64_t) texture_id << 32) | sprites.size());
+
+    sprites.push_back(Sprite());
+
+    Sprite& sprite = sprites.back();
+
+    sprite.image = image;
+    sprite.color = color;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.w = w;
+    sprite.h = h;
+    sprite.opacity = opacity;
+    sprite.angle = angle;
+}
+
+void Sprite_Batch::add_rectangle (Sprite_Layer layer, double x, double y, double w, double h, const char* color,
+                                  double opacity) {
+    add(layer, 0, x, y, w, h, opacity, 0.0, color);
+}
+
+void Sprite_Batch::render () {
+    sort(order.begin(), order.end());
+
+    const Image_Data* last_image = 0;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const Sprite& sprite = sprites[order[i] & 0xFFFFFFFF];
+        double x = sprite.x * zoom - Game_Manager::camera.x;
+        double y = sprite.y * zoom - Game_Manager::camera.y;
+
+        if (i == 0 || sprite.image != last_image) {
+            batch_count++;
+            last_image = sprite.image;
+        }
+
+        if (sprite.image != 0) {
+            Render::render_texture(x, y, sprite.image, sprite.opacity, sprite.w * zoom / sprite.image->w,
+                                   sprite.h * zoom / sprite.image->h, sprite.angle, sprite.color);
+        } else {
+            Render::render_rectangle(x, y, sprite.w * zoom, sprite.h * zoom, sprite.opacity, sprite.color);
+        }
+    }
+}
+
+uint32_t Sprite_Batch::get_sprite_count () const {
+    return sprite_count;
+}
+
+uint32_t Sprite_Batch::get_culled_count () const {
+    return culled_count;
+}
+
+uint32_t Sprite_Batch::get_batch_count () const {
+    return batch_count;
+}
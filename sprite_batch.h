@@ -0,0 +1,86 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef sprite_batch_h
+#define sprite_batch_h
+
+#include <image_data.h>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Drawn in this order, bottom to top
+enum Sprite_Layer {
+    SPRITE_LAYER_WAKES,
+    SPRITE_LAYER_SHIPS,
+    SPRITE_LAYER_SAILS,
+    SPRITE_LAYER_PROJECTILES,
+    SPRITE_LAYER_EFFECTS,
+    SPRITE_LAYER_COUNT
+};
+
+class Sprite {
+    public:
+        // 0 for a solid rectangle
+        Image_Data* image;
+        // Must outlive the batch, such as a string literal
+        const char* color;
+        // In world coordinates
+        double x;
+        double y;
+        double w;
+        double h;
+        double opacity;
+        double angle;
+
+        Sprite ();
+};
+
+// Collects a frame's sprites so that they can be culled against the camera and drawn sorted by layer,
+// and within each layer by texture
+// Sprites in the same layer and with the same texture keep the order they were added in
+// Consecutive draws from one texture are merged into a single draw call by the renderer, so the number of batches is
+// roughly the number of draw calls the sprites cost
+class Sprite_Batch {
+    private:
+        std::vector<Sprite> sprites;
+        // A sort key for each sprite that survived culling, with its index into sprites in the low 32 bits
+        std::vector<uint64_t> order;
+        // Each texture seen this frame, numbered in the order it was first seen
+        // Rectangles are always texture 0
+        std::unordered_map<const Image_Data*, uint32_t> texture_ids;
+
+        double view_x;
+        double view_y;
+        double view_w;
+        double view_h;
+        double zoom;
+
+        uint32_t sprite_count;
+        uint32_t culled_count;
+        uint32_t batch_count;
+
+    public:
+        Sprite_Batch ();
+
+        // Starts a new frame, viewed through the current camera
+        void begin();
+        // Sprites entirely outside of the camera are culled here
+        // Images are stretched to w, h
+        void add(Sprite_Layer layer, Image_Data* image, double x, double y, double w, double h, double opacity = 1.0,
+                 double angle = 0.0, const char* color = "");
+        void add_rectangle(Sprite_Layer layer, double x, double y, double w, double h, const char* color,
+                           double opacity = 1.0);
+        // Sorts and draws every sprite added since begin
+        void render();
+
+        // These count everything since the last begin
+        // The number of sprites added, including those culled
+        uint32_t get_sprite_count() const;
+        uint32_t get_culled_count() const;
+        uint32_t get_batch_count() const;
+};
+
+#endif
@@ -0,0 +1,52 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "state_hash.h"
+
+using namespace std;
+
+State_Hash_History::State_Hash_History () {
+    clear();
+}
+
+uint64_t State_Hash_History::mix (uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 31;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 29;
+
+    return hash;
+}
+
+void State_Hash_History::clear () {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+        ticks[i] = 0;
+        hashes[i] = 0;
+        used[i] = false;
+    }
+}
+
+void State_Hash_History::add (uint64_t tick, uint64_t hash) {
+    uint32_t slot = (uint32_t) (tick % CAPACITY);
+
+    ticks[slot] = tick;
+    hashes[slot] = hash;
+    used[slot] = true;
+}
+
+bool State_Hash_History::get (uint64_t tick, uint64_t& hash) const {
+    uint32_t slot = (uint32_t) (tick % CAPACITY);
+
+    if (used[slot] && ticks[slot] == tick) {
+        hash = hashes[slot];
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t State_Hash_History::get_capacity () const {
+    return CAPACITY;
+}
@@ -0,0 +1,33 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef state_hash_h
+#define state_hash_h
+
+#include <cstdint>
+
+// Remembers the simulation state hash of each recent tick, so that hashes reported by peers can be checked
+// Hashes are chained, with each tick's hash folding in the previous one, so the first tick whose hashes differ
+// is the first tick that desynced
+class State_Hash_History {
+    private:
+        static const uint32_t CAPACITY = 512;
+
+        uint64_t ticks[CAPACITY];
+        uint64_t hashes[CAPACITY];
+        bool used[CAPACITY];
+
+    public:
+        State_Hash_History ();
+
+        static uint64_t mix(uint64_t hash, uint64_t value);
+
+        void clear();
+        void add(uint64_t tick, uint64_t hash);
+        // Returns false if the tick is too old, or has not happened yet
+        bool get(uint64_t tick, uint64_t& hash) const;
+        uint32_t get_capacity() const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "tag_registry.h"
+
+#include <log.h>
+
+using namespace std;
+
+const uint32_t Tag_Name_Index::INVALID = 0xFFFFFFFF;
+
+Tag_Name_Index::Tag_Name_Index (const string& new_type_name) {
+    type_name = new_type_name;
+}
+
+void Tag_Name_Index::clear () {
+    names.clear();
+    handles.clear();
+}
+
+uint32_t Tag_Name_Index::add (const string& name) {
+    uint32_t handle = (uint32_t) names.size();
+
+    names.push_back(name);
+
+    if (!handles.insert(make_pair(name, handle)).second) {
+        Log::add_error("Duplicate " + type_name + " '" + name + "'");
+    }
+
+    return handle;
+}
+
+uint32_t Tag_Name_Index::find (const string& name) const {
+    unordered_map<string, uint32_t>::const_iterator existing = handles.find(name);
+
+    return existing != handles.end() ? existing->second : INVALID;
+}
+
+uint32_t Tag_Name_Index::get_handle (const string& name) const {
+    uint32_t handle = find(name);
+
+    if (handle == INVALID) {
+        Log::add_error("Error accessing " + type_name + " '" + name + "'");
+    }
+
+    return handle;
+}
+
+const string& Tag_Name_Index::get_name (uint32_t handle) const {
+    static const string unknown = "";
+
+    return handle < names.size() ? names[handle] : unknown;
+}
+
+uint32_t Tag_Name_Index::get_count () const {
+    return (uint32_t) names.size();
+}
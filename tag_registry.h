@@ -0,0 +1,128 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef tag_registry_h
+#define tag_registry_h
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Maps the names of one type of game tag to dense handles, assigned in the order the tags are loaded
+// Every peer loads the same data, so a handle means the same tag on every peer and may be sent over the network
+class Tag_Name_Index {
+    private:
+        // Used in error messages
+        std::string type_name;
+        std::vector<std::string> names;
+        std::unordered_map<std::string, uint32_t> handles;
+
+    public:
+        static const uint32_t INVALID;
+
+        Tag_Name_Index (const std::string& new_type_name);
+
+        void clear();
+        // Returns the new tag's handle
+        // A name that is already taken is an error, and the name keeps referring to the first tag with it
+        uint32_t add(const std::string& name);
+
+        // Returns INVALID without logging if the tag does not exist
+        uint32_t find(const std::string& name) const;
+        // Returns INVALID and logs an error if the tag does not exist
+        uint32_t get_handle(const std::string& name) const;
+        const std::string& get_name(uint32_t handle) const;
+        uint32_t get_count() const;
+};
+
+// Stores every tag of one type, such as ship classes or cannon types
+// Look a name up once, when the data or a save is loaded, and then keep the handle, which indexes straight into
+// the tags
+// Handles stay valid until the registry is cleared, but references do not outlive the next add
+template<typename Tag>
+class Tag_Registry {
+    private:
+        Tag_Name_Index index;
+        std::vector<Tag> tags;
+
+    public:
+        Tag_Registry (const std::string& type_name);
+
+        void clear();
+        // Adds a new default constructed tag and returns its handle
+        uint32_t add(const std::string& name);
+
+        uint32_t find(const std::string& name) const;
+        uint32_t get_handle(const std::string& name) const;
+        const std::string& get_name(uint32_t handle) const;
+        uint32_t get_count() const;
+        bool is_valid(uint32_t handle) const;
+
+        Tag& get(uint32_t handle);
+        const Tag& get(uint32_t handle) const;
+        // Returns 0 and logs an error if the tag does not exist
+        // For occasional lookups by name, rather than inside of loops
+        Tag* get_by_name(const std::string& name);
+};
+
+template<typename Tag>
+Tag_Registry<Tag>::Tag_Registry (const std::string& type_name) : index(type_name) {}
+
+template<typename Tag>
+void Tag_Registry<Tag>::clear () {
+    index.clear();
+    tags.clear();
+}
+
+template<typename Tag>
+uint32_t Tag_Registry<Tag>::add (const std::string& name) {
+    tags.push_back(Tag());
+
+    return index.add(name);
+}
+
+template<typename Tag>
+uint32_t Tag_Registry<Tag>::find (const std::string& name) const {
+    return index.find(name);
+}
+
+template<typename Tag>
+uint32_t Tag_Registry<Tag>::get_handle (const std::string& name) const {
+    return index.get_handle(name);
+}
+
+template<typename Tag>
+const std::string& Tag_Registry<Tag>::get_name (uint32_t handle) const {
+    return index.get_name(handle);
+}
+
+template<typename Tag>
+uint32_t Tag_Registry<Tag>::get_count () const {
+    return (uint32_t) tags.size();
+}
+
+template<typename Tag>
+bool Tag_Registry<Tag>::is_valid (uint32_t handle) const {
+    return handle < tags.size();
+}
+
+template<typename Tag>
+inline Tag& Tag_Registry<Tag>::get (uint32_t handle) {
+    return tags[handle];
+}
+
+template<typename Tag>
+inline const Tag& Tag_Registry<Tag>::get (uint32_t handle) const {
+    return tags[handle];
+}
+
+template<typename Tag>
+Tag* Tag_Registry<Tag>::get_by_name (const std::string& name) {
+    uint32_t handle = index.get_handle(name);
+
+    return handle != Tag_Name_Index::INVALID ? &tags[handle] : 0;
+}
+
+#endif
@@ -0,0 +1,98 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "text_cache.h"
+#include "game_constants.h"
+
+#include <render.h>
+#include <rtt_manager.h>
+#include <game_window.h>
+#include <engine_strings.h>
+
+using namespace std;
+
+Text_Cache_Slot::Text_Cache_Slot () {
+    text = "";
+    font = 0;
+    color = "";
+    last_used = 0;
+}
+
+const uint32_t Text_Cache::INVALID = 0xFFFFFFFF;
+
+vector<string> Text_Cache::texture_names;
+vector<Text_Cache_Slot> Text_Cache::slots;
+uint64_t Text_Cache::use_count = 0;
+
+void Text_Cache::add_textures () {
+    texture_names.clear();
+
+    for (uint32_t i = 0; i < Game_Constants::TEXT_CACHE_TEXTURE_COUNT; i++) {
+        texture_names.push_back("text_cache_" + Strings::num_to_string(i));
+
+        Rtt_Manager::add_texture(texture_names.back(), Game_Constants::TEXT_CACHE_TEXTURE_WIDTH,
+                                 Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT);
+    }
+
+    slots.assign(texture_names.size(), Text_Cache_Slot());
+}
+
+uint32_t Text_Cache::find_slot (const Bitmap_Font* font, const string& text, const string& color) {
+    for (uint32_t i = 0; i < slots.size(); i++) {
+        if (slots[i].font == font && slots[i].text == text && slots[i].color == color) {
+            return i;
+        }
+    }
+
+    return INVALID;
+}
+
+uint32_t Text_Cache::get_least_recently_used_slot () {
+    uint32_t oldest = 0;
+
+    for (uint32_t i = 1; i < slots.size(); i++) {
+        if (slots[i].last_used < slots[oldest].last_used) {
+            oldest = i;
+        }
+    }
+
+    return oldest;
+}
+
+void Text_Cache::show (Bitmap_Font* font, double x, double y, const string& text, const string& color) {
+    if (slots.empty()) {
+        font->show(x, y, text, color);
+
+        return;
+    }
+
+    uint32_t slot = find_slot(font, text, color);
+
+    if (slot == INVALID) {
+        if (Strings::longest_line(text) * font->spacing_x > Game_Constants::TEXT_CACHE_TEXTURE_WIDTH ||
+            (Strings::newline_count(text) + 1) * font->spacing_y > Game_Constants::TEXT_CACHE_TEXTURE_HEIGHT) {
+            font->show(x, y, text, color);
+
+            return;
+        }
+
+        slot = get_least_recently_used_slot();
+
+        Text_Cache_Slot& new_slot = slots[slot];
+
+        new_slot.text = text;
+        new_slot.font = font;
+        new_slot.color = color;
+
+        Rtt_Manager::set_render_target(texture_names[slot]);
+        // Otherwise the slot's previous text would show through wherever the new text has no glyphs
+        Game_Window::clear_renderer(Color(0, 0, 0, 0));
+        font->show(0.0, 0.0, text, color);
+        Rtt_Manager::reset_render_target();
+    }
+
+    slots[slot].last_used = ++use_count;
+
+    Render::render_rtt(x, y, Rtt_Manager::get_texture(texture_names[slot]));
+}
@@ -0,0 +1,49 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef text_cache_h
+#define text_cache_h
+
+#include <font.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Text_Cache_Slot {
+    public:
+        // The text, font and color the texture was drawn with
+        std::string text;
+        const Bitmap_Font* font;
+        std::string color;
+        uint64_t last_used;
+
+        Text_Cache_Slot ();
+};
+
+// Keeps recently shown text drawn into a pool of render targets, so that text which is the same as the last time
+// it was shown costs a single textured quad rather than laying out and drawing every glyph again
+// Text that does not fit in a texture, or that is shown before the textures exist, is drawn directly
+// Text that changes nearly every frame should be drawn directly with Bitmap_Font::show instead, since it would never
+// be drawn from the cache, and would push out text that is
+class Text_Cache {
+    private:
+        static std::vector<std::string> texture_names;
+        static std::vector<Text_Cache_Slot> slots;
+        static uint64_t use_count;
+
+        static uint32_t find_slot(const Bitmap_Font* font, const std::string& text, const std::string& color);
+        static uint32_t get_least_recently_used_slot();
+
+    public:
+        static const uint32_t INVALID;
+
+        // Call this from Data_Manager::add_rtts
+        static void add_textures();
+
+        // Works like Bitmap_Font::show
+        static void show(Bitmap_Font* font, double x, double y, const std::string& text, const std::string& color);
+};
+
+#endif
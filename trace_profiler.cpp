@@ -0,0 +1,185 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "trace_profiler.h"
+
+#include <engine_strings.h>
+
+#include <fstream>
+
+using namespace std;
+
+namespace {
+    thread_local Trace_Thread_Buffer* thread_buffer = 0;
+
+    int64_t to_nanoseconds (chrono::steady_clock::time_point time) {
+        return chrono::duration_cast<chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    // Trace times are in microseconds, and nanoseconds are kept as the fractional part
+    void write_microseconds (ofstream& file, uint64_t nanoseconds) {
+        uint64_t fraction = nanoseconds % 1000;
+
+        file << nanoseconds / 1000 << "." << (char) ('0' + fraction / 100) << (char) ('0' + fraction / 10 % 10) <<
+        (char) ('0' + fraction % 10);
+    }
+
+    void write_string (ofstream& file, const string& value) {
+        file << "\"";
+
+        for (size_t i = 0; i < value.length(); i++) {
+            if (value[i] == '"' || value[i] == '\\') {
+                file << "\\";
+            }
+
+            file << value[i];
+        }
+
+        file << "\"";
+    }
+}
+
+atomic<bool> Trace_Profiler::enabled(false);
+mutex* Trace_Profiler::registry_mutex = new mutex();
+vector<Trace_Thread_Buffer*>* Trace_Profiler::buffers = new vector<Trace_Thread_Buffer*>();
+atomic<int64_t> Trace_Profiler::session_start(0);
+atomic<uint64_t> Trace_Profiler::dropped_events(0);
+const uint32_t Trace_Profiler::MAX_EVENTS_PER_THREAD = 1048576;
+
+Trace_Thread_Buffer* Trace_Profiler::get_thread_buffer () {
+    if (thread_buffer == 0) {
+        Trace_Thread_Buffer* buffer = new Trace_Thread_Buffer();
+        lock_guard<mutex> lock(*registry_mutex);
+
+        buffers->push_back(buffer);
+
+        buffer->thread_id = (uint32_t) buffers->size();
+        buffer->thread_name = "thread " + Strings::num_to_string(buffer->thread_id);
+
+        thread_buffer = buffer;
+    }
+
+    return thread_buffer;
+}
+
+void Trace_Profiler::start () {
+    lock_guard<mutex> lock(*registry_mutex);
+
+    for (size_t i = 0; i < buffers->size(); i++) {
+        lock_guard<mutex> buffer_lock((*buffers)[i]->mutex);
+
+        (*buffers)[i]->events.clear();
+    }
+
+    dropped_events.store(0, memory_order_relaxed);
+    session_start.store(to_nanoseconds(chrono::steady_clock::now()), memory_order_relaxed);
+    enabled.store(true, memory_order_release);
+}
+
+void Trace_Profiler::stop () {
+    enabled.store(false, memory_order_release);
+}
+
+bool Trace_Profiler::dump (const string& path) {
+    stop();
+
+    ofstream file(path.c_str(), ios::trunc);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    lock_guard<mutex> lock(*registry_mutex);
+    bool first = true;
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    for (size_t i = 0; i < buffers->size(); i++) {
+        Trace_Thread_Buffer* buffer = (*buffers)[i];
+        lock_guard<mutex> buffer_lock(buffer->mutex);
+
+        if (buffer->events.empty()) {
+            continue;
+        }
+
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" <<
+        buffer->thread_id << ",\"args\":{\"name\":";
+        write_string(file, buffer->thread_name);
+        file << "}}";
+
+        first = false;
+
+        for (size_t n = 0; n < buffer->events.size(); n++) {
+            const Trace_Event& event = buffer->events[n];
+
+            file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category <<
+            "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"ts\":";
+            write_microseconds(file, event.begin);
+            file << ",\"dur\":";
+            write_microseconds(file, event.duration);
+            file << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+uint64_t Trace_Profiler::get_event_count () {
+    lock_guard<mutex> lock(*registry_mutex);
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < buffers->size(); i++) {
+        lock_guard<mutex> buffer_lock((*buffers)[i]->mutex);
+
+        count += (*buffers)[i]->events.size();
+    }
+
+    return count;
+}
+
+uint64_t Trace_Profiler::get_dropped_event_count () {
+    return dropped_events.load(memory_order_relaxed);
+}
+
+void Trace_Profiler::set_thread_name (const string& name) {
+    Trace_Thread_Buffer* buffer = get_thread_buffer();
+    lock_guard<mutex> lock(buffer->mutex);
+
+    buffer->thread_name = name;
+}
+
+void Trace_Profiler::add_event (const char* name, const char* category, chrono::steady_clock::time_point begin,
+                                chrono::steady_clock::time_point end) {
+    // Scopes still open when the session stopped are left out
+    if (!enabled.load(memory_order_acquire)) {
+        return;
+    }
+
+    int64_t begin_offset = to_nanoseconds(begin) - session_start.load(memory_order_relaxed);
+
+    // The scope began during a previous session
+    if (begin_offset < 0) {
+        return;
+    }
+
+    Trace_Thread_Buffer* buffer = get_thread_buffer();
+    lock_guard<mutex> lock(buffer->mutex);
+
+    if (buffer->events.size() >= MAX_EVENTS_PER_THREAD) {
+        dropped_events.fetch_add(1, memory_order_relaxed);
+
+        return;
+    }
+
+    buffer->events.push_back(Trace_Event());
+
+    Trace_Event& event = buffer->events.back();
+
+    event.name = name;
+    event.category = category;
+    event.begin = (uint64_t) begin_offset;
+    event.duration = (uint64_t) (to_nanoseconds(end) - to_nanoseconds(begin));
+}
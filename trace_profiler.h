@@ -0,0 +1,105 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef trace_profiler_h
+#define trace_profiler_h
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class Trace_Event {
+    public:
+        // Names and categories must be string literals, as only the pointers are kept
+        const char* name;
+        const char* category;
+        // Nanoseconds since the session started
+        uint64_t begin;
+        uint64_t duration;
+};
+
+// The events recorded by one thread
+// The lock is only ever contended while a session is being started or dumped
+class Trace_Thread_Buffer {
+    public:
+        std::mutex mutex;
+        uint32_t thread_id;
+        std::string thread_name;
+        std::vector<Trace_Event> events;
+};
+
+// Records timed scopes from any thread, and writes them out in the Chrome Trace Event format,
+// which can be opened in chrome://tracing or Perfetto
+// While no session is running, a scope costs a single relaxed atomic load
+class Trace_Profiler {
+    private:
+        static std::atomic<bool> enabled;
+        // Heap allocated and never freed, so that threads still running at exit never touch destroyed statics
+        static std::mutex* registry_mutex;
+        static std::vector<Trace_Thread_Buffer*>* buffers;
+        // In steady_clock nanoseconds, so that threads finishing a scope can read it while a new session starts
+        static std::atomic<int64_t> session_start;
+        static std::atomic<uint64_t> dropped_events;
+
+        static Trace_Thread_Buffer* get_thread_buffer();
+
+    public:
+        // Stops a runaway session from using up all of the memory
+        static const uint32_t MAX_EVENTS_PER_THREAD;
+
+        static bool is_enabled();
+        // Discards any events from a previous session
+        static void start();
+        static void stop();
+        // Stops the session if it is still running
+        // Returns false if the file could not be written
+        static bool dump(const std::string& path);
+        static uint64_t get_event_count();
+        // The number of events thrown away because a thread reached MAX_EVENTS_PER_THREAD
+        static uint64_t get_dropped_event_count();
+
+        // Labels the calling thread's track in the timeline
+        static void set_thread_name(const std::string& name);
+        static void add_event(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+                              std::chrono::steady_clock::time_point end);
+};
+
+// Records the enclosing scope as one event, if a session was running when the scope began
+// Scopes nest naturally, as the viewer stacks events on the same thread by their times
+class Trace_Scope {
+    private:
+        const char* name;
+        const char* category;
+        bool active;
+        std::chrono::steady_clock::time_point begin;
+
+    public:
+        Trace_Scope (const char* new_name, const char* new_category);
+        ~Trace_Scope ();
+};
+
+inline bool Trace_Profiler::is_enabled () {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+inline Trace_Scope::Trace_Scope (const char* new_name, const char* new_category) {
+    name = new_name;
+    category = new_category;
+    active = Trace_Profiler::is_enabled();
+
+    if (active) {
+        begin = std::chrono::steady_clock::now();
+    }
+}
+
+inline Trace_Scope::~Trace_Scope () {
+    if (active) {
+        Trace_Profiler::add_event(name, category, begin, std::chrono::steady_clock::now());
+    }
+}
+
+#endif
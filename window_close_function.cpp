@@ -2,6 +2,8 @@
 /* This file is licensed under the MIT License. */
 /* See the file docs/LICENSE.txt for the full license text. */
 
+#include "input_dispatch.h"
+
 #include <window.h>
 #include <log.h>
 #include <engine_input.h>
@@ -13,6 +15,9 @@ void Window::exec_close_function () {
     if (close_function.length() > 0) {
         if (close_function == "configure_command") {
             Object_Manager::configure_command = -1;
+
+            // The command may have just been bound to a different key or button
+            Input_Dispatch::rebuild();
         } else {
             Log::add_error("Invalid close function: '" + close_function + "'");
         }
@@ -0,0 +1,133 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "world_generator.h"
+#include "simulation_rng.h"
+
+using namespace std;
+
+namespace {
+    // Each octave halves the wavelength and the amplitude of the one before it
+    const uint32_t OCTAVE_COUNT = 6;
+    // Wavelength of the first octave, as a power of two number of tiles
+    const uint32_t BASE_WAVELENGTH_SHIFT = 8;
+
+    // Upper height bound of each terrain type, with everything above the last bound being forest
+    const uint32_t DEEP_WATER_HEIGHT = 38500;
+    const uint32_t WATER_HEIGHT = 42500;
+    const uint32_t SHOAL_HEIGHT = 44000;
+    const uint32_t SAND_HEIGHT = 45000;
+    const uint32_t GRASS_HEIGHT = 50000;
+
+    // One in this many chunks with a suitable coast has a port
+    const uint32_t PORT_CHANCE = 3;
+
+    uint64_t mix (uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+
+        return value;
+    }
+
+    // Returns a value in [0, 65535] for a lattice point of an octave
+    uint32_t get_lattice_value (uint64_t seed, uint32_t octave, uint32_t x, uint32_t y) {
+        return (uint32_t) (mix(seed ^ mix(((uint64_t) octave << 58) ^ ((uint64_t) x << 29) ^ y)) >> 48);
+    }
+
+    // Returns t eased with 3t^2 - 2t^3, where t and the result are in [0, 65536]
+    int64_t ease (int64_t t) {
+        return ((t * t) >> 16) * (3 * 65536 - 2 * t) >> 16;
+    }
+
+    int64_t interpolate (int64_t a, int64_t b, int64_t t) {
+        return a + (((b - a) * t) >> 16);
+    }
+
+    bool is_water (uint8_t tile) {
+        return tile == WORLD_TILE_DEEP_WATER || tile == WORLD_TILE_WATER || tile == WORLD_TILE_SHOAL;
+    }
+}
+
+uint32_t World_Generator::get_height (uint64_t seed, uint32_t tile_x, uint32_t tile_y) {
+    int64_t total = 0;
+    int64_t amplitude_total = 0;
+
+    for (uint32_t octave = 0; octave < OCTAVE_COUNT; octave++) {
+        uint32_t shift = BASE_WAVELENGTH_SHIFT - octave;
+        uint32_t x = tile_x >> shift;
+        uint32_t y = tile_y >> shift;
+        // Position within the lattice cell, scaled to [0, 65536)
+        int64_t fraction_x = ease((int64_t) (tile_x & ((1 << shift) - 1)) << (16 - shift));
+        int64_t fraction_y = ease((int64_t) (tile_y & ((1 << shift) - 1)) << (16 - shift));
+        int64_t top = interpolate(get_lattice_value(seed, octave, x, y), get_lattice_value(seed, octave, x + 1, y),
+                                  fraction_x);
+        int64_t bottom = interpolate(get_lattice_value(seed, octave, x, y + 1),
+                                     get_lattice_value(seed, octave, x + 1, y + 1), fraction_x);
+        int64_t amplitude = (int64_t) 1 << (OCTAVE_COUNT - 1 - octave);
+
+        total += interpolate(top, bottom, fraction_y) * amplitude;
+        amplitude_total += amplitude;
+    }
+
+    return (uint32_t) (total / amplitude_total);
+}
+
+uint8_t World_Generator::get_terrain (uint32_t height) {
+    if (height < DEEP_WATER_HEIGHT) {
+        return WORLD_TILE_DEEP_WATER;
+    } else if (height < WATER_HEIGHT) {
+        return WORLD_TILE_WATER;
+    } else if (height < SHOAL_HEIGHT) {
+        return WORLD_TILE_SHOAL;
+    } else if (height < SAND_HEIGHT) {
+        return WORLD_TILE_SAND;
+    } else if (height < GRASS_HEIGHT) {
+        return WORLD_TILE_GRASS;
+    } else {
+        return WORLD_TILE_FOREST;
+    }
+}
+
+void World_Generator::generate_chunk (uint64_t seed, uint32_t chunk_x, uint32_t chunk_y, uint32_t chunk_tiles,
+                                      vector<uint8_t>& tiles, vector<uint32_t>& ports) {
+    uint32_t first_x = chunk_x * chunk_tiles;
+    uint32_t first_y = chunk_y * chunk_tiles;
+
+    tiles.resize(chunk_tiles * chunk_tiles);
+    ports.clear();
+
+    for (uint32_t y = 0; y < chunk_tiles; y++) {
+        for (uint32_t x = 0; x < chunk_tiles; x++) {
+            tiles[y * chunk_tiles + x] = get_terrain(get_height(seed, first_x + x, first_y + y));
+        }
+    }
+
+    // A port goes on a sand tile next to open water
+    // Only tiles away from the chunk's edges are considered, so that a chunk never depends on its neighbors
+    vector<uint32_t> candidates;
+
+    for (uint32_t y = 1; y + 1 < chunk_tiles; y++) {
+        for (uint32_t x = 1; x + 1 < chunk_tiles; x++) {
+            uint32_t tile = y * chunk_tiles + x;
+
+            if (tiles[tile] == WORLD_TILE_SAND &&
+                (is_water(tiles[tile - 1]) || is_water(tiles[tile + 1]) || is_water(tiles[tile - chunk_tiles]) ||
+                 is_water(tiles[tile + chunk_tiles]))) {
+                candidates.push_back(tile);
+            }
+        }
+    }
+
+    Simulation_Rng rng(mix(seed ^ mix(((uint64_t) chunk_x << 32) | chunk_y)));
+
+    if (!candidates.empty() && rng.range(0, PORT_CHANCE - 1) == 0) {
+        uint32_t port = candidates[rng.range(0, (uint32_t) candidates.size() - 1)];
+
+        tiles[port] = WORLD_TILE_PORT;
+        ports.push_back(port);
+    }
+}
@@ -0,0 +1,37 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef world_generator_h
+#define world_generator_h
+
+#include <vector>
+#include <cstdint>
+
+enum World_Tile {
+    WORLD_TILE_DEEP_WATER,
+    WORLD_TILE_WATER,
+    WORLD_TILE_SHOAL,
+    WORLD_TILE_SAND,
+    WORLD_TILE_GRASS,
+    WORLD_TILE_FOREST,
+    WORLD_TILE_PORT,
+    WORLD_TILE_COUNT
+};
+
+// Procedurally generates the sea, one chunk at a time
+// Generation uses only integer arithmetic, so the same seed produces the same tiles on every platform, and a chunk
+// depends on nothing but the seed and its own coordinates, so chunks can be generated in any order, on any thread
+class World_Generator {
+    private:
+        // Returns a height in [0, 65535]
+        static uint32_t get_height(uint64_t seed, uint32_t tile_x, uint32_t tile_y);
+        static uint8_t get_terrain(uint32_t height);
+
+    public:
+        // Fills tiles with chunk_tiles * chunk_tiles tiles, row by row, and ports with the index of each port tile
+        static void generate_chunk(uint64_t seed, uint32_t chunk_x, uint32_t chunk_y, uint32_t chunk_tiles,
+                                   std::vector<uint8_t>& tiles, std::vector<uint32_t>& ports);
+};
+
+#endif
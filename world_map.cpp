@@ -0,0 +1,490 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#include "world_map.h"
+#include "game_constants.h"
+#include "trace_profiler.h"
+
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+using namespace std;
+
+World_Chunk::World_Chunk () {
+    chunk_x = 0;
+    chunk_y = 0;
+    state = WORLD_CHUNK_STATE_GENERATING;
+    last_requested = 0;
+    revision = 0;
+}
+
+void World_Chunk::compress () {
+    compressed_tiles.clear();
+
+    for (size_t i = 0; i < tiles.size();) {
+        uint8_t tile = tiles[i];
+        uint32_t run = 1;
+
+        while (i + run < tiles.size() && tiles[i + run] == tile && run < 255) {
+            run++;
+        }
+
+        compressed_tiles.push_back((uint8_t) run);
+        compressed_tiles.push_back(tile);
+
+        i += run;
+    }
+
+    // Release the memory, rather than only emptying the vectors
+    vector<uint8_t>().swap(tiles);
+    vector<uint8_t>(compressed_tiles).swap(compressed_tiles);
+
+    state = WORLD_CHUNK_STATE_COMPRESSED;
+}
+
+void World_Chunk::decompress (uint32_t tile_count) {
+    tiles.clear();
+    tiles.reserve(tile_count);
+
+    for (size_t i = 0; i + 1 < compressed_tiles.size(); i += 2) {
+        tiles.insert(tiles.end(), (size_t) compressed_tiles[i], compressed_tiles[i + 1]);
+    }
+
+    vector<uint8_t>().swap(compressed_tiles);
+
+    state = WORLD_CHUNK_STATE_RESIDENT;
+}
+
+World_Map::World_Map () {
+    seed = 0;
+    chunk_tiles = 1;
+    tile_size = 1.0;
+    tiles_x = 0;
+    tiles_y = 0;
+    chunks_x = 0;
+    chunks_y = 0;
+    update_count = 0;
+    revision_count = 0;
+
+    generate_function = [this] (uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            Trace_Scope trace("generate_chunk", "world");
+            World_Chunk* chunk = generating_chunks[i];
+
+            World_Generator::generate_chunk(seed, chunk->chunk_x, chunk->chunk_y, chunk_tiles, chunk->tiles,
+                                            chunk->ports);
+        }
+    };
+}
+
+World_Map::~World_Map () {
+    clear();
+}
+
+bool World_Map::is_batch_running () const {
+    return batch.remaining.load(memory_order_acquire) > 0;
+}
+
+void World_Map::finish_batch () {
+    while (is_batch_running()) {
+        if (!Job_System::run_queued_job(batch)) {
+            this_thread::yield();
+        }
+    }
+
+    take_generated_chunks();
+}
+
+void World_Map::take_generated_chunks () {
+    for (size_t i = 0; i < generating_chunks.size(); i++) {
+        apply_edits(generating_chunks[i]);
+
+        generating_chunks[i]->state = WORLD_CHUNK_STATE_RESIDENT;
+        generating_chunks[i]->revision = ++revision_count;
+    }
+
+    generating_chunks.clear();
+}
+
+void World_Map::start_batch () {
+    uint32_t count = min((uint32_t) queued_chunks.size(), max(Game_Constants::WORLD_CHUNKS_PER_BATCH, (uint32_t) 1));
+
+    if (count == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        generating_chunks.push_back(chunks[queued_chunks[i]]);
+    }
+
+    queued_chunks.erase(queued_chunks.begin(), queued_chunks.begin() + count);
+
+    // Each chunk is one job, so idle workers pick chunks up as soon as they are free
+    Job_System::submit(batch, count, 1, generate_function);
+}
+
+void World_Map::compress_idle_chunks () {
+    uint64_t idle_updates = Game_Constants::WORLD_CHUNK_IDLE_UPDATES;
+    uint32_t compressed_count = 0;
+
+    for (unordered_map<uint32_t, World_Chunk*>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        World_Chunk* chunk = it->second;
+
+        if (chunk->state == WORLD_CHUNK_STATE_RESIDENT && chunk->last_requested + idle_updates < update_count) {
+            chunk->compress();
+        }
+
+        if (chunk->state == WORLD_CHUNK_STATE_COMPRESSED) {
+            compressed_count++;
+        }
+    }
+
+    if (compressed_count <= Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT) {
+        return;
+    }
+
+    // Discard the least recently requested compressed chunks
+    vector<pair<uint64_t, uint32_t>> compressed;
+
+    for (unordered_map<uint32_t, World_Chunk*>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        if (it->second->state == WORLD_CHUNK_STATE_COMPRESSED) {
+            compressed.push_back(make_pair(it->second->last_requested, it->first));
+        }
+    }
+
+    size_t discard_count = compressed_count - Game_Constants::WORLD_COMPRESSED_CHUNK_LIMIT;
+
+    nth_element(compressed.begin(), compressed.begin() + discard_count, compressed.end());
+
+    for (size_t i = 0; i < discard_count; i++) {
+        unordered_map<uint32_t, World_Chunk*>::iterator it = chunks.find(compressed[i].second);
+
+        delete it->second;
+        chunks.erase(it);
+    }
+}
+
+void World_Map::apply_edits (World_Chunk* chunk) {
+    if (edited_tiles.empty()) {
+        return;
+    }
+
+    uint32_t first_x = chunk->chunk_x * chunk_tiles;
+    uint32_t first_y = chunk->chunk_y * chunk_tiles;
+    uint32_t end_x = min(first_x + chunk_tiles, tiles_x);
+    uint32_t end_y = min(first_y + chunk_tiles, tiles_y);
+
+    // Each row of the chunk is a contiguous range of keys
+    for (uint32_t tile_y = first_y; tile_y < end_y; tile_y++) {
+        map<uint32_t, uint8_t>::const_iterator edit = edited_tiles.lower_bound(tile_y * tiles_x + first_x);
+
+        for (; edit != edited_tiles.end() && edit->first < tile_y * tiles_x + end_x; ++edit) {
+            chunk->tiles[(tile_y - first_y) * chunk_tiles + edit->first % tiles_x - first_x] = edit->second;
+        }
+    }
+}
+
+void World_Map::request_chunk (uint32_t chunk_x, uint32_t chunk_y) {
+    uint32_t key = chunk_y * chunks_x + chunk_x;
+    unordered_map<uint32_t, World_Chunk*>::iterator it = chunks.find(key);
+
+    if (it != chunks.end()) {
+        World_Chunk* chunk = it->second;
+
+        chunk->last_requested = update_count;
+
+        // Decoding runs is far cheaper than generating, so it is not worth a trip to a worker
+        if (chunk->state == WORLD_CHUNK_STATE_COMPRESSED) {
+            chunk->decompress(chunk_tiles * chunk_tiles);
+        }
+
+        return;
+    }
+
+    World_Chunk* chunk = new World_Chunk();
+
+    chunk->chunk_x = chunk_x;
+    chunk->chunk_y = chunk_y;
+    chunk->last_requested = update_count;
+
+    chunks[key] = chunk;
+    queued_chunks.push_back(key);
+}
+
+World_Chunk* World_Map::get_resident_chunk (uint32_t chunk_x, uint32_t chunk_y) {
+    uint32_t key = chunk_y * chunks_x + chunk_x;
+
+    request_chunk(chunk_x, chunk_y);
+
+    World_Chunk* chunk = chunks[key];
+
+    if (chunk->state == WORLD_CHUNK_STATE_GENERATING) {
+        vector<uint32_t>::iterator queued = find(queued_chunks.begin(), queued_chunks.end(), key);
+
+        if (queued != queued_chunks.end()) {
+            queued_chunks.erase(queued);
+
+            World_Generator::generate_chunk(seed, chunk_x, chunk_y, chunk_tiles, chunk->tiles, chunk->ports);
+            apply_edits(chunk);
+
+            chunk->state = WORLD_CHUNK_STATE_RESIDENT;
+            chunk->revision = ++revision_count;
+        } else {
+            finish_batch();
+        }
+    }
+
+    return chunk;
+}
+
+void World_Map::setup (uint64_t new_seed, double world_width, double world_height) {
+    clear();
+
+    seed = new_seed;
+    chunk_tiles = max(Game_Constants::WORLD_CHUNK_TILES, (uint32_t) 1);
+    tile_size = Game_Constants::WORLD_TILE_SIZE > 0.0 ? Game_Constants::WORLD_TILE_SIZE : 1.0;
+    tiles_x = (uint32_t) ceil(max(world_width, 0.0) / tile_size);
+    tiles_y = (uint32_t) ceil(max(world_height, 0.0) / tile_size);
+    chunks_x = (tiles_x + chunk_tiles - 1) / chunk_tiles;
+    chunks_y = (tiles_y + chunk_tiles - 1) / chunk_tiles;
+
+    marked_chunks.assign(((uint64_t) chunks_x * chunks_y + 63) / 64, 0);
+}
+
+void World_Map::clear () {
+    finish_batch();
+
+    for (unordered_map<uint32_t, World_Chunk*>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        delete it->second;
+    }
+
+    chunks.clear();
+    queued_chunks.clear();
+    marked_chunks.assign(marked_chunks.size(), 0);
+    changed_chunks.clear();
+    edited_tiles.clear();
+    update_count = 0;
+}
+
+uint64_t World_Map::get_seed () const {
+    return seed;
+}
+
+uint32_t World_Map::get_chunk_tiles () const {
+    return chunk_tiles;
+}
+
+double World_Map::get_tile_size () const {
+    return tile_size;
+}
+
+double World_Map::get_chunk_size () const {
+    return tile_size * chunk_tiles;
+}
+
+uint32_t World_Map::get_chunks_x () const {
+    return chunks_x;
+}
+
+uint32_t World_Map::get_chunks_y () const {
+    return chunks_y;
+}
+
+uint32_t World_Map::get_tiles_x () const {
+    return tiles_x;
+}
+
+uint32_t World_Map::get_tiles_y () const {
+    return tiles_y;
+}
+
+void World_Map::request_area (double x, double y, double w, double h) {
+    if (chunks_x == 0 || chunks_y == 0) {
+        return;
+    }
+
+    double chunk_size = get_chunk_size();
+    double start_x = max(x / chunk_size, 0.0);
+    double start_y = max(y / chunk_size, 0.0);
+    double end_x = min((x + w) / chunk_size, (double) chunks_x - 1);
+    double end_y = min((y + h) / chunk_size, (double) chunks_y - 1);
+
+    for (uint32_t chunk_y = (uint32_t) start_y; (double) chunk_y <= end_y; chunk_y++) {
+        for (uint32_t chunk_x = (uint32_t) start_x; (double) chunk_x <= end_x; chunk_x++) {
+            request_chunk(chunk_x, chunk_y);
+        }
+    }
+}
+
+void World_Map::mark_point (double x, double y) {
+    double chunk_size = get_chunk_size();
+
+    if (x < 0.0 || y < 0.0 || x >= chunk_size * chunks_x || y >= chunk_size * chunks_y) {
+        return;
+    }
+
+    uint32_t key = (uint32_t) (y / chunk_size) * chunks_x + (uint32_t) (x / chunk_size);
+
+    marked_chunks[key / 64] |= (uint64_t) 1 << (key % 64);
+}
+
+void World_Map::request_marked (double margin) {
+    uint32_t margin_chunks = (uint32_t) ceil(max(margin, 0.0) / get_chunk_size());
+
+    for (uint32_t word = 0; word < marked_chunks.size(); word++) {
+        uint64_t bits = marked_chunks[word];
+
+        marked_chunks[word] = 0;
+
+        for (uint32_t bit = 0; bits != 0; bit++, bits >>= 1) {
+            if ((bits & 1) == 0) {
+                continue;
+            }
+
+            uint32_t key = word * 64 + bit;
+            uint32_t chunk_x = key % chunks_x;
+            uint32_t chunk_y = key / chunks_x;
+            uint32_t end_x = min(chunk_x + margin_chunks, chunks_x - 1);
+            uint32_t end_y = min(chunk_y + margin_chunks, chunks_y - 1);
+
+            for (uint32_t y = chunk_y > margin_chunks ? chunk_y - margin_chunks : 0; y <= end_y; y++) {
+                for (uint32_t x = chunk_x > margin_chunks ? chunk_x - margin_chunks : 0; x <= end_x; x++) {
+                    request_chunk(x, y);
+                }
+            }
+        }
+    }
+}
+
+void World_Map::update () {
+    update_count++;
+
+    // Without any workers, nothing else will run the batch, so a chunk of it is run here each update
+    if (Job_System::get_thread_count() == 1 && is_batch_running()) {
+        Job_System::run_queued_job(batch);
+    }
+
+    if (!generating_chunks.empty() && !is_batch_running()) {
+        take_generated_chunks();
+    }
+
+    compress_idle_chunks();
+
+    if (generating_chunks.empty()) {
+        start_batch();
+    }
+}
+
+uint8_t World_Map::get_tile (uint32_t tile_x, uint32_t tile_y) {
+    if (tile_x >= tiles_x || tile_y >= tiles_y) {
+        return WORLD_TILE_COUNT;
+    }
+
+    World_Chunk* chunk = get_resident_chunk(tile_x / chunk_tiles, tile_y / chunk_tiles);
+
+    return chunk->tiles[(tile_y % chunk_tiles) * chunk_tiles + tile_x % chunk_tiles];
+}
+
+void World_Map::set_tile (uint32_t tile_x, uint32_t tile_y, uint8_t tile) {
+    if (tile_x >= tiles_x || tile_y >= tiles_y) {
+        return;
+    }
+
+    World_Chunk* chunk = get_resident_chunk(tile_x / chunk_tiles, tile_y / chunk_tiles);
+    uint8_t& existing = chunk->tiles[(tile_y % chunk_tiles) * chunk_tiles + tile_x % chunk_tiles];
+
+    if (existing != tile) {
+        uint32_t key = chunk->chunk_y * chunks_x + chunk->chunk_x;
+
+        existing = tile;
+        edited_tiles[tile_y * tiles_x + tile_x] = tile;
+        chunk->revision = ++revision_count;
+
+        if (find(changed_chunks.begin(), changed_chunks.end(), key) == changed_chunks.end()) {
+            changed_chunks.push_back(key);
+        }
+    }
+}
+
+void World_Map::take_changed_chunks (vector<uint32_t>& keys) {
+    keys.insert(keys.end(), changed_chunks.begin(), changed_chunks.end());
+    changed_chunks.clear();
+}
+
+const World_Chunk* World_Map::find_chunk (uint32_t chunk_x, uint32_t chunk_y) const {
+    unordered_map<uint32_t, World_Chunk*>::const_iterator it = chunks.find(chunk_y * chunks_x + chunk_x);
+
+    if (it == chunks.end() || it->second->state != WORLD_CHUNK_STATE_RESIDENT) {
+        return 0;
+    }
+
+    return it->second;
+}
+
+void World_Map::write (RakNet::BitStream& bitstream) const {
+    uint32_t edit_count = (uint32_t) edited_tiles.size();
+    uint32_t previous_key = 0;
+
+    bitstream.WriteCompressed(edit_count);
+
+    // Keys are written as the distance from the previous one, which is small wherever changes are clustered
+    for (map<uint32_t, uint8_t>::const_iterator edit = edited_tiles.begin(); edit != edited_tiles.end(); ++edit) {
+        bitstream.WriteCompressed(edit->first - previous_key);
+        bitstream.Write(edit->second);
+
+        previous_key = edit->first;
+    }
+}
+
+bool World_Map::read (RakNet::BitStream& bitstream) {
+    uint32_t edit_count = 0;
+    uint64_t key = 0;
+
+    // Chunks generated before now could be missing the changes, or have ones that are no longer there
+    clear();
+
+    if (!bitstream.ReadCompressed(edit_count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < edit_count; i++) {
+        uint32_t distance = 0;
+        uint8_t tile = 0;
+
+        if (!bitstream.ReadCompressed(distance) || !bitstream.Read(tile) || (i > 0 && distance == 0)) {
+            return false;
+        }
+
+        key += distance;
+
+        if (key >= (uint64_t) tiles_x * tiles_y) {
+            return false;
+        }
+
+        edited_tiles[(uint32_t) key] = tile;
+    }
+
+    return true;
+}
+
+uint32_t World_Map::get_resident_count () const {
+    uint32_t count = 0;
+
+    for (unordered_map<uint32_t, World_Chunk*>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        if (it->second->state == WORLD_CHUNK_STATE_RESIDENT) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+uint32_t World_Map::get_compressed_count () const {
+    return (uint32_t) (chunks.size() - queued_chunks.size() - generating_chunks.size() - get_resident_count());
+}
+
+uint32_t World_Map::get_pending_count () const {
+    return (uint32_t) (queued_chunks.size() + generating_chunks.size());
+}
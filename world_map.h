@@ -0,0 +1,151 @@
+/* Copyright (c) 2012 Cheese and Bacon Games, LLC */
+/* This file is licensed under the MIT License. */
+/* See the file docs/LICENSE.txt for the full license text. */
+
+#ifndef world_map_h
+#define world_map_h
+
+#include "world_generator.h"
+#include "job_system.h"
+
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+#include "raknet/Source/BitStream.h"
+
+enum World_Chunk_State {
+    // Being generated by a worker, which owns its tiles until the batch finishes
+    WORLD_CHUNK_STATE_GENERATING,
+    WORLD_CHUNK_STATE_RESIDENT,
+    // Only its run length encoded tiles are kept
+    WORLD_CHUNK_STATE_COMPRESSED
+};
+
+class World_Chunk {
+    public:
+        uint32_t chunk_x;
+        uint32_t chunk_y;
+        World_Chunk_State state;
+        // The value of World_Map's update counter when the chunk was last requested
+        uint64_t last_requested;
+        // Changes whenever the chunk's tiles do, including when it is generated, so anything derived from the tiles
+        // can tell when it is out of date
+        // Revisions are unique across every chunk of every world
+        uint64_t revision;
+
+        // Row by row, and empty unless the chunk is resident
+        std::vector<uint8_t> tiles;
+        // Pairs of run length and tile, and empty unless the chunk is compressed
+        std::vector<uint8_t> compressed_tiles;
+        // Index within tiles of each port
+        std::vector<uint32_t> ports;
+
+        World_Chunk ();
+
+        void compress();
+        void decompress(uint32_t tile_count);
+};
+
+// The world's terrain, split into square chunks that are generated on demand
+// Chunks near the camera and the ships are requested, generated on worker threads without stalling the caller,
+// and compressed once nothing has requested them for a while, with the least recently requested compressed chunks
+// discarded past a limit
+// Tiles changed through set_tile are also kept apart from the chunks, and laid over a chunk whenever it is generated
+// A discarded chunk is simply generated again if it is needed, since its tiles depend only on the seed and those
+// changes
+// Chunk residency is never part of the simulation state, and so may differ between peers, but the changed tiles are
+class World_Map {
+    private:
+        uint64_t seed;
+        uint32_t chunk_tiles;
+        double tile_size;
+        uint32_t tiles_x;
+        uint32_t tiles_y;
+        uint32_t chunks_x;
+        uint32_t chunks_y;
+
+        // Keyed by chunk_y * chunks_x + chunk_x
+        std::unordered_map<uint32_t, World_Chunk*> chunks;
+        // Chunks that have been requested but not yet handed to a worker, oldest first
+        std::vector<uint32_t> queued_chunks;
+        // One bit per chunk, set by mark_point until the next request_marked
+        std::vector<uint64_t> marked_chunks;
+        uint64_t update_count;
+        uint64_t revision_count;
+        // Keys of the chunks changed by set_tile since the last take_changed_chunks, oldest first
+        std::vector<uint32_t> changed_chunks;
+        // Every tile changed by set_tile, keyed by tile_y * tiles_x + tile_x
+        // Ordered, so that it is saved identically on every peer
+        std::map<uint32_t, uint8_t> edited_tiles;
+
+        // The batch in flight, if any
+        Job_Batch batch;
+        std::vector<World_Chunk*> generating_chunks;
+        std::function<void(uint32_t, uint32_t)> generate_function;
+
+        bool is_batch_running() const;
+        // Waits for the batch in flight, helping it along, and then takes its chunks
+        void finish_batch();
+        void take_generated_chunks();
+        void start_batch();
+        void compress_idle_chunks();
+        // Lays the changed tiles over a chunk that has just been generated
+        void apply_edits(World_Chunk* chunk);
+        void request_chunk(uint32_t chunk_x, uint32_t chunk_y);
+        // Makes the chunk resident right away, generating it on this thread if needed
+        World_Chunk* get_resident_chunk(uint32_t chunk_x, uint32_t chunk_y);
+
+    public:
+        World_Map ();
+        ~World_Map ();
+
+        // Discards every chunk and changed tile, and starts a new world covering the passed dimensions
+        void setup(uint64_t new_seed, double world_width, double world_height);
+        void clear();
+
+        uint64_t get_seed() const;
+        uint32_t get_chunk_tiles() const;
+        double get_tile_size() const;
+        double get_chunk_size() const;
+        uint32_t get_chunks_x() const;
+        uint32_t get_chunks_y() const;
+        uint32_t get_tiles_x() const;
+        uint32_t get_tiles_y() const;
+
+        // Requests every chunk overlapping the rectangle, in world coordinates
+        void request_area(double x, double y, double w, double h);
+        // Marks the chunk under a point, for many points at once, such as every ship
+        void mark_point(double x, double y);
+        // Requests the marked chunks along with every chunk within margin of them, and clears the marks
+        void request_marked(double margin);
+        // Takes finished chunks, compresses idle ones and hands queued chunks to the workers
+        // Call this once per tick
+        void update();
+
+        // Returns WORLD_TILE_COUNT for tiles outside of the world
+        // If the tile's chunk is not resident, it is made resident before returning, which may mean generating it
+        uint8_t get_tile(uint32_t tile_x, uint32_t tile_y);
+        // Does nothing for tiles outside of the world
+        void set_tile(uint32_t tile_x, uint32_t tile_y, uint8_t tile);
+        // Moves the keys of the chunks changed by set_tile into keys, in the order they were first changed
+        // Anything that caches what it derives from the tiles can use this to refresh only what has changed
+        void take_changed_chunks(std::vector<uint32_t>& keys);
+        // Returns 0 if the chunk is not resident yet
+        const World_Chunk* find_chunk(uint32_t chunk_x, uint32_t chunk_y) const;
+
+        // Saves and restores the tiles changed by set_tile, which unlike the generated tiles are part of the
+        // simulation state
+        void write(RakNet::BitStream& bitstream) const;
+        // Discards every chunk, so read this once the world has been set up for the right seed
+        // Returns false if the data is malformed
+        bool read(RakNet::BitStream& bitstream);
+
+        uint32_t get_resident_count() const;
+        uint32_t get_compressed_count() const;
+        uint32_t get_pending_count() const;
+};
+
+#endif